@@ -0,0 +1,446 @@
+/**
+ * Aspect Engine - Implementation
+ *
+ * A snapshot sorts the selected longitudes around the circle and, for
+ * each aspect, sweeps a window [angle - orb, angle + orb] forward from
+ * every body. The window start only ever moves forward, so each sweep
+ * is linear in the bodies plus the pairs it reports. Candidates inside
+ * a window are classified four at a time. Matches are packed into sorted
+ * 64-bit keys so pair lookups are a binary search.
+ */
+
+#include "freestanding.h"
+#include "aspect_engine.h"
+#include "simd.h"
+#include "sync.h"
+
+static const char* ASPECT_NAMES[] = {
+    "None", "Conjunction", "Opposition", "Trine", "Square"
+};
+
+static const double ASPECT_ANGLES[ASPECT_TYPE_COUNT] = {
+    0.0, 0.0, 180.0, 120.0, 90.0
+};
+
+static double aspect_orbs[ASPECT_TYPE_COUNT] = {
+    0.0, 8.0, 8.0, 8.0, 7.0
+};
+
+/* Window slack covering rounding between forward and pairwise separations */
+#define WINDOW_SLACK 1e-6
+
+/*
+ * Guards the orbs, the snapshot and the scratch below: the worker renders
+ * aspects.json while the cosmic thread snapshots for its triggers. Taken
+ * before the body catalog's lock, never after.
+ */
+static spinlock_t aspect_lock = SPINLOCK_INIT;
+
+/* Bumped whenever an orb changes so cached snapshots are discarded */
+static uint32_t orb_generation = 1;
+
+/*
+ * Single cached snapshot, shared by every trigger evaluated in a tick.
+ * Keyed on the planet longitudes it was computed from as well as the
+ * timestamp, since states from different sources share timestamps.
+ */
+static aspect_table_t snapshot;
+static body_subset_t snapshot_bodies;
+static uint32_t snapshot_generation = 0;
+static int snapshot_catalog_count = 0;
+static int snapshot_planet_count = 0;
+static double snapshot_planets[EPHEMERIS_PLANET_COUNT];
+
+/*
+ * Scratch: (angle << 32 | index) sorted around the circle, and their
+ * degrees twice over so a window past 360 is one contiguous run; the
+ * padding lets the last vector load run past the end
+ */
+static uint64_t order[BODY_CATALOG_MAX];
+static double sorted_degree[2 * BODY_CATALOG_MAX + SIMD_LANES];
+static body_subset_t wanted;
+
+/* Entry layout: body_a:16 body_b:16 type:8 orb in centidegrees:24 */
+static uint64_t pack_entry(int a, int b, int type, double orb) {
+    if (a > b) {
+        int t = a;
+        a = b;
+        b = t;
+    }
+    uint32_t centi = (uint32_t)(orb * 100.0 + 0.5);
+    return ((uint64_t)a << 48) | ((uint64_t)b << 32) |
+           ((uint64_t)type << 24) | (centi & 0xFFFFFF);
+}
+
+static uint64_t pair_key(int a, int b) {
+    return pack_entry(a, b, 0, 0.0) & ~0xFFFFFFFFULL;
+}
+
+/* In-place heapsort; no libc qsort in the kernel */
+static void sift_down(uint64_t *a, int root, int end) {
+    while (2 * root + 1 < end) {
+        int child = 2 * root + 1;
+        if (child + 1 < end && a[child] < a[child + 1]) child++;
+        if (a[root] >= a[child]) return;
+        uint64_t t = a[root];
+        a[root] = a[child];
+        a[child] = t;
+        root = child;
+    }
+}
+
+static void sort_keys(uint64_t *a, int n) {
+    for (int i = n / 2 - 1; i >= 0; i--) sift_down(a, i, n);
+    for (int end = n - 1; end > 0; end--) {
+        uint64_t t = a[0];
+        a[0] = a[end];
+        a[end] = t;
+        sift_down(a, 0, end);
+    }
+}
+
+static double normalize(double degree) {
+    degree = fmod(degree, 360.0);
+    if (degree < 0.0) degree += 360.0;
+    if (degree >= 360.0) degree = 0.0;
+    return degree;
+}
+
+/* Planets come from the snapshot data so online mode is respected */
+static double body_degree(const celestial_data_t *data, int index) {
+    if (index < data->planet_count) {
+        return normalize(data->planets[index].degree);
+    }
+    return normalize(body_catalog_degree(index, data->timestamp));
+}
+
+/* Closest aspect within orb for a separation in [0, 180] */
+static aspect_type_t classify(double separation, double *orb) {
+    aspect_type_t best = ASPECT_NONE;
+    double best_orb = 0.0;
+    
+    for (int k = ASPECT_CONJUNCTION; k < ASPECT_TYPE_COUNT; k++) {
+        double off = fabs(separation - ASPECT_ANGLES[k]);
+        if (off <= aspect_orbs[k] && (best == ASPECT_NONE || off < best_orb)) {
+            best = (aspect_type_t)k;
+            best_orb = off;
+        }
+    }
+    
+    if (orb) *orb = best_orb;
+    return best;
+}
+
+static int planet_count_of(const celestial_data_t *data) {
+    return data->planet_count < EPHEMERIS_PLANET_COUNT ? data->planet_count : EPHEMERIS_PLANET_COUNT;
+}
+
+/* The snapshot was computed from this state under the current orbs */
+static bool snapshot_matches(const celestial_data_t *data) {
+    if (snapshot_generation != orb_generation ||
+        snapshot_catalog_count != body_catalog_count() ||
+        snapshot.timestamp != data->timestamp ||
+        snapshot_planet_count != planet_count_of(data)) {
+        return false;
+    }
+    
+    for (int i = 0; i < snapshot_planet_count; i++) {
+        if (snapshot_planets[i] != data->planets[i].degree) return false;
+    }
+    return true;
+}
+
+/* ...and for exactly these bodies */
+static bool snapshot_covers(const celestial_data_t *data, const body_subset_t *bodies) {
+    if (!snapshot_matches(data)) return false;
+    
+    for (int w = 0; w < BODY_CATALOG_MAX / 64; w++) {
+        if (bodies->bits[w] != snapshot_bodies.bits[w]) return false;
+    }
+    return true;
+}
+
+/* Forward angular distance from sorted position i to position m in [i, i+n) */
+static double forward(int m, int i, int n) {
+    double to = m < n ? sorted_degree[m] : sorted_degree[m] + 360.0;
+    return to - sorted_degree[i];
+}
+
+static void record(aspect_table_t *table, int a, int b, int type, double orb) {
+    if (table->count >= ASPECT_TABLE_MAX) {
+        table->truncated = true;
+        return;
+    }
+    table->entries[table->count++] = pack_entry(a, b, type, orb);
+}
+
+/*
+ * Classify the window of body i from position j on, four candidates at
+ * a time, until the forward distance passes hi. The separation is the
+ * same one pair lookups use, so both agree at the orb's edge.
+ */
+SIMD_KERNEL static inline __attribute__((always_inline))
+void sweep_window_lanes(aspect_table_t *table, int i, int j, int n, int k, double hi) {
+    const simd_i64x4 magnitude = {INT64_MAX, INT64_MAX, INT64_MAX, INT64_MAX};
+    const simd_i64x4 step = {0, 1, 2, 3};
+    const simd_f64x4 turn = {360.0, 360.0, 360.0, 360.0};
+    const simd_f64x4 half = {180.0, 180.0, 180.0, 180.0};
+    double from = sorted_degree[i];
+    double angle = ASPECT_ANGLES[k];
+    double orb = aspect_orbs[k];
+    simd_f64x4 from4 = {from, from, from, from};
+    simd_f64x4 angle4 = {angle, angle, angle, angle};
+    simd_f64x4 orb4 = {orb, orb, orb, orb};
+    simd_f64x4 hi4 = {hi, hi, hi, hi};
+    simd_i64x4 wrap4 = {n, n, n, n};
+    simd_i64x4 end4 = {i + n, i + n, i + n, i + n};
+    
+    for (int m = j; m < i + n; m += SIMD_LANES) {
+        simd_i64x4 position = step + (simd_i64x4){m, m, m, m};
+        simd_f64x4 to = *(const simd_f64x4 *)&sorted_degree[m];
+        
+        /* Positions past n are the next time round */
+        simd_i64x4 wrapped = position >= wrap4;
+        simd_f64x4 ahead = to - from4 + (simd_f64x4)((simd_i64x4)turn & wrapped);
+        simd_i64x4 inside = (ahead <= hi4) & (position < end4);
+        
+        simd_f64x4 separation = (simd_f64x4)((simd_i64x4)(from4 - to) & magnitude);
+        simd_i64x4 far = separation > half;
+        separation = (simd_f64x4)(((simd_i64x4)(turn - separation) & far) |
+                                  ((simd_i64x4)separation & ~far));
+        simd_f64x4 off = (simd_f64x4)((simd_i64x4)(separation - angle4) & magnitude);
+        simd_i64x4 hit = inside & (off <= orb4);
+        
+        for (int lane = 0; lane < SIMD_LANES; lane++) {
+            if (!hit[lane]) continue;
+            int q = m + lane < n ? m + lane : m + lane - n;
+            record(table, (int)(order[i] & 0xFFFFFFFF), (int)(order[q] & 0xFFFFFFFF), k, off[lane]);
+        }
+        
+        /* Sorted: once a lane is past the window, so is everything after it */
+        if (!(inside[0] & inside[1] & inside[2] & inside[3])) return;
+    }
+}
+
+SIMD_KERNEL static void sweep_window(aspect_table_t *table, int i, int j, int n, int k, double hi) {
+    sweep_window_lanes(table, i, j, n, k, hi);
+}
+
+SIMD_KERNEL SIMD_AVX static void sweep_window_avx(aspect_table_t *table, int i, int j, int n, int k,
+                                                  double hi) {
+    sweep_window_lanes(table, i, j, n, k, hi);
+}
+
+/* Aspects among the bodies in wanted at the data's instant, into table */
+static void compute_table(const celestial_data_t *data, aspect_table_t *table) {
+    /* Sort the selected bodies by longitude */
+    int n = 0;
+    for (int i = 0; i < body_catalog_count(); i++) {
+        if (!body_subset_contains(&wanted, i)) continue;
+        uint32_t angle = (uint32_t)(body_degree(data, i) * (4294967296.0 / 360.0));
+        order[n++] = ((uint64_t)angle << 32) | (uint32_t)i;
+    }
+    sort_keys(order, n);
+    for (int p = 0; p < n; p++) {
+        sorted_degree[p] = body_degree(data, (int)(order[p] & 0xFFFFFFFF));
+        sorted_degree[p + n] = sorted_degree[p];
+    }
+    for (int p = 2 * n; p < 2 * n + SIMD_LANES; p++) {
+        sorted_degree[p] = 0.0;
+    }
+    
+    table->timestamp = data->timestamp;
+    table->count = 0;
+    table->truncated = false;
+    bool avx = simd_has_avx();
+    
+    /* Sweep each aspect's window forward from every body */
+    for (int k = ASPECT_CONJUNCTION; k < ASPECT_TYPE_COUNT; k++) {
+        double lo = ASPECT_ANGLES[k] - aspect_orbs[k] - WINDOW_SLACK;
+        double hi = ASPECT_ANGLES[k] + aspect_orbs[k] + WINDOW_SLACK;
+        
+        int j = 1;
+        for (int i = 0; i < n; i++) {
+            if (j <= i) j = i + 1;
+            while (j < i + n && forward(j, i, n) < lo) j++;
+            if (j == i + n) continue;
+            
+            if (avx) {
+                sweep_window_avx(table, i, j, n, k, hi);
+            } else {
+                sweep_window(table, i, j, n, k, hi);
+            }
+        }
+    }
+    
+    /*
+     * Sort by pair. Oppositions near 180 degrees are seen from both ends,
+     * and overlapping orbs can match twice; keep the tightest aspect.
+     */
+    sort_keys(table->entries, table->count);
+    int kept = 0;
+    for (int e = 0; e < table->count; e++) {
+        uint64_t entry = table->entries[e];
+        if (kept > 0 && (table->entries[kept - 1] >> 32) == (entry >> 32)) {
+            if ((entry & 0xFFFFFF) < (table->entries[kept - 1] & 0xFFFFFF)) {
+                table->entries[kept - 1] = entry;
+            }
+            continue;
+        }
+        table->entries[kept++] = entry;
+    }
+    table->count = kept;
+}
+
+/* The planets plus extra, with the extra bodies' positions computed */
+static void select_bodies(const celestial_data_t *data, const body_subset_t *extra) {
+    body_subset_clear(&wanted);
+    for (int i = 0; i < data->planet_count; i++) {
+        body_subset_add(&wanted, i);
+    }
+    if (extra) {
+        for (int i = 0; i < body_catalog_count(); i++) {
+            if (body_subset_contains(extra, i)) body_subset_add(&wanted, i);
+        }
+        if (extra->count > 0) {
+            body_catalog_compute(data->timestamp, extra);
+        }
+    }
+}
+
+/**
+ * Set the orb for an aspect type
+ */
+int aspect_engine_set_orb(aspect_type_t type, double orb) {
+    if (type <= ASPECT_NONE || type >= ASPECT_TYPE_COUNT) return -1;
+    if (orb < 0.0 || orb > 30.0) return -1;
+    
+    unsigned long flags = spin_lock(&aspect_lock);
+    aspect_orbs[type] = orb;
+    orb_generation++;
+    spin_unlock(&aspect_lock, flags);
+    return 0;
+}
+
+/**
+ * Get the orb for an aspect type
+ */
+double aspect_engine_get_orb(aspect_type_t type) {
+    if (type <= ASPECT_NONE || type >= ASPECT_TYPE_COUNT) return 0.0;
+    return aspect_orbs[type];
+}
+
+/**
+ * Compute (or reuse) the aspect table for the planets plus extra bodies
+ *
+ * The table is shared and replaced by the next snapshot at another
+ * instant, so it is only safe to read from the thread that snapshots;
+ * callers that keep a table use aspect_engine_compute().
+ */
+const aspect_table_t* aspect_engine_snapshot(const celestial_data_t *data, const body_subset_t *extra) {
+    if (!data) return NULL;
+    
+    unsigned long flags = spin_lock(&aspect_lock);
+    select_bodies(data, extra);
+    if (!snapshot_covers(data, &wanted)) {
+        compute_table(data, &snapshot);
+        memcpy(&snapshot_bodies, &wanted, sizeof(snapshot_bodies));
+        snapshot_generation = orb_generation;
+        snapshot_catalog_count = body_catalog_count();
+        snapshot_planet_count = planet_count_of(data);
+        for (int i = 0; i < snapshot_planet_count; i++) {
+            snapshot_planets[i] = data->planets[i].degree;
+        }
+    }
+    spin_unlock(&aspect_lock, flags);
+    return &snapshot;
+}
+
+/**
+ * Compute the aspect table for the planets plus extra bodies into table
+ *
+ * Leaves the shared snapshot alone.
+ */
+int aspect_engine_compute(const celestial_data_t *data, const body_subset_t *extra,
+                          aspect_table_t *table) {
+    if (!data || !table) return -1;
+    
+    unsigned long flags = spin_lock(&aspect_lock);
+    select_bodies(data, extra);
+    compute_table(data, table);
+    spin_unlock(&aspect_lock, flags);
+    return 0;
+}
+
+/**
+ * Unpack one aspect from a table
+ */
+int aspect_engine_entry(const aspect_table_t *table, int index, aspect_t *aspect) {
+    if (!table || !aspect || index < 0 || index >= table->count) return -1;
+    
+    uint64_t entry = table->entries[index];
+    aspect->body_a = (int)((entry >> 48) & 0xFFFF);
+    aspect->body_b = (int)((entry >> 32) & 0xFFFF);
+    aspect->type = (aspect_type_t)((entry >> 24) & 0xFF);
+    aspect->orb = (double)(entry & 0xFFFFFF) / 100.0;
+    return 0;
+}
+
+/**
+ * Aspect between two bodies at the data's instant
+ */
+aspect_type_t aspect_engine_between(const celestial_data_t *data, int body_a, int body_b) {
+    if (!data || body_a == body_b) return ASPECT_NONE;
+    if (body_a < 0 || body_b < 0 ||
+        body_a >= body_catalog_count() || body_b >= body_catalog_count()) {
+        return ASPECT_NONE;
+    }
+    
+    unsigned long flags = spin_lock(&aspect_lock);
+    if (snapshot_matches(data) &&
+        body_subset_contains(&snapshot_bodies, body_a) &&
+        body_subset_contains(&snapshot_bodies, body_b)) {
+        uint64_t key = pair_key(body_a, body_b);
+        int lo = 0, hi = snapshot.count;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (snapshot.entries[mid] < key) lo = mid + 1;
+            else hi = mid;
+        }
+        if (lo < snapshot.count && (snapshot.entries[lo] >> 32) == (key >> 32)) {
+            aspect_type_t type = (aspect_type_t)((snapshot.entries[lo] >> 24) & 0xFF);
+            spin_unlock(&aspect_lock, flags);
+            return type;
+        }
+        if (!snapshot.truncated) {
+            spin_unlock(&aspect_lock, flags);
+            return ASPECT_NONE;
+        }
+    }
+    
+    /* Not in the snapshot: compute the single pair directly */
+    double separation = fabs(body_degree(data, body_a) - body_degree(data, body_b));
+    if (separation > 180.0) separation = 360.0 - separation;
+    aspect_type_t type = classify(separation, NULL);
+    spin_unlock(&aspect_lock, flags);
+    return type;
+}
+
+/**
+ * Get aspect name
+ */
+const char* aspect_engine_name(aspect_type_t type) {
+    if (type < ASPECT_NONE || type >= ASPECT_TYPE_COUNT) return "Unknown";
+    return ASPECT_NAMES[type];
+}
+
+/**
+ * Look up an aspect type by name
+ */
+int aspect_engine_type(const char *name) {
+    if (!name) return -1;
+    for (int i = 0; i < ASPECT_TYPE_COUNT; i++) {
+        if (strcmp(name, ASPECT_NAMES[i]) == 0) return i;
+    }
+    return -1;
+}
@@ -0,0 +1,61 @@
+/**
+ * Aspect Engine - The Geometry of Influence
+ *
+ * Finds the angular aspects (conjunction, opposition, trine, square)
+ * between catalog bodies. Longitudes are sorted once per snapshot and
+ * only the pairs that fall inside an orb window are visited, so large
+ * catalogs cost O(N log N + matches) instead of O(N^2).
+ */
+
+#ifndef ASPECT_ENGINE_H
+#define ASPECT_ENGINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ephemeris_provider.h"
+#include "body_catalog.h"
+
+#define ASPECT_TABLE_MAX 16384
+
+typedef enum {
+    ASPECT_NONE = 0,
+    ASPECT_CONJUNCTION,      /* 0 degrees */
+    ASPECT_OPPOSITION,       /* 180 degrees */
+    ASPECT_TRINE,            /* 120 degrees */
+    ASPECT_SQUARE,           /* 90 degrees */
+    ASPECT_TYPE_COUNT
+} aspect_type_t;
+
+typedef struct {
+    int body_a;              /* Catalog indices, body_a < body_b */
+    int body_b;
+    aspect_type_t type;
+    double orb;              /* Distance from the exact angle, degrees */
+} aspect_t;
+
+/* Aspects found for one snapshot, sorted by (body_a, body_b) */
+typedef struct {
+    time_t timestamp;
+    int count;
+    bool truncated;          /* More than ASPECT_TABLE_MAX aspects matched */
+    uint64_t entries[ASPECT_TABLE_MAX];
+} aspect_table_t;
+
+/* Orbs */
+int aspect_engine_set_orb(aspect_type_t type, double orb);
+double aspect_engine_get_orb(aspect_type_t type);
+
+/* Snapshots: the planets in data plus any extra catalog bodies */
+const aspect_table_t* aspect_engine_snapshot(const celestial_data_t *data, const body_subset_t *extra);
+int aspect_engine_compute(const celestial_data_t *data, const body_subset_t *extra,
+                          aspect_table_t *table);
+int aspect_engine_entry(const aspect_table_t *table, int index, aspect_t *aspect);
+
+/* Pair lookup; served from the current snapshot when it covers both bodies */
+aspect_type_t aspect_engine_between(const celestial_data_t *data, int body_a, int body_b);
+
+/* Names */
+const char* aspect_engine_name(aspect_type_t type);
+int aspect_engine_type(const char *name);
+
+#endif /* ASPECT_ENGINE_H */
@@ -0,0 +1,577 @@
+/**
+ * Astral Archive - Implementation
+ *
+ * Each chunk starts with one raw row and then holds rows coded against
+ * the row before, so chunks decode on their own and the oldest can be
+ * dropped. Row layout after the first:
+ *
+ *   timestamp   delta-of-delta: '0' | '10'+7 | '110'+9 | '1110'+12 | '1111'+64
+ *   changed     '0' = identical to the previous row, nothing follows
+ *   values      per value, XOR with the previous: '0' same | '10' + bits
+ *               in the previous window | '11' + 5b leading + 6b length + bits
+ *   enums       '0' none changed | '1' then per enum '0' same | '1' + value
+ *
+ * Chunk pages are allocated the first time the ring reaches their slot.
+ * If memory runs out first, the ring wraps at the slots it already has.
+ */
+
+#include "freestanding.h"
+#include "astral_archive.h"
+#include "sync.h"
+
+#define ARCHIVE_VALUES      (1 + EPHEMERIS_PLANET_COUNT)    /* Illumination, longitudes */
+#define ARCHIVE_ENUMS       (2 + EPHEMERIS_PLANET_COUNT)    /* Phase, day, signs */
+#define ARCHIVE_CHUNK_BITS  (ASTRAL_ARCHIVE_CHUNK_BYTES * 8)
+#define ARCHIVE_ROW_BITS    1024    /* Worst-case coded row, rounded up */
+#define ARCHIVE_NO_WINDOW   0xFF
+
+/* Bits per enum: moon phase 0-7, day 1-31, signs 0-11 */
+static const uint8_t ENUM_WIDTH[ARCHIVE_ENUMS] = {3, 5, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4};
+
+/* Previous row, shared by the encoder and the decoder */
+typedef struct {
+    int64_t timestamp;
+    int64_t delta;
+    uint64_t values[ARCHIVE_VALUES];
+    uint8_t leading[ARCHIVE_VALUES];
+    uint8_t trailing[ARCHIVE_VALUES];   /* ARCHIVE_NO_WINDOW until the first XOR */
+    uint8_t enums[ARCHIVE_ENUMS];
+} archive_codec_t;
+
+typedef struct {
+    uint32_t first_row;
+    uint32_t rows;
+    int64_t first;
+    int64_t last;
+    uint32_t bits;
+} archive_chunk_t;
+
+static uint8_t *chunk_data[ASTRAL_ARCHIVE_CHUNKS];
+static archive_chunk_t chunks[ASTRAL_ARCHIVE_CHUNKS];
+static int chunk_capacity = ASTRAL_ARCHIVE_CHUNKS;
+static int chunk_head = 0;              /* Oldest chunk */
+static int chunk_count = 0;
+static bool writer_open = false;        /* The newest chunk takes more rows */
+static archive_codec_t writer;
+static uint32_t next_row = 1;
+static uint64_t rows_appended = 0;
+static spinlock_t archive_lock = SPINLOCK_INIT;
+
+static void put_bits(uint8_t *data, uint32_t *bit, uint64_t value, int count) {
+    for (int i = count - 1; i >= 0; i--) {
+        uint32_t at = (*bit)++;
+        if ((value >> i) & 1) {
+            data[at >> 3] |= (uint8_t)(0x80 >> (at & 7));
+        } else {
+            data[at >> 3] &= (uint8_t)~(0x80 >> (at & 7));
+        }
+    }
+}
+
+static uint64_t get_bits(const uint8_t *data, uint32_t *bit, int count) {
+    uint64_t value = 0;
+    for (int i = 0; i < count; i++) {
+        uint32_t at = (*bit)++;
+        value = (value << 1) | ((data[at >> 3] >> (7 - (at & 7))) & 1);
+    }
+    return value;
+}
+
+/* Two 32-bit halves; no libgcc helpers on the 32-bit kernel */
+static int leading_zeros(uint64_t value) {
+    uint32_t high = (uint32_t)(value >> 32);
+    return high ? __builtin_clz(high) : 32 + __builtin_clz((uint32_t)value);
+}
+
+static int trailing_zeros(uint64_t value) {
+    uint32_t low = (uint32_t)value;
+    return low ? __builtin_ctz(low) : 32 + __builtin_ctz((uint32_t)(value >> 32));
+}
+
+static int64_t sign_extend(uint64_t value, int bits) {
+    return (int64_t)(value << (64 - bits)) >> (64 - bits);
+}
+
+static uint64_t double_bits(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static double bits_double(uint64_t bits) {
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/* Round to the rendered precision so a value that has not visibly moved repeats */
+static uint64_t archive_quantize(double value) {
+    int32_t scaled = (int32_t)(value * ASTRAL_ARCHIVE_SCALE + (value < 0 ? -0.5 : 0.5));
+    return double_bits((double)scaled / ASTRAL_ARCHIVE_SCALE);
+}
+
+static int archive_sign_index(const char *sign) {
+    for (int i = 0; i < 12; i++) {
+        if (strcmp(sign, ephemeris_sign_name(i)) == 0) return i;
+    }
+    return 0;
+}
+
+/* A state as the codec sees it */
+static void archive_row_from(const celestial_data_t *data, archive_codec_t *row) {
+    row->timestamp = (int64_t)data->timestamp;
+    row->values[0] = archive_quantize(data->moon_illumination);
+    row->enums[0] = (uint8_t)data->moon_phase;
+    row->enums[1] = (uint8_t)data->numerology_day;
+    for (int i = 0; i < EPHEMERIS_PLANET_COUNT; i++) {
+        bool present = i < data->planet_count;
+        row->values[1 + i] = archive_quantize(present ? data->planets[i].degree : 0.0);
+        row->enums[2 + i] = (uint8_t)(present ? archive_sign_index(data->planets[i].sign) : 0);
+    }
+}
+
+static void archive_put_timestamp(uint8_t *data, uint32_t *bit, archive_codec_t *codec, int64_t timestamp) {
+    int64_t delta = timestamp - codec->timestamp;
+    int64_t dod = delta - codec->delta;
+    
+    if (dod == 0) {
+        put_bits(data, bit, 0, 1);
+    } else if (dod >= -64 && dod <= 63) {
+        put_bits(data, bit, 0x2, 2);
+        put_bits(data, bit, (uint64_t)dod, 7);
+    } else if (dod >= -256 && dod <= 255) {
+        put_bits(data, bit, 0x6, 3);
+        put_bits(data, bit, (uint64_t)dod, 9);
+    } else if (dod >= -2048 && dod <= 2047) {
+        put_bits(data, bit, 0xE, 4);
+        put_bits(data, bit, (uint64_t)dod, 12);
+    } else {
+        put_bits(data, bit, 0xF, 4);
+        put_bits(data, bit, (uint64_t)dod, 64);
+    }
+    
+    codec->delta = delta;
+    codec->timestamp = timestamp;
+}
+
+static void archive_get_timestamp(const uint8_t *data, uint32_t *bit, archive_codec_t *codec) {
+    int64_t dod;
+    if (get_bits(data, bit, 1) == 0) {
+        dod = 0;
+    } else if (get_bits(data, bit, 1) == 0) {
+        dod = sign_extend(get_bits(data, bit, 7), 7);
+    } else if (get_bits(data, bit, 1) == 0) {
+        dod = sign_extend(get_bits(data, bit, 9), 9);
+    } else if (get_bits(data, bit, 1) == 0) {
+        dod = sign_extend(get_bits(data, bit, 12), 12);
+    } else {
+        dod = (int64_t)get_bits(data, bit, 64);
+    }
+    
+    codec->delta += dod;
+    codec->timestamp += codec->delta;
+}
+
+static void archive_put_value(uint8_t *data, uint32_t *bit, archive_codec_t *codec, int i, uint64_t value) {
+    uint64_t xor = value ^ codec->values[i];
+    codec->values[i] = value;
+    if (xor == 0) {
+        put_bits(data, bit, 0, 1);
+        return;
+    }
+    
+    int leading = leading_zeros(xor);
+    int trailing = trailing_zeros(xor);
+    if (leading > 31) leading = 31;
+    
+    if (codec->trailing[i] != ARCHIVE_NO_WINDOW &&
+        leading >= codec->leading[i] && trailing >= codec->trailing[i]) {
+        /* Fits the previous window: no need to describe it again */
+        int length = 64 - codec->leading[i] - codec->trailing[i];
+        put_bits(data, bit, 0x2, 2);
+        put_bits(data, bit, xor >> codec->trailing[i], length);
+        return;
+    }
+    
+    int length = 64 - leading - trailing;
+    put_bits(data, bit, 0x3, 2);
+    put_bits(data, bit, (uint64_t)leading, 5);
+    put_bits(data, bit, (uint64_t)(length & 63), 6);
+    put_bits(data, bit, xor >> trailing, length);
+    codec->leading[i] = (uint8_t)leading;
+    codec->trailing[i] = (uint8_t)trailing;
+}
+
+static void archive_get_value(const uint8_t *data, uint32_t *bit, archive_codec_t *codec, int i) {
+    if (get_bits(data, bit, 1) == 0) return;
+    
+    if (get_bits(data, bit, 1) == 1) {
+        int leading = (int)get_bits(data, bit, 5);
+        int length = (int)get_bits(data, bit, 6);
+        if (length == 0) length = 64;
+        codec->leading[i] = (uint8_t)leading;
+        codec->trailing[i] = (uint8_t)(64 - leading - length);
+    }
+    
+    int length = 64 - codec->leading[i] - codec->trailing[i];
+    codec->values[i] ^= get_bits(data, bit, length) << codec->trailing[i];
+}
+
+/* Start a chunk with a raw row */
+static void archive_put_first(uint8_t *data, uint32_t *bit, archive_codec_t *codec, const archive_codec_t *row) {
+    put_bits(data, bit, (uint64_t)row->timestamp, 64);
+    for (int i = 0; i < ARCHIVE_VALUES; i++) {
+        put_bits(data, bit, row->values[i], 64);
+        codec->values[i] = row->values[i];
+        codec->trailing[i] = ARCHIVE_NO_WINDOW;
+    }
+    for (int i = 0; i < ARCHIVE_ENUMS; i++) {
+        put_bits(data, bit, row->enums[i], ENUM_WIDTH[i]);
+        codec->enums[i] = row->enums[i];
+    }
+    codec->timestamp = row->timestamp;
+    codec->delta = 0;
+}
+
+static void archive_get_first(const uint8_t *data, uint32_t *bit, archive_codec_t *codec) {
+    codec->timestamp = (int64_t)get_bits(data, bit, 64);
+    codec->delta = 0;
+    for (int i = 0; i < ARCHIVE_VALUES; i++) {
+        codec->values[i] = get_bits(data, bit, 64);
+        codec->trailing[i] = ARCHIVE_NO_WINDOW;
+    }
+    for (int i = 0; i < ARCHIVE_ENUMS; i++) {
+        codec->enums[i] = (uint8_t)get_bits(data, bit, ENUM_WIDTH[i]);
+    }
+}
+
+static void archive_put_row(uint8_t *data, uint32_t *bit, archive_codec_t *codec, const archive_codec_t *row) {
+    archive_put_timestamp(data, bit, codec, row->timestamp);
+    
+    bool values_changed = memcmp(codec->values, row->values, sizeof(row->values)) != 0;
+    bool enums_changed = memcmp(codec->enums, row->enums, sizeof(row->enums)) != 0;
+    put_bits(data, bit, (values_changed || enums_changed) ? 1 : 0, 1);
+    if (!values_changed && !enums_changed) return;
+    
+    for (int i = 0; i < ARCHIVE_VALUES; i++) {
+        archive_put_value(data, bit, codec, i, row->values[i]);
+    }
+    
+    put_bits(data, bit, enums_changed ? 1 : 0, 1);
+    if (!enums_changed) return;
+    for (int i = 0; i < ARCHIVE_ENUMS; i++) {
+        if (row->enums[i] == codec->enums[i]) {
+            put_bits(data, bit, 0, 1);
+        } else {
+            put_bits(data, bit, 1, 1);
+            put_bits(data, bit, row->enums[i], ENUM_WIDTH[i]);
+            codec->enums[i] = row->enums[i];
+        }
+    }
+}
+
+static void archive_get_row(const uint8_t *data, uint32_t *bit, archive_codec_t *codec) {
+    archive_get_timestamp(data, bit, codec);
+    if (get_bits(data, bit, 1) == 0) return;
+    
+    for (int i = 0; i < ARCHIVE_VALUES; i++) {
+        archive_get_value(data, bit, codec, i);
+    }
+    
+    if (get_bits(data, bit, 1) == 0) return;
+    for (int i = 0; i < ARCHIVE_ENUMS; i++) {
+        if (get_bits(data, bit, 1) == 1) {
+            codec->enums[i] = (uint8_t)get_bits(data, bit, ENUM_WIDTH[i]);
+        }
+    }
+}
+
+static void archive_sample_from(const archive_codec_t *codec, uint32_t row, astral_archive_sample_t *sample) {
+    sample->row = row;
+    sample->timestamp = (time_t)codec->timestamp;
+    sample->moon_illumination = bits_double(codec->values[0]);
+    sample->moon_phase = codec->enums[0];
+    sample->numerology_day = codec->enums[1];
+    for (int i = 0; i < EPHEMERIS_PLANET_COUNT; i++) {
+        sample->longitudes[i] = bits_double(codec->values[1 + i]);
+        sample->signs[i] = codec->enums[2 + i];
+    }
+}
+
+static archive_chunk_t *archive_chunk_at(int index) {
+    return &chunks[(chunk_head + index) % chunk_capacity];
+}
+
+static uint8_t *archive_data_at(int index) {
+    return chunk_data[(chunk_head + index) % chunk_capacity];
+}
+
+/* Back a ring slot with a page; archive_lock held */
+static bool archive_slot_ready(int slot) {
+    if (!chunk_data[slot]) {
+#ifdef USERLAND_BUILD
+        chunk_data[slot] = malloc(ASTRAL_ARCHIVE_CHUNK_BYTES);
+#else
+        chunk_data[slot] = kmalloc(ASTRAL_ARCHIVE_CHUNK_BYTES);    /* One whole page */
+#endif
+    }
+    return chunk_data[slot] != NULL;
+}
+
+/**
+ * Initialize the archive, discarding everything in it
+ */
+int astral_archive_init(void) {
+    unsigned long flags = spin_lock(&archive_lock);
+    chunk_capacity = ASTRAL_ARCHIVE_CHUNKS;
+    chunk_head = 0;
+    chunk_count = 0;
+    writer_open = false;
+    next_row = 1;
+    rows_appended = 0;
+    spin_unlock(&archive_lock, flags);
+    return 0;
+}
+
+/**
+ * Append a published state
+ *
+ * Returns 1 if it was stored, 0 if it was not newer than the last one,
+ * -1 if there is no memory for a first chunk.
+ */
+int astral_archive_append(const celestial_data_t *data) {
+    if (!data) return -1;
+    
+    archive_codec_t row;
+    archive_row_from(data, &row);
+    
+    unsigned long flags = spin_lock(&archive_lock);
+    if (chunk_count > 0 && row.timestamp <= archive_chunk_at(chunk_count - 1)->last) {
+        spin_unlock(&archive_lock, flags);
+        return 0;
+    }
+    
+    archive_chunk_t *chunk = chunk_count > 0 ? archive_chunk_at(chunk_count - 1) : NULL;
+    if (!writer_open || chunk->bits + ARCHIVE_ROW_BITS > ARCHIVE_CHUNK_BITS) {
+        /* The head stays at slot 0 until the ring first fills */
+        if (chunk_count < chunk_capacity && !archive_slot_ready(chunk_count)) {
+            if (chunk_count == 0) {
+                spin_unlock(&archive_lock, flags);
+                return -1;
+            }
+            chunk_capacity = chunk_count;
+        }
+        if (chunk_count == chunk_capacity) {
+            /* Full: the oldest chunk makes room */
+            chunk_head = (chunk_head + 1) % chunk_capacity;
+            chunk_count--;
+        }
+        chunk_count++;
+        chunk = archive_chunk_at(chunk_count - 1);
+        chunk->first_row = next_row;
+        chunk->rows = 0;
+        chunk->first = row.timestamp;
+        chunk->bits = 0;
+        archive_put_first(archive_data_at(chunk_count - 1), &chunk->bits, &writer, &row);
+        writer_open = true;
+    } else {
+        archive_put_row(archive_data_at(chunk_count - 1), &chunk->bits, &writer, &row);
+    }
+    
+    chunk->rows++;
+    chunk->last = row.timestamp;
+    next_row++;
+    rows_appended++;
+    
+    spin_unlock(&archive_lock, flags);
+    return 1;
+}
+
+/**
+ * Read archived samples in a time range
+ *
+ * The cursor is the next row to return, so a later call also picks up
+ * rows appended since. Each call decodes from the start of the chunk it
+ * resumes in, never from the start of the archive. Returns the number
+ * of samples written.
+ */
+int astral_archive_read(time_t from, time_t to, uint32_t *cursor,
+                        astral_archive_sample_t *samples, int max_samples) {
+    if (!cursor || !samples || max_samples <= 0) return -1;
+    
+    unsigned long flags = spin_lock(&archive_lock);
+    int count = 0;
+    uint32_t start = *cursor;
+    bool done = false;
+    
+    for (int c = 0; c < chunk_count && !done; c++) {
+        archive_chunk_t *chunk = archive_chunk_at(c);
+        if (chunk->first_row + chunk->rows <= start || chunk->last < (int64_t)from) continue;
+        if (chunk->first > (int64_t)to) break;
+        
+        const uint8_t *data = archive_data_at(c);
+        archive_codec_t codec;
+        uint32_t bit = 0;
+        for (uint32_t r = 0; r < chunk->rows; r++) {
+            if (r == 0) {
+                archive_get_first(data, &bit, &codec);
+            } else {
+                archive_get_row(data, &bit, &codec);
+            }
+            
+            uint32_t row = chunk->first_row + r;
+            if (row < start || codec.timestamp < (int64_t)from) continue;
+            if (codec.timestamp > (int64_t)to) {
+                done = true;
+                break;
+            }
+            
+            archive_sample_from(&codec, row, &samples[count++]);
+            if (count == max_samples) {
+                start = row + 1;
+                done = true;
+                break;
+            }
+        }
+    }
+    
+    *cursor = (count == max_samples) ? start : next_row;
+    spin_unlock(&archive_lock, flags);
+    return count;
+}
+
+/**
+ * Time span of the index-th oldest chunk
+ */
+bool astral_archive_chunk(int index, time_t *first, time_t *last) {
+    unsigned long flags = spin_lock(&archive_lock);
+    bool found = index >= 0 && index < chunk_count;
+    if (found) {
+        *first = (time_t)archive_chunk_at(index)->first;
+        *last = (time_t)archive_chunk_at(index)->last;
+    }
+    spin_unlock(&archive_lock, flags);
+    return found;
+}
+
+/**
+ * Get archive statistics
+ */
+void astral_archive_get_stats(astral_archive_stats_t *stats) {
+    if (!stats) return;
+    
+    unsigned long flags = spin_lock(&archive_lock);
+    memset(stats, 0, sizeof(*stats));
+    stats->appended = rows_appended;
+    stats->chunks = chunk_count;
+    for (int c = 0; c < chunk_count; c++) {
+        stats->rows += archive_chunk_at(c)->rows;
+        stats->bytes += (archive_chunk_at(c)->bits + 7) / 8;
+    }
+    if (chunk_count > 0) {
+        stats->oldest = (time_t)archive_chunk_at(0)->first;
+        stats->newest = (time_t)archive_chunk_at(chunk_count - 1)->last;
+    }
+    spin_unlock(&archive_lock, flags);
+}
+
+#ifdef USERLAND_BUILD
+#define ARCHIVE_FILE_MAGIC  0x48545341u     /* "ASTH" */
+#define ARCHIVE_FILE_VERSION 1
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t chunk_bytes;
+    uint32_t chunk_count;
+    uint32_t next_row;
+    uint64_t appended;
+} archive_file_header_t;
+
+/**
+ * Write the archive to a file
+ *
+ * Only the used part of each chunk is written.
+ */
+int astral_archive_save(const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "[ASTRAL ARCHIVE] Cannot write %s\n", path);
+        return -1;
+    }
+    
+    unsigned long flags = spin_lock(&archive_lock);
+    archive_file_header_t header = {ARCHIVE_FILE_MAGIC, ARCHIVE_FILE_VERSION, ASTRAL_ARCHIVE_CHUNK_BYTES,
+                                    (uint32_t)chunk_count, next_row, rows_appended};
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int c = 0; c < chunk_count && ok; c++) {
+        archive_chunk_t *chunk = archive_chunk_at(c);
+        ok = fwrite(chunk, sizeof(*chunk), 1, file) == 1 &&
+             fwrite(archive_data_at(c), 1, (chunk->bits + 7) / 8, file) == (chunk->bits + 7) / 8;
+    }
+    spin_unlock(&archive_lock, flags);
+    
+    if (fclose(file) != 0 || !ok) {
+        fprintf(stderr, "[ASTRAL ARCHIVE] Cannot write %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Replace the archive with one saved by astral_archive_save()
+ *
+ * New rows go into a fresh chunk after the loaded ones.
+ */
+int astral_archive_load(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return -1;
+    
+    archive_file_header_t header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != ARCHIVE_FILE_MAGIC ||
+        header.version != ARCHIVE_FILE_VERSION || header.chunk_bytes != ASTRAL_ARCHIVE_CHUNK_BYTES) {
+        fprintf(stderr, "[ASTRAL ARCHIVE] Not an archive: %s\n", path);
+        fclose(file);
+        return -1;
+    }
+    
+    /* Keep the newest chunks if the file holds more than fit */
+    uint32_t skip = header.chunk_count > ASTRAL_ARCHIVE_CHUNKS ? header.chunk_count - ASTRAL_ARCHIVE_CHUNKS : 0;
+    
+    unsigned long flags = spin_lock(&archive_lock);
+    chunk_capacity = ASTRAL_ARCHIVE_CHUNKS;
+    chunk_head = 0;
+    chunk_count = 0;
+    writer_open = false;
+    next_row = header.next_row;
+    rows_appended = header.appended;
+    
+    bool ok = true;
+    for (uint32_t c = 0; c < header.chunk_count && ok; c++) {
+        archive_chunk_t *chunk = &chunks[chunk_count];
+        ok = fread(chunk, sizeof(*chunk), 1, file) == 1 && chunk->bits <= ARCHIVE_CHUNK_BITS &&
+             archive_slot_ready(chunk_count) &&
+             fread(chunk_data[chunk_count], 1, (chunk->bits + 7) / 8, file) == (chunk->bits + 7) / 8;
+        if (ok && c >= skip) chunk_count++;
+    }
+    if (!ok) chunk_count = 0;
+    spin_unlock(&archive_lock, flags);
+    
+    fclose(file);
+    if (!ok) {
+        fprintf(stderr, "[ASTRAL ARCHIVE] Truncated archive: %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+#else
+int astral_archive_save(const char *path) {
+    (void)path;
+    return -1;
+}
+
+int astral_archive_load(const char *path) {
+    (void)path;
+    return -1;
+}
+#endif /* USERLAND_BUILD */
@@ -0,0 +1,71 @@
+/**
+ * Astral Archive - The Sky Remembers
+ *
+ * Compressed history of every published celestial state. Ticks are
+ * packed into fixed-size chunks as they arrive, Gorilla-style:
+ * timestamps as delta-of-delta, values as the XOR with the previous
+ * one, and the moon phase, numerology day and signs only when they
+ * change. A tick in which nothing moved costs two bits. When the arena
+ * is full the oldest chunk is dropped.
+ *
+ * Values are kept at the precision the /astral files render
+ * (ASTRAL_ARCHIVE_SCALE), which is what lets unchanged ticks repeat
+ * exactly.
+ */
+
+#ifndef ASTRAL_ARCHIVE_H
+#define ASTRAL_ARCHIVE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "ephemeris_provider.h"
+
+#define ASTRAL_ARCHIVE_CHUNK_BYTES  4096
+#ifndef ASTRAL_ARCHIVE_CHUNKS
+#define ASTRAL_ARCHIVE_CHUNKS       2048    /* Up to 8 MB: about a year of 5-second ticks */
+#endif
+#define ASTRAL_ARCHIVE_SCALE        100     /* Values kept to 1/100 */
+
+/* One decoded tick */
+typedef struct {
+    uint32_t row;                   /* Sequence number, 1 = first ever appended */
+    time_t timestamp;
+    double moon_illumination;
+    uint8_t moon_phase;             /* moon_phase_t */
+    uint8_t numerology_day;
+    uint8_t signs[EPHEMERIS_PLANET_COUNT];      /* 0 = Aries ... 11 = Pisces */
+    double longitudes[EPHEMERIS_PLANET_COUNT];
+} astral_archive_sample_t;
+
+typedef struct {
+    uint64_t rows;                  /* Rows held now */
+    uint64_t appended;              /* Rows ever appended */
+    uint64_t bytes;                 /* Compressed bytes in use */
+    int chunks;
+    time_t oldest;
+    time_t newest;
+} astral_archive_stats_t;
+
+int astral_archive_init(void);
+
+/* Once per published state; states not newer than the last are skipped */
+int astral_archive_append(const celestial_data_t *data);
+
+/*
+ * Samples with from <= timestamp <= to, oldest first. Start with
+ * *cursor = 0 and call until it returns 0.
+ */
+int astral_archive_read(time_t from, time_t to, uint32_t *cursor,
+                        astral_archive_sample_t *samples, int max_samples);
+
+/* Time span of the index-th oldest chunk; false past the last one */
+bool astral_archive_chunk(int index, time_t *first, time_t *last);
+
+void astral_archive_get_stats(astral_archive_stats_t *stats);
+
+/* Persist the archive, or replace it with a saved one (userland only) */
+int astral_archive_save(const char *path);
+int astral_archive_load(const char *path);
+
+#endif /* ASTRAL_ARCHIVE_H */
@@ -0,0 +1,94 @@
+/**
+ * Astral Formats - Numbers Without Words
+ *
+ * Fixed-layout binary images of the /astral files for machine readers.
+ * Every image is a 32-byte header followed by a payload. All fields are
+ * little-endian; doubles are IEEE-754 binary64. The header carries a
+ * CRC-32 (the zlib polynomial) of the payload, so a reader can validate
+ * the image and then use it in place without parsing.
+ */
+
+#ifndef ASTRAL_FORMAT_H
+#define ASTRAL_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ephemeris_provider.h"
+
+#define ASTRAL_BIN_MAGIC    0x52545341u     /* "ASTR" */
+#define ASTRAL_BIN_VERSION  1
+#define ASTRAL_HISTORY_ROWS 64              /* Most recent ticks in history.bin */
+
+typedef enum {
+    ASTRAL_BIN_PLANETS = 1,     /* planet_positions.bin: one record per planet */
+    ASTRAL_BIN_SNAPSHOT,        /* snapshot.bin: one record */
+    ASTRAL_BIN_HISTORY          /* history.bin: columns, oldest row first */
+} astral_bin_kind_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t kind;
+    uint32_t record_size;       /* Bytes per record, or per row for columns */
+    uint32_t record_count;
+    uint32_t payload_size;
+    uint32_t checksum;          /* CRC-32 of the payload */
+    int64_t timestamp;          /* Celestial state the image was rendered from */
+} astral_bin_header_t;
+
+typedef struct __attribute__((packed)) {
+    double longitude;           /* Ecliptic degrees, 0-360 */
+    uint16_t body;              /* Body catalog index */
+    uint16_t sign;              /* 0 = Aries ... 11 = Pisces */
+    uint32_t reserved;
+} astral_bin_planet_t;
+
+typedef struct __attribute__((packed)) {
+    int64_t timestamp;
+    double moon_illumination;
+    uint32_t moon_phase;        /* moon_phase_t */
+    uint32_t numerology_day;
+    uint32_t planet_count;
+    uint32_t reserved;
+    double longitudes[EPHEMERIS_PLANET_COUNT];
+} astral_bin_snapshot_t;
+
+/*
+ * history.bin columns, each record_count entries long, in this order:
+ * int64 timestamp, double moon_illumination, uint32 moon_phase,
+ * uint32 numerology_day, then one double longitude column per planet.
+ */
+#define ASTRAL_HISTORY_ROW_SIZE (8 + 8 + 4 + 4 + 8 * EPHEMERIS_PLANET_COUNT)
+
+typedef struct {
+    int count;
+    const int64_t *timestamps;
+    const double *moon_illumination;
+    const uint32_t *moon_phase;
+    const uint32_t *numerology_day;
+    const double *longitudes[EPHEMERIS_PLANET_COUNT];
+} astral_history_columns_t;
+
+/* CRC-32, reflected 0xEDB88320; matches zlib.crc32() */
+uint32_t astral_format_crc32(const void *data, size_t length);
+
+/* Column pointers into a validated history payload */
+static inline void astral_format_history_columns(const void *payload, uint32_t rows,
+                                                 astral_history_columns_t *columns) {
+    const uint8_t *p = (const uint8_t *)payload;
+    columns->count = (int)rows;
+    columns->timestamps = (const int64_t *)p;
+    p += 8 * rows;
+    columns->moon_illumination = (const double *)p;
+    p += 8 * rows;
+    columns->moon_phase = (const uint32_t *)p;
+    p += 4 * rows;
+    columns->numerology_day = (const uint32_t *)p;
+    p += 4 * rows;
+    for (int i = 0; i < EPHEMERIS_PLANET_COUNT; i++) {
+        columns->longitudes[i] = (const double *)p;
+        p += 8 * rows;
+    }
+}
+
+#endif /* ASTRAL_FORMAT_H */
@@ -6,16 +6,472 @@
 
 #include "freestanding.h"
 #include "astral_fs.h"
+#include "aspect_engine.h"
+#include "destiny_engine.h"
+#include "astral_format.h"
+#include "astral_archive.h"
+#include "sync.h"
 
-static celestial_data_t current_state;
+/* Where a streamed read can resume: a record and the offset it starts at */
+typedef struct {
+    uint32_t generation;                /* 0 = none */
+    uint32_t record;
+    uint64_t position;
+} astral_checkpoint_t;
+
+/*
+ * Output window for a render. Renderers emit the whole file in order;
+ * only the bytes in [offset, offset + size) are copied to buffer.
+ */
+typedef struct {
+    char *buffer;
+    size_t size;
+    uint64_t offset;                    /* File offset of buffer[0] */
+    uint64_t position;                  /* File offset of the next emitted byte */
+    bool complete;                      /* Run to the end to learn the full size */
+    uint32_t first_record;              /* Record to resume at; position is preset */
+    astral_checkpoint_t *checkpoint;    /* Latest record start inside the window */
+} astral_emitter_t;
+
+/* Renders one virtual file from a celestial state */
+typedef void (*astral_render_fn)(const celestial_data_t *state, uint32_t generation,
+                                 astral_emitter_t *out);
+
+/* Checkpoint of the last history/ read and exactly what it was reading */
+typedef struct {
+    time_t from;
+    time_t to;
+    uint64_t evicted;                   /* Archive rows dropped before the read */
+    astral_checkpoint_t checkpoint;
+} astral_range_checkpoint_t;
+
+/* One rendered copy per state slot, so a new tick never overwrites a live view */
+typedef struct {
+    const char *name;
+    astral_render_fn render;
+    volatile uint32_t generation[2];    /* State generation of rendered[slot], 0 = never */
+    int length[2];                      /* Bytes cached in rendered[slot] */
+    uint64_t size[2];                   /* Full size; may exceed the cache */
+    astral_checkpoint_t checkpoint[2];  /* Where the last streamed read stopped */
+    char rendered[2][ASTRAL_RENDER_MAX];
+} astral_file_t;
+
+/* Double-buffered state: the writer fills the inactive slot, then flips */
+typedef struct {
+    celestial_data_t state;
+    uint32_t generation;
+} astral_state_slot_t;
+
+/* Recent states for history.bin; one spare row so the writer never
+ * overwrites a row that a reader of the previous generation still needs */
+#define HISTORY_CAPACITY (ASTRAL_HISTORY_ROWS + 1)
+
+typedef struct {
+    uint32_t generation;                /* 0 = empty */
+    celestial_data_t state;
+} astral_history_row_t;
+
+/* A computed instant under at/, kept until it is the least recently used */
+typedef struct {
+    time_t timestamp;
+    uint32_t last_used;                 /* at_clock value, 0 = empty */
+    celestial_data_t state;
+} astral_at_entry_t;
+
+static astral_state_slot_t state_slots[2];
+static astral_history_row_t history[HISTORY_CAPACITY];
+static volatile int active_slot = 0;
+static uint32_t state_generation = 1;
+static seqlock_t state_lock = SEQLOCK_INIT;
+static spinlock_t render_lock = SPINLOCK_INIT;  /* Renderers share engine scratch */
+static astral_at_entry_t at_cache[ASTRAL_AT_CACHE];
+static uint32_t at_clock = 0;
+static spinlock_t at_lock = SPINLOCK_INIT;
+static astral_range_checkpoint_t range_checkpoint; /* Guarded by render_lock */
 static bool is_mounted = false;
 static char mount_point[256] = ASTRAL_ROOT;
 
+/* snprintf returns the untruncated length in userland; never step past the end */
+static int fit(int written, size_t room) {
+    if (written < 0 || room == 0) return 0;
+    return (size_t)written >= room ? (int)room - 1 : written;
+}
+
+static void emit(astral_emitter_t *out, const char *data, size_t length) {
+    uint64_t end = out->offset + out->size;
+    if (out->position < end && out->position + length > out->offset) {
+        uint64_t from = out->position > out->offset ? out->position : out->offset;
+        uint64_t to = out->position + length < end ? out->position + length : end;
+        memcpy(out->buffer + (size_t)(from - out->offset),
+               data + (size_t)(from - out->position), (size_t)(to - from));
+    }
+    out->position += length;
+}
+
+static void emitf(astral_emitter_t *out, const char *format, ...) {
+    char line[512];
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    emit(out, line, (size_t)fit(written, sizeof(line)));
+}
+
+/* Mark the start of a record; returns false once the window is full */
+static bool emit_record(astral_emitter_t *out, uint32_t record) {
+    uint64_t end = out->offset + out->size;
+    if (out->checkpoint && out->position <= end) {
+        out->checkpoint->record = record;
+        out->checkpoint->position = out->position;
+    }
+    return out->complete || out->position < end;
+}
+
+static void render_moon_phase(const celestial_data_t *state, uint32_t generation, astral_emitter_t *out) {
+    (void)generation;
+    emitf(out, "%s\n", ephemeris_moon_phase_name(state->moon_phase));
+}
+
+static void render_moon_illumination(const celestial_data_t *state, uint32_t generation,
+                                     astral_emitter_t *out) {
+    (void)generation;
+    emitf(out, "%.2f\n", state->moon_illumination);
+}
+
+static void render_numerology_day(const celestial_data_t *state, uint32_t generation,
+                                  astral_emitter_t *out) {
+    (void)generation;
+    emitf(out, "%d\n", state->numerology_day);
+}
+
+static void render_planet_positions(const celestial_data_t *state, uint32_t generation,
+                                    astral_emitter_t *out) {
+    (void)generation;
+    int first = (int)out->first_record;
+    if (first == 0) {
+        emitf(out, "{\n");
+        emitf(out, "  \"timestamp\": %ld,\n", state->timestamp);
+        emitf(out, "  \"planets\": [\n");
+    }
+    
+    for (int i = first; i < state->planet_count; i++) {
+        if (!emit_record(out, (uint32_t)i)) return;
+        emitf(out, "    {\"name\": \"%s\", \"sign\": \"%s\", \"degree\": %.2f}%s\n",
+              state->planets[i].name,
+              state->planets[i].sign,
+              state->planets[i].degree,
+              (i < state->planet_count - 1) ? "," : "");
+    }
+    
+    emitf(out, "  ]\n");
+    emitf(out, "}\n");
+}
+
+/*
+ * aspects.json covers the whole catalog at the rendered state's instant.
+ * Published states keep one table per generation, so every window of a
+ * streamed read comes from the same table; at/ instants (generation 0)
+ * share a scratch table. All guarded by render_lock.
+ */
+static aspect_table_t pinned_aspects[2];
+static uint32_t pinned_generation[2];
+static aspect_table_t instant_aspects;
+static body_subset_t render_bodies;
+
+static const aspect_table_t *astral_fs_aspects(const celestial_data_t *state, uint32_t generation) {
+    aspect_table_t *table = &instant_aspects;
+    if (generation != 0) {
+        for (int i = 0; i < 2; i++) {
+            if (pinned_generation[i] == generation) return &pinned_aspects[i];
+        }
+        /* Replace the older one; the newer may still be the active slot's */
+        int victim = pinned_generation[0] < pinned_generation[1] ? 0 : 1;
+        table = &pinned_aspects[victim];
+        pinned_generation[victim] = generation;
+    }
+    
+    body_subset_clear(&render_bodies);
+    for (int i = 0; i < body_catalog_count(); i++) {
+        body_subset_add(&render_bodies, i);
+    }
+    aspect_engine_compute(state, &render_bodies, table);
+    return table;
+}
+
+/* Every aspect, however many; readers page through with astral_fs_read_at() */
+static void render_aspects(const celestial_data_t *state, uint32_t generation, astral_emitter_t *out) {
+    const aspect_table_t *table = astral_fs_aspects(state, generation);
+    
+    int first = (int)out->first_record;
+    if (first == 0) {
+        emitf(out, "{\n");
+        emitf(out, "  \"timestamp\": %ld,\n", state->timestamp);
+        emitf(out, "  \"aspects\": [\n");
+    }
+    
+    for (int i = first; i < table->count; i++) {
+        if (!emit_record(out, (uint32_t)i)) return;
+        
+        aspect_t aspect;
+        aspect_engine_entry(table, i, &aspect);
+        emitf(out, "    {\"a\": \"%s\", \"b\": \"%s\", \"aspect\": \"%s\", \"orb\": %.2f}%s\n",
+              body_catalog_name(aspect.body_a),
+              body_catalog_name(aspect.body_b),
+              aspect_engine_name(aspect.type),
+              aspect.orb,
+              (i < table->count - 1) ? "," : "");
+    }
+    
+    emitf(out, "  ]\n");
+    emitf(out, "}\n");
+}
+
+/* Fill in the header in front of a payload already written after it */
+static int finish_binary(char *buffer, astral_bin_kind_t kind, uint32_t record_size,
+                         uint32_t record_count, uint32_t payload_size, time_t timestamp) {
+    astral_bin_header_t header;
+    header.magic = ASTRAL_BIN_MAGIC;
+    header.version = ASTRAL_BIN_VERSION;
+    header.kind = (uint16_t)kind;
+    header.record_size = record_size;
+    header.record_count = record_count;
+    header.payload_size = payload_size;
+    header.checksum = astral_format_crc32(buffer + sizeof(header), payload_size);
+    header.timestamp = (int64_t)timestamp;
+    memcpy(buffer, &header, sizeof(header));
+    return (int)(sizeof(header) + payload_size);
+}
+
+static int build_planet_positions_bin(const celestial_data_t *state, uint32_t generation,
+                                      char *buffer, size_t size) {
+    (void)generation;
+    uint32_t payload = (uint32_t)state->planet_count * sizeof(astral_bin_planet_t);
+    if (sizeof(astral_bin_header_t) + payload > size) return 0;
+    
+    astral_bin_planet_t *records = (astral_bin_planet_t *)(buffer + sizeof(astral_bin_header_t));
+    for (int i = 0; i < state->planet_count; i++) {
+        astral_bin_planet_t record;
+        record.longitude = state->planets[i].degree;
+        record.body = (uint16_t)i;
+        record.sign = (uint16_t)((int)(state->planets[i].degree / 30.0) % 12);
+        record.reserved = 0;
+        memcpy(&records[i], &record, sizeof(record));
+    }
+    return finish_binary(buffer, ASTRAL_BIN_PLANETS, sizeof(astral_bin_planet_t),
+                         (uint32_t)state->planet_count, payload, state->timestamp);
+}
+
+static int build_snapshot_bin(const celestial_data_t *state, uint32_t generation,
+                              char *buffer, size_t size) {
+    (void)generation;
+    if (sizeof(astral_bin_header_t) + sizeof(astral_bin_snapshot_t) > size) return 0;
+    
+    astral_bin_snapshot_t record;
+    memset(&record, 0, sizeof(record));
+    record.timestamp = (int64_t)state->timestamp;
+    record.moon_illumination = state->moon_illumination;
+    record.moon_phase = (uint32_t)state->moon_phase;
+    record.numerology_day = (uint32_t)state->numerology_day;
+    record.planet_count = (uint32_t)state->planet_count;
+    for (int i = 0; i < state->planet_count && i < EPHEMERIS_PLANET_COUNT; i++) {
+        record.longitudes[i] = state->planets[i].degree;
+    }
+    memcpy(buffer + sizeof(astral_bin_header_t), &record, sizeof(record));
+    return finish_binary(buffer, ASTRAL_BIN_SNAPSHOT, sizeof(record), 1, sizeof(record),
+                         state->timestamp);
+}
+
+/* Columns over the rows up to this generation, oldest first */
+static int build_history_bin(const celestial_data_t *state, uint32_t generation,
+                             char *buffer, size_t size) {
+    const astral_history_row_t *rows[ASTRAL_HISTORY_ROWS];
+    uint32_t count = 0;
+    while (count < ASTRAL_HISTORY_ROWS && generation > count) {
+        const astral_history_row_t *row = &history[(generation - count) % HISTORY_CAPACITY];
+        if (row->generation != generation - count) break;
+        rows[count++] = row;
+    }
+    
+    uint32_t payload = count * ASTRAL_HISTORY_ROW_SIZE;
+    if (sizeof(astral_bin_header_t) + payload > size) return 0;
+    
+    uint8_t *column = (uint8_t *)buffer + sizeof(astral_bin_header_t);
+    for (uint32_t r = 0; r < count; r++) {
+        int64_t timestamp = (int64_t)rows[count - 1 - r]->state.timestamp;
+        memcpy(column + 8 * r, &timestamp, 8);
+    }
+    column += 8 * count;
+    for (uint32_t r = 0; r < count; r++) {
+        memcpy(column + 8 * r, &rows[count - 1 - r]->state.moon_illumination, 8);
+    }
+    column += 8 * count;
+    for (uint32_t r = 0; r < count; r++) {
+        uint32_t phase = (uint32_t)rows[count - 1 - r]->state.moon_phase;
+        memcpy(column + 4 * r, &phase, 4);
+    }
+    column += 4 * count;
+    for (uint32_t r = 0; r < count; r++) {
+        uint32_t day = (uint32_t)rows[count - 1 - r]->state.numerology_day;
+        memcpy(column + 4 * r, &day, 4);
+    }
+    column += 4 * count;
+    for (int p = 0; p < EPHEMERIS_PLANET_COUNT; p++) {
+        for (uint32_t r = 0; r < count; r++) {
+            const celestial_data_t *row = &rows[count - 1 - r]->state;
+            double longitude = p < row->planet_count ? row->planets[p].degree : 0.0;
+            memcpy(column + 8 * r, &longitude, 8);
+        }
+        column += 8 * count;
+    }
+    
+    return finish_binary(buffer, ASTRAL_BIN_HISTORY, ASTRAL_HISTORY_ROW_SIZE, count, payload,
+                         state->timestamp);
+}
+
+/* Binary images are built whole, since the header checksums the payload */
+static char binary_scratch[ASTRAL_RENDER_MAX];  /* Guarded by render_lock */
+
+static void render_planet_positions_bin(const celestial_data_t *state, uint32_t generation,
+                                        astral_emitter_t *out) {
+    int length = build_planet_positions_bin(state, generation, binary_scratch, sizeof(binary_scratch));
+    emit(out, binary_scratch, (size_t)length);
+}
+
+static void render_snapshot_bin(const celestial_data_t *state, uint32_t generation,
+                                astral_emitter_t *out) {
+    int length = build_snapshot_bin(state, generation, binary_scratch, sizeof(binary_scratch));
+    emit(out, binary_scratch, (size_t)length);
+}
+
+static void render_history_bin(const celestial_data_t *state, uint32_t generation,
+                               astral_emitter_t *out) {
+    int length = build_history_bin(state, generation, binary_scratch, sizeof(binary_scratch));
+    emit(out, binary_scratch, (size_t)length);
+}
+
+/* Regular files in the root, in listing order */
+static astral_file_t astral_files[] = {
+    {"moon_phase", render_moon_phase, {0}, {0}, {0}, {{0}}, {{0}}},
+    {"moon_illumination", render_moon_illumination, {0}, {0}, {0}, {{0}}, {{0}}},
+    {"planet_positions.json", render_planet_positions, {0}, {0}, {0}, {{0}}, {{0}}},
+    {"aspects.json", render_aspects, {0}, {0}, {0}, {{0}}, {{0}}},
+    {"numerology_day", render_numerology_day, {0}, {0}, {0}, {{0}}, {{0}}},
+    {"planet_positions.bin", render_planet_positions_bin, {0}, {0}, {0}, {{0}}, {{0}}},
+    {"snapshot.bin", render_snapshot_bin, {0}, {0}, {0}, {{0}}, {{0}}},
+    {"history.bin", render_history_bin, {0}, {0}, {0}, {{0}}, {{0}}}
+};
+
+#define ASTRAL_FILE_COUNT ((int)(sizeof(astral_files) / sizeof(astral_files[0])))
+
+/* Files that do not follow the tick; rendered on every read */
+#ifdef USERLAND_BUILD
+#define LIVE_FILE_COUNT 0
+static const char *LIVE_FILES[] = {NULL};
+#else
+#define LIVE_FILE_COUNT 1
+static const char *LIVE_FILES[] = {"memory"};
+
+/* Page allocator and slab cache counters */
+static void render_memory(astral_emitter_t *out) {
+    kmem_stats_t stats;
+    kmem_get_stats(&stats);
+    emitf(out, "pages_total: %u\npages_free: %u\nmetadata_pages: %u\nregions: %u\n",
+          stats.pages_total, stats.pages_free, stats.metadata_pages, stats.regions);
+    emitf(out, "free_blocks:");
+    for (int order = 0; order <= KMEM_MAX_ORDER; order++) {
+        emitf(out, " %u", stats.free_blocks[order]);
+    }
+    emitf(out, "\nlarge_allocs: %lu\nlarge_pages: %u\n",
+          (unsigned long)stats.large_allocs, stats.large_pages);
+    
+    kmem_cache_stats_t cache;
+    for (int i = 0; kmem_cache_get_stats(i, &cache) == 0; i++) {
+        emitf(out, "cache %s: size %u, slabs %u, in_use %u, allocs %lu, frees %lu\n",
+              cache.name, cache.object_size, cache.slabs, cache.objects_in_use,
+              (unsigned long)cache.allocs, (unsigned long)cache.frees);
+    }
+}
+#endif
+#define PATH_TABLE_SIZE   32        /* Power of two, well above the file count */
+
+/* Open-addressed name hash; holds file index + 1, 0 = empty */
+static uint8_t path_table[PATH_TABLE_SIZE];
+
+static uint32_t path_hash(const char *name) {
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void astral_fs_build_path_table(void) {
+    memset(path_table, 0, sizeof(path_table));
+    for (int i = 0; i < ASTRAL_FILE_COUNT; i++) {
+        uint32_t slot = path_hash(astral_files[i].name) & (PATH_TABLE_SIZE - 1);
+        while (path_table[slot] != 0) {
+            slot = (slot + 1) & (PATH_TABLE_SIZE - 1);
+        }
+        path_table[slot] = (uint8_t)(i + 1);
+    }
+}
+
+/* Per-trigger and per-profile files, generated from the registry */
+static const char *TRIGGER_FIELDS[] = {"expression", "exec_path", "active", "stats"};
+static const char *PROFILE_FIELDS[] = {"tradition", "triggers"};
+
+#define TRIGGER_FIELD_COUNT ((int)(sizeof(TRIGGER_FIELDS) / sizeof(TRIGGER_FIELDS[0])))
+#define PROFILE_FIELD_COUNT ((int)(sizeof(PROFILE_FIELDS) / sizeof(PROFILE_FIELDS[0])))
+
+static int astral_fs_emit_entry(const char *path, astral_emitter_t *out);
+
+/* Path relative to the mount point (or /astral); "" is the root */
+static const char *astral_fs_relative(const char *path) {
+    size_t mount_len = strlen(mount_point);
+    size_t root_len = strlen(ASTRAL_ROOT);
+    if (strncmp(path, mount_point, mount_len) == 0 &&
+        (path[mount_len] == '/' || path[mount_len] == '\0')) {
+        path += mount_len;
+    } else if (strncmp(path, ASTRAL_ROOT, root_len) == 0 &&
+               (path[root_len] == '/' || path[root_len] == '\0')) {
+        path += root_len;
+    }
+    while (*path == '/') path++;
+    return path;
+}
+
+/* Strip the mount point (or /astral) and return the file, if any */
+static astral_file_t *astral_fs_lookup(const char *path) {
+    if (!path) return NULL;
+    path = astral_fs_relative(path);
+    
+    uint32_t slot = path_hash(path) & (PATH_TABLE_SIZE - 1);
+    while (path_table[slot] != 0) {
+        astral_file_t *file = &astral_files[path_table[slot] - 1];
+        if (strcmp(file->name, path) == 0) return file;
+        slot = (slot + 1) & (PATH_TABLE_SIZE - 1);
+    }
+    return NULL;
+}
+
 /**
  * Initialize the Astral FS
  */
 int astral_fs_init(void) {
-    memset(&current_state, 0, sizeof(current_state));
+    memset(state_slots, 0, sizeof(state_slots));
+    memset(history, 0, sizeof(history));
+    memset(at_cache, 0, sizeof(at_cache));
+    at_clock = 0;
+    memset(&range_checkpoint, 0, sizeof(range_checkpoint));
+    memset(pinned_generation, 0, sizeof(pinned_generation));
+    astral_archive_init();
+    state_slots[0].generation = state_generation;
+    active_slot = 0;
+    for (int i = 0; i < ASTRAL_FILE_COUNT; i++) {
+        astral_files[i].generation[0] = 0;
+        astral_files[i].generation[1] = 0;
+    }
     printf("[ASTRAL FS] Initializing the living map...\n");
     return 0;
 }
@@ -39,16 +495,18 @@ int astral_fs_mount(const char *mount_pt) {
     }
     
     strncpy(mount_point, mount_pt, sizeof(mount_point) - 1);
+    astral_fs_build_path_table();
     is_mounted = true;
     
     printf("[ASTRAL FS] Mounted at: %s\n", mount_point);
     printf("[ASTRAL FS] Virtual files available:\n");
-    printf("  %s/moon_phase\n", mount_point);
-    printf("  %s/moon_illumination\n", mount_point);
-    printf("  %s/planet_positions.json\n", mount_point);
-    printf("  %s/numerology_day\n", mount_point);
+    for (int i = 0; i < ASTRAL_FILE_COUNT; i++) {
+        printf("  %s/%s\n", mount_point, astral_files[i].name);
+    }
     printf("  %s/triggers/\n", mount_point);
     printf("  %s/profiles/\n", mount_point);
+    printf("  %s/at/<time>/\n", mount_point);
+    printf("  %s/history/<from>..<to>\n", mount_point);
     
     return 0;
 }
@@ -68,62 +526,222 @@ int astral_fs_unmount(void) {
 
 /**
  * Update the current state
+ *
+ * Single writer (the tick). Readers are never blocked; they retry only
+ * if this runs twice while they hold a view.
  */
 int astral_fs_update_state(celestial_data_t *data) {
     if (!data) return -1;
     
-    memcpy(&current_state, data, sizeof(celestial_data_t));
+    unsigned long flags = seqlock_write_begin(&state_lock);
+    
+    int next = 1 - active_slot;
+    memcpy(&state_slots[next].state, data, sizeof(celestial_data_t));
+    if (++state_generation == 0) state_generation = 1;
+    state_slots[next].generation = state_generation;
+    
+    astral_history_row_t *row = &history[state_generation % HISTORY_CAPACITY];
+    memcpy(&row->state, data, sizeof(celestial_data_t));
+    row->generation = state_generation;
+    
+    /* Rendered files go stale; each re-renders on its next read. The
+     * release orders the copies above before the flip is seen. */
+    __atomic_store_n(&active_slot, next, __ATOMIC_RELEASE);
+    
+    seqlock_write_end(&state_lock, flags);
+    
+    astral_archive_append(data);
     return 0;
 }
 
 /**
- * Read from a virtual file
+ * Borrow the current state without copying
  */
-int astral_fs_read(const char *path, char *buffer, size_t size) {
-    if (!is_mounted || !buffer) return -1;
+int astral_fs_view_state(astral_fs_view_t *view) {
+    if (!view) return -1;
     
-    /* moon_phase */
-    if (strstr(path, "moon_phase") != NULL) {
-        snprintf(buffer, size, "%s\n", ephemeris_moon_phase_name(current_state.moon_phase));
-        return strlen(buffer);
-    }
+    do {
+        view->sequence = seqlock_read_begin(&state_lock);
+        astral_state_slot_t *slot = &state_slots[__atomic_load_n(&active_slot, __ATOMIC_ACQUIRE)];
+        view->state = &slot->state;
+        view->generation = slot->generation;
+        view->data = NULL;
+        view->length = 0;
+        view->size = 0;
+    } while (seqlock_read_stale(&state_lock, view->sequence));
     
-    /* moon_illumination */
-    if (strstr(path, "moon_illumination") != NULL) {
-        snprintf(buffer, size, "%.2f\n", current_state.moon_illumination);
-        return strlen(buffer);
-    }
+    return 0;
+}
+
+/* Render a file for a slot unless another reader already has */
+static void astral_fs_render(astral_file_t *file, int slot, uint32_t generation, uint32_t sequence) {
+    unsigned long flags = spin_lock(&render_lock);
     
-    /* numerology_day */
-    if (strstr(path, "numerology_day") != NULL) {
-        snprintf(buffer, size, "%d\n", current_state.numerology_day);
-        return strlen(buffer);
+    if (file->generation[slot] != generation) {
+        file->generation[slot] = 0;
+        sync_barrier();
+        
+        /* Run to the end: the head is cached, the rest only counted */
+        astral_emitter_t out;
+        memset(&out, 0, sizeof(out));
+        out.buffer = file->rendered[slot];
+        out.size = sizeof(file->rendered[slot]);
+        out.complete = true;
+        file->render(&state_slots[slot].state, generation, &out);
+        
+        /* Only publish output rendered from a state that stayed put */
+        if (!seqlock_read_stale(&state_lock, sequence)) {
+            file->length[slot] = out.position < out.size ? (int)out.position : (int)out.size;
+            file->size[slot] = out.position;
+            sync_barrier();
+            file->generation[slot] = generation;
+        }
     }
     
-    /* planet_positions.json */
-    if (strstr(path, "planet_positions.json") != NULL) {
-        int offset = 0;
-        offset += snprintf(buffer + offset, size - offset, "{\n");
-        offset += snprintf(buffer + offset, size - offset, "  \"timestamp\": %ld,\n", 
-                          current_state.timestamp);
-        offset += snprintf(buffer + offset, size - offset, "  \"planets\": [\n");
+    spin_unlock(&render_lock, flags);
+}
+
+/**
+ * Borrow a file's rendered contents without copying
+ *
+ * The view stays usable until astral_fs_view_valid() says otherwise;
+ * check it after consuming the data and retry if it fails.
+ */
+int astral_fs_view_file(const char *path, astral_fs_view_t *view) {
+    if (!is_mounted || !view) return -1;
+    
+    astral_file_t *file = astral_fs_lookup(path);
+    if (!file) return -1;
+    
+    while (1) {
+        uint32_t sequence = seqlock_read_begin(&state_lock);
+        int slot = __atomic_load_n(&active_slot, __ATOMIC_ACQUIRE);
+        uint32_t generation = state_slots[slot].generation;
+        
+        if (file->generation[slot] != generation) {
+            astral_fs_render(file, slot, generation, sequence);
+        }
+        
+        view->sequence = sequence;
+        view->generation = generation;
+        view->state = &state_slots[slot].state;
+        view->data = file->rendered[slot];
+        view->length = (size_t)file->length[slot];
+        view->size = file->size[slot];
+        
+        sync_barrier();
+        if (file->generation[slot] == generation &&
+            !seqlock_read_stale(&state_lock, sequence)) {
+            return 0;
+        }
+    }
+}
+
+/**
+ * Check that a borrowed view has not been overwritten
+ */
+bool astral_fs_view_valid(const astral_fs_view_t *view) {
+    return view && !seqlock_read_stale(&state_lock, view->sequence);
+}
+
+/*
+ * Render the window [offset, offset + length) of a file that does not fit
+ * its cache. Resumes from the last checkpoint when the previous read of
+ * this generation stopped at or before offset, so paging forward costs
+ * one window per read instead of the whole prefix.
+ */
+static int astral_fs_stream(astral_file_t *file, uint64_t offset, char *buffer, size_t length) {
+    while (1) {
+        unsigned long flags = spin_lock(&render_lock);
+        uint32_t sequence = seqlock_read_begin(&state_lock);
+        int slot = __atomic_load_n(&active_slot, __ATOMIC_ACQUIRE);
+        uint32_t generation = state_slots[slot].generation;
         
-        for (int i = 0; i < current_state.planet_count; i++) {
-            offset += snprintf(buffer + offset, size - offset,
-                              "    {\"name\": \"%s\", \"sign\": \"%s\", \"degree\": %.2f}%s\n",
-                              current_state.planets[i].name,
-                              current_state.planets[i].sign,
-                              current_state.planets[i].degree,
-                              (i < current_state.planet_count - 1) ? "," : "");
+        astral_checkpoint_t checkpoint = {generation, 0, 0};
+        astral_checkpoint_t *last = &file->checkpoint[slot];
+        if (last->generation == generation && last->position <= offset) {
+            checkpoint = *last;
         }
         
-        offset += snprintf(buffer + offset, size - offset, "  ]\n");
-        offset += snprintf(buffer + offset, size - offset, "}\n");
+        astral_emitter_t out;
+        memset(&out, 0, sizeof(out));
+        out.buffer = buffer;
+        out.size = length;
+        out.offset = offset;
+        out.position = checkpoint.position;
+        out.first_record = checkpoint.record;
+        out.checkpoint = &checkpoint;
+        file->render(&state_slots[slot].state, generation, &out);
+        
+        bool stale = seqlock_read_stale(&state_lock, sequence);
+        if (!stale) {
+            *last = checkpoint;
+        }
+        spin_unlock(&render_lock, flags);
         
-        return offset;
+        if (!stale) {
+            uint64_t end = out.position < offset + length ? out.position : offset + length;
+            return end > offset ? (int)(end - offset) : 0;
+        }
+    }
+}
+
+/**
+ * Read part of a virtual file, like pread()
+ *
+ * Returns the number of bytes copied, 0 at end of file. Files larger
+ * than ASTRAL_RENDER_MAX are rendered window by window from the same
+ * state generation, so memory stays bounded by the caller's buffer.
+ */
+int astral_fs_read_at(const char *path, uint64_t offset, char *buffer, size_t length) {
+    if (!is_mounted || !buffer) return -1;
+    
+    astral_file_t *file = astral_fs_lookup(path);
+    if (!file) {
+        /* Trigger, profile and live files are small and rendered per read */
+        astral_emitter_t out;
+        memset(&out, 0, sizeof(out));
+        out.buffer = buffer;
+        out.size = length;
+        out.offset = offset;
+        if (astral_fs_emit_entry(path, &out) != 0) return -1;
+        uint64_t end = out.position < offset + length ? out.position : offset + length;
+        return end > offset ? (int)(end - offset) : 0;
     }
     
-    return -1;
+    astral_fs_view_t view;
+    int copied;
+    
+    do {
+        if (astral_fs_view_file(path, &view) != 0) return -1;
+        
+        if (view.size > view.length && offset + length > view.length) {
+            copied = astral_fs_stream(file, offset, buffer, length);
+        } else if (offset >= view.length) {
+            copied = 0;
+        } else {
+            copied = (int)(view.length - (size_t)offset < length ? view.length - (size_t)offset : length);
+            memcpy(buffer, view.data + (size_t)offset, (size_t)copied);
+        }
+    } while (!astral_fs_view_valid(&view));
+    
+    return copied;
+}
+
+/**
+ * Read from a virtual file
+ *
+ * The start of the file, NUL-terminated; use astral_fs_read_at() to
+ * page through files larger than the buffer.
+ */
+int astral_fs_read(const char *path, char *buffer, size_t size) {
+    if (!is_mounted || !buffer || size == 0) return -1;
+    
+    int length = astral_fs_read_at(path, 0, buffer, size - 1);
+    if (length < 0) return -1;
+    
+    buffer[length] = '\0';
+    return length;
 }
 
 /**
@@ -137,29 +755,466 @@ int astral_fs_write(const char *path, const char *buffer, size_t size) {
 
 /**
  * List directory contents
+ *
+ * Returns strdup'd names the caller frees, directories ending in '/'.
  */
 int astral_fs_list(const char *path, char **entries, int max_entries) {
     if (!is_mounted) return -1;
     
-    if (strcmp(path, mount_point) == 0 || strcmp(path, "/astral") == 0) {
-        const char *root_files[] = {
-            "moon_phase",
-            "moon_illumination",
-            "planet_positions.json",
-            "numerology_day",
-            "triggers/",
-            "profiles/"
-        };
+    uint32_t cursor = 0;
+    astral_dirent_t dirent;
+    int count = 0;
+    while (count < max_entries && astral_fs_readdir(path, &cursor, &dirent, 1) == 1) {
+        char name[sizeof(dirent.name) + 1];
+        snprintf(name, sizeof(name), "%s%s", dirent.name,
+                 dirent.type == ASTRAL_DIRENT_DIR ? "/" : "");
+        entries[count++] = strdup(name);
+    }
+    
+    return count;
+}
+
+/* Copy a relative path without trailing slashes */
+static int astral_fs_normalize(const char *path, char *relative, size_t size) {
+    if (!path) return -1;
+    
+    const char *start = astral_fs_relative(path);
+    size_t length = strlen(start);
+    while (length > 0 && start[length - 1] == '/') length--;
+    if (length >= size) return -1;
+    
+    memcpy(relative, start, length);
+    relative[length] = '\0';
+    return 0;
+}
+
+/* Split "<dir>/<name>[/<field>]"; field is "" when absent */
+static bool astral_fs_split(const char *relative, const char *dir, char *name, size_t size,
+                            const char **field) {
+    size_t dir_len = strlen(dir);
+    if (strncmp(relative, dir, dir_len) != 0 || relative[dir_len] != '/') return false;
+    
+    const char *start = relative + dir_len + 1;
+    const char *end = start;
+    while (*end && *end != '/') end++;
+    
+    size_t length = (size_t)(end - start);
+    if (length == 0 || length >= size) return false;
+    memcpy(name, start, length);
+    name[length] = '\0';
+    *field = (*end == '/') ? end + 1 : end;
+    return true;
+}
+
+static void astral_fs_dirent(astral_dirent_t *entry, const char *name, astral_dirent_type_t type) {
+    strncpy(entry->name, name, sizeof(entry->name) - 1);
+    entry->name[sizeof(entry->name) - 1] = '\0';
+    entry->type = type;
+}
+
+static int astral_fs_list_fields(const char **fields, int field_count, uint32_t *cursor,
+                                 astral_dirent_t *entries, int max_entries) {
+    int count = 0;
+    while (*cursor < (uint32_t)field_count && count < max_entries) {
+        astral_fs_dirent(&entries[count++], fields[(*cursor)++], ASTRAL_DIRENT_FILE);
+    }
+    return count;
+}
+
+/* The loaded profile, if name names it */
+static const ritual_profile_t *astral_fs_profile(const char *name) {
+    const ritual_profile_t *profile = destiny_engine_current_profile();
+    if (profile->name[0] == '\0' || strcmp(profile->name, name) != 0) return NULL;
+    return profile;
+}
+
+/* Days since 1970-01-01 for a proleptic Gregorian date */
+static long astral_fs_days_from_civil(int year, int month, int day) {
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int year_of_era = year - era * 400;
+    int day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return (long)era * 146097 + day_of_era - 719468;
+}
+
+/* Length of a month, proleptic Gregorian */
+static int astral_fs_days_in_month(int year, int month) {
+    static const int DAYS[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return month == 2 && leap ? 29 : DAYS[month - 1];
+}
+
+/* Read exactly `digits` decimal digits */
+static bool astral_fs_digits(const char **text, int digits, int *value) {
+    *value = 0;
+    for (int i = 0; i < digits; i++) {
+        char c = (*text)[i];
+        if (c < '0' || c > '9') return false;
+        *value = *value * 10 + (c - '0');
+    }
+    *text += digits;
+    return true;
+}
+
+/* Instants the calendar code handles: the years 0000 to 9999 */
+#define ASTRAL_TIME_MIN (-62167219200LL)    /* 0000-01-01T00:00:00Z */
+#define ASTRAL_TIME_MAX 253402300799LL      /* 9999-12-31T23:59:59Z */
+
+/* Store seconds if they are in range and time_t can hold them; it is 32 bits on i386 */
+static int astral_fs_store_time(int64_t seconds, time_t *timestamp) {
+    if (seconds < ASTRAL_TIME_MIN || seconds > ASTRAL_TIME_MAX) return -1;
+    if ((int64_t)(time_t)seconds != seconds) return -1;
+    *timestamp = (time_t)seconds;
+    return 0;
+}
+
+/*
+ * Parse an at/ directory name: Unix seconds ("1735689600", may be
+ * negative) or UTC ISO 8601 ("2025-03-14", "2025-03-14T00:00Z",
+ * "2025-03-14T00:00:30Z"). Instants outside 0000-9999 or past what
+ * time_t holds are rejected.
+ */
+static int astral_fs_parse_time(const char *text, time_t *timestamp) {
+    const char *p = text;
+    bool negative = (*p == '-');
+    if (negative) p++;
+    
+    if (*p) {
+        int64_t seconds = 0;
+        const char *digit = p;
+        while (*digit >= '0' && *digit <= '9') {
+            seconds = seconds * 10 + (*digit++ - '0');
+            if (seconds > ASTRAL_TIME_MAX + 1) return -1;
+        }
+        if (*digit == '\0') {
+            return astral_fs_store_time(negative ? -seconds : seconds, timestamp);
+        }
+    }
+    if (negative) return -1;
+    
+    int year, month, day, hour = 0, minute = 0, second = 0;
+    if (!astral_fs_digits(&p, 4, &year) || *p++ != '-' ||
+        !astral_fs_digits(&p, 2, &month) || *p++ != '-' ||
+        !astral_fs_digits(&p, 2, &day)) {
+        return -1;
+    }
+    if (*p == 'T') {
+        p++;
+        if (!astral_fs_digits(&p, 2, &hour) || *p++ != ':' || !astral_fs_digits(&p, 2, &minute)) {
+            return -1;
+        }
+        if (*p == ':') {
+            p++;
+            if (!astral_fs_digits(&p, 2, &second)) return -1;
+        }
+    }
+    if (*p == 'Z') p++;
+    if (*p != '\0' || month < 1 || month > 12 || day < 1 ||
+        day > astral_fs_days_in_month(year, month) ||
+        hour > 23 || minute > 59 || second > 60) {
+        return -1;
+    }
+    
+    return astral_fs_store_time((int64_t)astral_fs_days_from_civil(year, month, day) * 86400 +
+                                hour * 3600 + minute * 60 + second, timestamp);
+}
+
+/* history.bin is the live ring; an instant has no history of its own */
+static bool astral_fs_at_renders(const astral_file_t *file) {
+    return file->render != render_history_bin;
+}
+
+/* Timestamp held by a cache entry, if it is in use */
+static bool astral_fs_at_cached(int index, time_t *timestamp) {
+    unsigned long flags = spin_lock(&at_lock);
+    bool used = at_cache[index].last_used != 0;
+    *timestamp = at_cache[index].timestamp;
+    spin_unlock(&at_lock, flags);
+    return used;
+}
+
+/*
+ * Copy the state at an instant, computing it on a miss. The ephemeris
+ * runs outside the lock; the least recently used entry makes room.
+ */
+static void astral_fs_at_state(time_t timestamp, celestial_data_t *state) {
+    unsigned long flags = spin_lock(&at_lock);
+    for (int i = 0; i < ASTRAL_AT_CACHE; i++) {
+        if (at_cache[i].last_used != 0 && at_cache[i].timestamp == timestamp) {
+            at_cache[i].last_used = ++at_clock;
+            memcpy(state, &at_cache[i].state, sizeof(*state));
+            spin_unlock(&at_lock, flags);
+            return;
+        }
+    }
+    spin_unlock(&at_lock, flags);
+    
+    memset(state, 0, sizeof(*state));
+    ephemeris_get_data_at_time(timestamp, state);
+    
+    flags = spin_lock(&at_lock);
+    int victim = 0;
+    for (int i = 0; i < ASTRAL_AT_CACHE; i++) {
+        if (at_cache[i].last_used != 0 && at_cache[i].timestamp == timestamp) {
+            victim = i;     /* Another reader computed it meanwhile */
+            break;
+        }
+        if (at_cache[i].last_used < at_cache[victim].last_used) victim = i;
+    }
+    at_cache[victim].timestamp = timestamp;
+    at_cache[victim].last_used = ++at_clock;
+    memcpy(&at_cache[victim].state, state, sizeof(*state));
+    spin_unlock(&at_lock, flags);
+}
+
+/* Parse "<from>..<to>"; an empty side is open */
+static int astral_fs_parse_range(const char *text, time_t *from, time_t *to) {
+    const char *dots = strstr(text, "..");
+    if (!dots) return -1;
+    
+    char side[32];
+    size_t length = (size_t)(dots - text);
+    if (length >= sizeof(side)) return -1;
+    memcpy(side, text, length);
+    side[length] = '\0';
+    
+    *to = (time_t)(~0UL >> 1);      /* Latest time_t */
+    *from = -*to - 1;
+    if (length > 0 && astral_fs_parse_time(side, from) != 0) return -1;
+    if (dots[2] != '\0' && astral_fs_parse_time(dots + 2, to) != 0) return -1;
+    return 0;
+}
+
+/* Archived ticks as text rows; resumes at the row the emitter names */
+static void astral_fs_render_range(time_t from, time_t to, astral_emitter_t *out) {
+    uint32_t cursor = out->first_record;
+    if (cursor == 0) {
+        emitf(out, "# timestamp moon_phase moon_illumination numerology_day");
+        for (int i = 0; i < EPHEMERIS_PLANET_COUNT; i++) {
+            emitf(out, " %s", ephemeris_planet_name(i));
+        }
+        emitf(out, "\n");
+    }
+    
+    astral_archive_sample_t samples[32];
+    int count;
+    while ((count = astral_archive_read(from, to, &cursor, samples, 32)) > 0) {
+        for (int i = 0; i < count; i++) {
+            const astral_archive_sample_t *sample = &samples[i];
+            if (!emit_record(out, sample->row)) return;
+            
+            emitf(out, "%ld %s %.2f %d", (long)sample->timestamp,
+                  ephemeris_moon_phase_name((moon_phase_t)sample->moon_phase),
+                  sample->moon_illumination, sample->numerology_day);
+            for (int p = 0; p < EPHEMERIS_PLANET_COUNT; p++) {
+                emitf(out, " %.2f", sample->longitudes[p]);
+            }
+            emitf(out, "\n");
+        }
+    }
+}
+
+/**
+ * Read directory entries into a caller buffer
+ *
+ * Start with *cursor = 0 and call until it returns 0; the cursor
+ * remembers the position between calls. Trigger directories come
+ * straight from the registry, so each call costs only the entries it
+ * returns. Returns the number of entries written, -1 for a bad path.
+ */
+int astral_fs_readdir(const char *path, uint32_t *cursor, astral_dirent_t *entries, int max_entries) {
+    if (!is_mounted || !cursor || !entries || max_entries <= 0) return -1;
+    
+    char relative[256];
+    char name[64];
+    const char *field;
+    int count = 0;
+    if (astral_fs_normalize(path, relative, sizeof(relative)) != 0) return -1;
+    
+    if (relative[0] == '\0') {
+        /* Rendered files first, then the live ones, then the directories */
+        static const char *DIRS[] = {"triggers", "profiles", "at", "history"};
+        const int files = ASTRAL_FILE_COUNT + LIVE_FILE_COUNT;
+        while (*cursor < (uint32_t)files + 4 && count < max_entries) {
+            int index = (int)(*cursor)++;
+            if (index < ASTRAL_FILE_COUNT) {
+                astral_fs_dirent(&entries[count++], astral_files[index].name, ASTRAL_DIRENT_FILE);
+            } else if (index < files) {
+                astral_fs_dirent(&entries[count++], LIVE_FILES[index - ASTRAL_FILE_COUNT], ASTRAL_DIRENT_FILE);
+            } else {
+                astral_fs_dirent(&entries[count++], DIRS[index - files], ASTRAL_DIRENT_DIR);
+            }
+        }
+        return count;
+    }
+    
+    if (strcmp(relative, "at") == 0) {
+        /* Any instant can be opened; only the cached ones are listed */
+        while (*cursor < ASTRAL_AT_CACHE && count < max_entries) {
+            time_t timestamp;
+            if (astral_fs_at_cached((int)(*cursor)++, &timestamp)) {
+                char stamp[24];
+                snprintf(stamp, sizeof(stamp), "%ld", (long)timestamp);
+                astral_fs_dirent(&entries[count++], stamp, ASTRAL_DIRENT_DIR);
+            }
+        }
+        return count;
+    }
+    
+    if (strcmp(relative, "history") == 0) {
+        /* One range per archive chunk; any other range can be opened too */
+        time_t first, last;
+        while (count < max_entries && astral_archive_chunk((int)*cursor, &first, &last)) {
+            char range[64];
+            snprintf(range, sizeof(range), "%ld..%ld", (long)first, (long)last);
+            astral_fs_dirent(&entries[count++], range, ASTRAL_DIRENT_FILE);
+            (*cursor)++;
+        }
+        return count;
+    }
+    
+    time_t instant;
+    if (astral_fs_split(relative, "at", name, sizeof(name), &field) && field[0] == '\0' &&
+        astral_fs_parse_time(name, &instant) == 0) {
+        while (*cursor < (uint32_t)ASTRAL_FILE_COUNT && count < max_entries) {
+            astral_file_t *file = &astral_files[(*cursor)++];
+            if (astral_fs_at_renders(file)) {
+                astral_fs_dirent(&entries[count++], file->name, ASTRAL_DIRENT_FILE);
+            }
+        }
+        return count;
+    }
+    
+    if (strcmp(relative, "triggers") == 0) {
+        char trigger_name[64];
+        while (count < max_entries &&
+               destiny_engine_trigger_name_at((int)*cursor, trigger_name, sizeof(trigger_name)) == 0) {
+            astral_fs_dirent(&entries[count++], trigger_name, ASTRAL_DIRENT_DIR);
+            (*cursor)++;
+        }
+        return count;
+    }
+    
+    if (strcmp(relative, "profiles") == 0) {
+        const ritual_profile_t *profile = destiny_engine_current_profile();
+        if (*cursor == 0 && profile->name[0] != '\0') {
+            astral_fs_dirent(&entries[count++], profile->name, ASTRAL_DIRENT_DIR);
+            (*cursor)++;
+        }
+        return count;
+    }
+    
+    if (astral_fs_split(relative, "triggers", name, sizeof(name), &field) && field[0] == '\0' &&
+        destiny_engine_get_trigger(name)) {
+        return astral_fs_list_fields(TRIGGER_FIELDS, TRIGGER_FIELD_COUNT, cursor, entries, max_entries);
+    }
+    
+    if (astral_fs_split(relative, "profiles", name, sizeof(name), &field) && field[0] == '\0' &&
+        astral_fs_profile(name)) {
+        return astral_fs_list_fields(PROFILE_FIELDS, PROFILE_FIELD_COUNT, cursor, entries, max_entries);
+    }
+    
+    return -1;
+}
+
+/* Render a trigger, profile, at/ or history/ file through an emitter */
+static int astral_fs_emit_entry(const char *path, astral_emitter_t *out) {
+    char relative[256];
+    char name[64];
+    const char *field;
+    if (astral_fs_normalize(path, relative, sizeof(relative)) != 0) return -1;
+
+#ifndef USERLAND_BUILD
+    if (strcmp(relative, "memory") == 0) {
+        render_memory(out);
+        return 0;
+    }
+#endif
+
+    if (astral_fs_split(relative, "at", name, sizeof(name), &field)) {
+        time_t timestamp;
+        astral_file_t *file = astral_fs_lookup(field);
+        if (!file || !astral_fs_at_renders(file) || astral_fs_parse_time(name, &timestamp) != 0) {
+            return -1;
+        }
         
-        int count = sizeof(root_files) / sizeof(root_files[0]);
-        if (count > max_entries) count = max_entries;
+        celestial_data_t state;
+        astral_fs_at_state(timestamp, &state);
         
-        for (int i = 0; i < count; i++) {
-            entries[i] = strdup(root_files[i]);
+        unsigned long flags = spin_lock(&render_lock);
+        file->render(&state, 0, out);
+        spin_unlock(&render_lock, flags);
+        return 0;
+    }
+    
+    if (strncmp(relative, "history/", 8) == 0) {
+        time_t from, to;
+        if (astral_fs_parse_range(relative + 8, &from, &to) != 0) return -1;
+        
+        /*
+         * Rows are only appended after existing ones, so a position stays
+         * valid until a chunk is evicted; resume only for the same range
+         * with nothing evicted since.
+         */
+        astral_archive_stats_t stats;
+        astral_archive_get_stats(&stats);
+        
+        astral_range_checkpoint_t range = {from, to, stats.appended - stats.rows, {1, 0, 0}};
+        unsigned long flags = spin_lock(&render_lock);
+        if (range_checkpoint.checkpoint.generation != 0 &&
+            range_checkpoint.from == from && range_checkpoint.to == to &&
+            range_checkpoint.evicted == range.evicted &&
+            range_checkpoint.checkpoint.position <= out->offset) {
+            range.checkpoint = range_checkpoint.checkpoint;
         }
+        spin_unlock(&render_lock, flags);
         
-        return count;
+        out->position = range.checkpoint.position;
+        out->first_record = range.checkpoint.record;
+        out->checkpoint = &range.checkpoint;
+        astral_fs_render_range(from, to, out);
+        
+        flags = spin_lock(&render_lock);
+        range_checkpoint = range;
+        spin_unlock(&render_lock, flags);
+        return 0;
     }
     
-    return 0;
+    if (astral_fs_split(relative, "triggers", name, sizeof(name), &field)) {
+        trigger_t trigger;
+        if (destiny_engine_copy_trigger(name, &trigger) != 0) return -1;
+        
+        if (strcmp(field, "expression") == 0) {
+            emitf(out, "%s\n", trigger.expression);
+        } else if (strcmp(field, "exec_path") == 0) {
+            emitf(out, "%s\n", trigger.exec_path);
+        } else if (strcmp(field, "active") == 0) {
+            emitf(out, "%d\n", trigger.active ? 1 : 0);
+        } else if (strcmp(field, "stats") == 0) {
+            emitf(out, "evaluations: %u\nawakenings: %u\nlast_awakened: %ld\n",
+                  trigger.evaluations, trigger.awakenings, (long)trigger.last_awakened);
+        } else {
+            return -1;
+        }
+        return 0;
+    }
+    
+    if (astral_fs_split(relative, "profiles", name, sizeof(name), &field)) {
+        const ritual_profile_t *profile = astral_fs_profile(name);
+        if (!profile) return -1;
+        
+        if (strcmp(field, "tradition") == 0) {
+            emitf(out, "%s\n", profile->tradition);
+        } else if (strcmp(field, "triggers") == 0) {
+            for (int i = 0; i < profile->trigger_count; i++) {
+                emitf(out, "%s\n", profile->triggers[i].name);
+            }
+        } else {
+            return -1;
+        }
+        return 0;
+    }
+    
+    return -1;
 }
@@ -8,6 +8,8 @@
 #define ASTRAL_FS_H
 
 #include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include "ephemeris_provider.h"
 
 /* Virtual file paths */
@@ -15,9 +17,42 @@
 #define ASTRAL_MOON_PHASE ASTRAL_ROOT "/moon_phase"
 #define ASTRAL_MOON_ILLUMINATION ASTRAL_ROOT "/moon_illumination"
 #define ASTRAL_PLANETS ASTRAL_ROOT "/planet_positions.json"
+#define ASTRAL_ASPECTS ASTRAL_ROOT "/aspects.json"
 #define ASTRAL_NUMEROLOGY ASTRAL_ROOT "/numerology_day"
+#define ASTRAL_PLANETS_BIN ASTRAL_ROOT "/planet_positions.bin"
+#define ASTRAL_SNAPSHOT_BIN ASTRAL_ROOT "/snapshot.bin"
+#define ASTRAL_HISTORY_BIN ASTRAL_ROOT "/history.bin"
 #define ASTRAL_TRIGGERS ASTRAL_ROOT "/triggers"
 #define ASTRAL_PROFILES ASTRAL_ROOT "/profiles"
+#define ASTRAL_AT ASTRAL_ROOT "/at"
+#define ASTRAL_HISTORY ASTRAL_ROOT "/history"
+
+/* Cached bytes per rendered file; larger files stream through astral_fs_read_at() */
+#define ASTRAL_RENDER_MAX 8192
+
+/* Instants kept computed under /astral/at/<time>/ */
+#define ASTRAL_AT_CACHE 16
+
+/* Directory entries, filled by astral_fs_readdir() without allocating */
+typedef enum {
+    ASTRAL_DIRENT_FILE = 0,
+    ASTRAL_DIRENT_DIR
+} astral_dirent_type_t;
+
+typedef struct {
+    char name[64];
+    astral_dirent_type_t type;
+} astral_dirent_t;
+
+/* Zero-copy view of the current state or a rendered file */
+typedef struct {
+    const celestial_data_t *state;  /* Borrowed; see astral_fs_view_valid() */
+    const char *data;               /* Rendered file contents, NULL for state views */
+    size_t length;                  /* Bytes at data */
+    uint64_t size;                  /* Full file size; more than length if it streams */
+    uint32_t generation;            /* Bumped by every state update */
+    uint32_t sequence;
+} astral_fs_view_t;
 
 /* Astral FS Interface */
 int astral_fs_init(void);
@@ -27,8 +62,15 @@ int astral_fs_unmount(void);
 
 /* Virtual file operations */
 int astral_fs_read(const char *path, char *buffer, size_t size);
+int astral_fs_read_at(const char *path, uint64_t offset, char *buffer, size_t length);
 int astral_fs_write(const char *path, const char *buffer, size_t size);
 int astral_fs_list(const char *path, char **entries, int max_entries);
+int astral_fs_readdir(const char *path, uint32_t *cursor, astral_dirent_t *entries, int max_entries);
+
+/* Zero-copy reads */
+int astral_fs_view_state(astral_fs_view_t *view);
+int astral_fs_view_file(const char *path, astral_fs_view_t *view);
+bool astral_fs_view_valid(const astral_fs_view_t *view);
 
 /* Update functions */
 int astral_fs_update_state(celestial_data_t *data);
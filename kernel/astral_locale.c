@@ -0,0 +1,350 @@
+/**
+ * Astral Locale - Implementation
+ *
+ * Per timestamp, the ephemeris, Greenwich sidereal time and a day of
+ * moon positions are computed once. Locations that miss the cache are
+ * then processed in chunks laid out as parallel arrays, one pass per
+ * quantity, so each pass is a straight loop over the chunk. The cache,
+ * the shared work and the chunk scratch are guarded by locale_lock, held
+ * for one timestamp of a batch at a time.
+ */
+
+#include "freestanding.h"
+#include "astral_locale.h"
+#include "sync.h"
+
+#define DEG               (M_PI / 180.0)
+#define OBLIQUITY         23.4392911     /* Mean obliquity of the ecliptic, J2000 */
+#define J2000             946728000      /* 2000-01-01 12:00 UTC */
+#define MOON_INDEX        1              /* Sun, Moon, Mercury, ... */
+#define MOON_SCAN_STEP    1200           /* Seconds between moon altitude samples */
+#define MOON_SCAN_SAMPLES 73             /* 24 hours, both ends included */
+#define MOON_HORIZON      0.125          /* Altitude of the moon's center at rise */
+#define CACHE_VALID       (1ULL << 63)
+
+typedef struct {
+    uint64_t key;                        /* Geohash | CACHE_VALID */
+    local_sky_t sky;
+} locale_cache_entry_t;
+
+static spinlock_t locale_lock = SPINLOCK_INIT;
+static locale_cache_entry_t locale_cache[LOCALE_CACHE_SIZE];
+static astral_locale_stats_t locale_stats;
+
+/* Work shared by every location at one timestamp */
+static struct {
+    bool valid;
+    time_t timestamp;
+    celestial_data_t data;
+    double gmst;                                /* Degrees */
+    double sin_obliquity;
+    double cos_obliquity;
+    double moon_hour_base[MOON_SCAN_SAMPLES];   /* GMST - RA; add longitude for hour angle */
+    double moon_sin_dec[MOON_SCAN_SAMPLES];
+    double moon_cos_dec[MOON_SCAN_SAMPLES];
+} shared;
+
+/* Chunk scratch, one array per quantity */
+static int chunk_index[LOCALE_BATCH_CHUNK];
+static uint64_t chunk_key[LOCALE_BATCH_CHUNK];
+static double chunk_lat[LOCALE_BATCH_CHUNK];
+static double chunk_lon[LOCALE_BATCH_CHUNK];
+static double chunk_sin_lat[LOCALE_BATCH_CHUNK];
+static double chunk_cos_lat[LOCALE_BATCH_CHUNK];
+static double chunk_lst[LOCALE_BATCH_CHUNK];
+static double chunk_altitude[LOCALE_BATCH_CHUNK];
+static double chunk_previous[LOCALE_BATCH_CHUNK];
+
+static double normalize(double degree) {
+    degree = fmod(degree, 360.0);
+    if (degree < 0.0) degree += 360.0;
+    if (degree >= 360.0) degree = 0.0;
+    return degree;
+}
+
+static uint32_t quantize(double value, double min, double span) {
+    double cells = (double)(1u << LOCALE_GEOHASH_BITS);
+    double q = (value - min) / span * cells;
+    if (q < 0.0) q = 0.0;
+    if (q > cells - 1.0) q = cells - 1.0;
+    return (uint32_t)q;
+}
+
+static double cell_center(uint32_t q, double min, double span) {
+    return min + ((double)q + 0.5) * span / (double)(1u << LOCALE_GEOHASH_BITS);
+}
+
+/* First slot of the key's two-way set */
+static uint32_t cache_set(uint64_t key, time_t timestamp) {
+    uint64_t h = key ^ ((uint64_t)(uint32_t)timestamp * 0x9E3779B97F4A7C15ULL);
+    h ^= h >> 29;
+    return (uint32_t)h & (LOCALE_CACHE_SIZE - 2);
+}
+
+static locale_cache_entry_t *cache_lookup(uint64_t key, time_t timestamp) {
+    uint32_t set = cache_set(key, timestamp);
+    for (uint32_t way = 0; way < 2; way++) {
+        locale_cache_entry_t *entry = &locale_cache[set + way];
+        if (entry->key == (key | CACHE_VALID) && entry->sky.timestamp == timestamp) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/* Prefer an empty or stale way; otherwise evict the older of the two */
+static void cache_insert(uint64_t key, const local_sky_t *sky) {
+    uint32_t set = cache_set(key, sky->timestamp);
+    locale_cache_entry_t *first = &locale_cache[set];
+    locale_cache_entry_t *second = &locale_cache[set + 1];
+    locale_cache_entry_t *victim = first;
+    
+    if (!(first->key & CACHE_VALID)) {
+        victim = first;
+    } else if (!(second->key & CACHE_VALID)) {
+        victim = second;
+    } else if (second->sky.timestamp < first->sky.timestamp) {
+        victim = second;
+    } else if (second->sky.timestamp == first->sky.timestamp) {
+        victim = (key & 1) ? second : first;
+    }
+    
+    victim->key = key | CACHE_VALID;
+    memcpy(&victim->sky, sky, sizeof(local_sky_t));
+}
+
+/* Greenwich mean sidereal time in degrees */
+static double greenwich_sidereal(time_t timestamp) {
+    double days = difftime(timestamp, J2000) / 86400.0;
+    return normalize(280.46061837 + 360.98564736629 * days);
+}
+
+/* Day of month for a Unix time, proleptic Gregorian */
+static int day_of_month(time_t seconds) {
+    long days = (long)(seconds / 86400);
+    if (seconds % 86400 < 0) days--;
+    
+    long z = days + 719468;
+    long era = (z >= 0 ? z : z - 146096) / 146097;
+    long doe = z - era * 146097;
+    long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    long mp = (5 * doy + 2) / 153;
+    return (int)(doy - (153 * mp + 2) / 5 + 1);
+}
+
+/* Porphyry: trisect each quadrant between the angles */
+static void porphyry_cusps(double ascendant, double midheaven, double *cusps) {
+    double angles[4] = {
+        ascendant,
+        normalize(midheaven + 180.0),
+        normalize(ascendant + 180.0),
+        midheaven
+    };
+    
+    for (int q = 0; q < 4; q++) {
+        double arc = normalize(angles[(q + 1) % 4] - angles[q]);
+        for (int k = 0; k < 3; k++) {
+            cusps[q * 3 + k] = normalize(angles[q] + arc * k / 3.0);
+        }
+    }
+}
+
+static int house_of(double degree, const double *cusps) {
+    for (int h = 0; h < LOCALE_HOUSE_COUNT; h++) {
+        double span = normalize(cusps[(h + 1) % LOCALE_HOUSE_COUNT] - cusps[h]);
+        if (normalize(degree - cusps[h]) < span) return h + 1;
+    }
+    return 1;
+}
+
+/* Ephemeris, sidereal time and a day of moon positions for one instant */
+static void prepare_shared(time_t timestamp) {
+    if (shared.valid && shared.timestamp == timestamp) return;
+    
+    ephemeris_get_data_at_time(timestamp, &shared.data);
+    shared.timestamp = timestamp;
+    shared.gmst = greenwich_sidereal(timestamp);
+    shared.sin_obliquity = sin(OBLIQUITY * DEG);
+    shared.cos_obliquity = cos(OBLIQUITY * DEG);
+    
+    /* The simulation has no lunar latitude; the moon rides the ecliptic */
+    for (int s = 0; s < MOON_SCAN_SAMPLES; s++) {
+        time_t t = timestamp + (time_t)s * MOON_SCAN_STEP;
+        celestial_data_t data;
+        ephemeris_get_data_at_time(t, &data);
+        
+        double lambda = data.planets[MOON_INDEX].degree * DEG;
+        double sin_dec = shared.sin_obliquity * sin(lambda);
+        double ra = atan2(sin(lambda) * shared.cos_obliquity, cos(lambda)) / DEG;
+        
+        shared.moon_hour_base[s] = greenwich_sidereal(t) - ra;
+        shared.moon_sin_dec[s] = sin_dec;
+        shared.moon_cos_dec[s] = sqrt(1.0 - sin_dec * sin_dec);
+    }
+    
+    shared.valid = true;
+    locale_stats.timestamps_computed++;
+}
+
+/* Compute every pending location of the chunk into row[] and the cache */
+static void compute_chunk(local_sky_t *row, int count) {
+    time_t timestamp = shared.timestamp;
+    
+    for (int i = 0; i < count; i++) {
+        chunk_sin_lat[i] = sin(chunk_lat[i] * DEG);
+        chunk_cos_lat[i] = cos(chunk_lat[i] * DEG);
+        chunk_lst[i] = normalize(shared.gmst + chunk_lon[i]);
+    }
+    
+    /* Angles, houses and which house each planet occupies */
+    for (int i = 0; i < count; i++) {
+        local_sky_t *sky = &row[chunk_index[i]];
+        double theta = chunk_lst[i] * DEG;
+        double tan_lat = chunk_sin_lat[i] / chunk_cos_lat[i];
+        
+        sky->timestamp = timestamp;
+        sky->latitude = chunk_lat[i];
+        sky->longitude = chunk_lon[i];
+        sky->local_day = day_of_month(timestamp + (time_t)(chunk_lon[i] * 240.0));
+        sky->sidereal_time = chunk_lst[i];
+        sky->midheaven = normalize(atan2(sin(theta), cos(theta) * shared.cos_obliquity) / DEG);
+        sky->ascendant = normalize(atan2(cos(theta),
+                                         -(sin(theta) * shared.cos_obliquity +
+                                           tan_lat * shared.sin_obliquity)) / DEG);
+        porphyry_cusps(sky->ascendant, sky->midheaven, sky->house_cusps);
+        
+        for (int p = 0; p < shared.data.planet_count && p < EPHEMERIS_PLANET_COUNT; p++) {
+            sky->planet_house[p] = (uint8_t)house_of(shared.data.planets[p].degree, sky->house_cusps);
+        }
+        sky->moonrise = 0;
+        sky->moonset = 0;
+    }
+    
+    /* Moon altitude at each sample; rise and set are sign changes */
+    double sin_horizon = sin(MOON_HORIZON * DEG);
+    for (int s = 0; s < MOON_SCAN_SAMPLES; s++) {
+        for (int i = 0; i < count; i++) {
+            double hour_angle = (shared.moon_hour_base[s] + chunk_lon[i]) * DEG;
+            chunk_altitude[i] = chunk_sin_lat[i] * shared.moon_sin_dec[s] +
+                                chunk_cos_lat[i] * shared.moon_cos_dec[s] * cos(hour_angle) -
+                                sin_horizon;
+        }
+        
+        if (s > 0) {
+            time_t sample_start = timestamp + (time_t)(s - 1) * MOON_SCAN_STEP;
+            for (int i = 0; i < count; i++) {
+                double before = chunk_previous[i];
+                double after = chunk_altitude[i];
+                if ((before < 0.0) == (after < 0.0)) continue;
+                
+                local_sky_t *sky = &row[chunk_index[i]];
+                time_t crossing = sample_start +
+                                  (time_t)(MOON_SCAN_STEP * before / (before - after));
+                if (before < 0.0 && sky->moonrise == 0) sky->moonrise = crossing;
+                if (before >= 0.0 && sky->moonset == 0) sky->moonset = crossing;
+            }
+        }
+        
+        for (int i = 0; i < count; i++) {
+            chunk_previous[i] = chunk_altitude[i];
+        }
+    }
+    
+    for (int i = 0; i < count; i++) {
+        cache_insert(chunk_key[i], &row[chunk_index[i]]);
+    }
+}
+
+/**
+ * Geohash of a location: latitude and longitude bits interleaved
+ */
+uint64_t astral_locale_geohash(double latitude, double longitude) {
+    uint32_t lat = quantize(latitude, -90.0, 180.0);
+    uint32_t lon = quantize(longitude, -180.0, 360.0);
+    uint64_t hash = 0;
+    
+    for (int bit = LOCALE_GEOHASH_BITS - 1; bit >= 0; bit--) {
+        hash = (hash << 1) | ((lon >> bit) & 1);
+        hash = (hash << 1) | ((lat >> bit) & 1);
+    }
+    return hash;
+}
+
+/**
+ * Query many locations at many timestamps
+ *
+ * results is timestamp-major: results[t * location_count + l].
+ */
+int astral_locale_batch(const double *latitudes, const double *longitudes, int location_count,
+                        const time_t *timestamps, int timestamp_count, local_sky_t *results) {
+    if (!latitudes || !longitudes || !timestamps || !results) return -1;
+    if (location_count < 0 || timestamp_count < 0) return -1;
+    
+    for (int t = 0; t < timestamp_count; t++) {
+        local_sky_t *row = results + (size_t)t * location_count;
+        int pending = 0;
+        unsigned long flags = spin_lock(&locale_lock);
+        
+        for (int l = 0; l < location_count; l++) {
+            uint64_t key = astral_locale_geohash(latitudes[l], longitudes[l]);
+            locale_cache_entry_t *entry = cache_lookup(key, timestamps[t]);
+            
+            if (entry) {
+                memcpy(&row[l], &entry->sky, sizeof(local_sky_t));
+                locale_stats.cache_hits++;
+                continue;
+            }
+            
+            locale_stats.cache_misses++;
+            prepare_shared(timestamps[t]);
+            
+            /* Compute at the cell center so cached results do not depend on query order */
+            chunk_index[pending] = l;
+            chunk_key[pending] = key;
+            chunk_lat[pending] = cell_center(quantize(latitudes[l], -90.0, 180.0), -90.0, 180.0);
+            chunk_lon[pending] = cell_center(quantize(longitudes[l], -180.0, 360.0), -180.0, 360.0);
+            pending++;
+            
+            if (pending == LOCALE_BATCH_CHUNK) {
+                compute_chunk(row, pending);
+                pending = 0;
+            }
+        }
+        
+        if (pending > 0) {
+            compute_chunk(row, pending);
+        }
+        spin_unlock(&locale_lock, flags);
+    }
+    
+    return 0;
+}
+
+/**
+ * Query a single location
+ */
+int astral_locale_query(double latitude, double longitude, time_t timestamp, local_sky_t *sky) {
+    return astral_locale_batch(&latitude, &longitude, 1, &timestamp, 1, sky);
+}
+
+/**
+ * Drop every cached result
+ */
+void astral_locale_cache_clear(void) {
+    unsigned long flags = spin_lock(&locale_lock);
+    memset(locale_cache, 0, sizeof(locale_cache));
+    shared.valid = false;
+    spin_unlock(&locale_lock, flags);
+}
+
+/**
+ * Get cache statistics
+ */
+void astral_locale_get_stats(astral_locale_stats_t *stats) {
+    if (stats) {
+        unsigned long flags = spin_lock(&locale_lock);
+        memcpy(stats, &locale_stats, sizeof(*stats));
+        spin_unlock(&locale_lock, flags);
+    }
+}
@@ -0,0 +1,62 @@
+/**
+ * Astral Locale - The Sky Overhead
+ *
+ * Location-dependent astrology: local civil day, sidereal time,
+ * ascendant, midheaven, house cusps and moonrise/moonset. Batch queries
+ * over many locations and timestamps compute the ephemeris once per
+ * timestamp and share it across every location; results are cached
+ * under a geohash of the coordinates.
+ */
+
+#ifndef ASTRAL_LOCALE_H
+#define ASTRAL_LOCALE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ephemeris_provider.h"
+
+#define LOCALE_HOUSE_COUNT   12
+#define LOCALE_BATCH_CHUNK   256    /* Locations processed together */
+#define LOCALE_GEOHASH_BITS  20     /* Per axis; cells are about 20 m */
+
+/* Two-way result cache, power of two; userland serves many users, the kernel one caller */
+#ifndef LOCALE_CACHE_SIZE
+#ifdef USERLAND_BUILD
+#define LOCALE_CACHE_SIZE    32768
+#else
+#define LOCALE_CACHE_SIZE    256
+#endif
+#endif
+
+/* Everything about the sky at one place and instant */
+typedef struct {
+    time_t timestamp;
+    double latitude;                /* Geohash cell center actually used */
+    double longitude;
+    int local_day;                  /* Day of month in local mean solar time */
+    double sidereal_time;           /* Local sidereal time, degrees */
+    double ascendant;               /* Ecliptic degrees */
+    double midheaven;
+    double house_cusps[LOCALE_HOUSE_COUNT];    /* Porphyry houses */
+    uint8_t planet_house[EPHEMERIS_PLANET_COUNT];  /* 1-12 */
+    time_t moonrise;                /* Next event within 24 h, 0 if none */
+    time_t moonset;
+} local_sky_t;
+
+typedef struct {
+    uint64_t cache_hits;
+    uint64_t cache_misses;
+    uint64_t timestamps_computed;   /* Shared per-timestamp work */
+} astral_locale_stats_t;
+
+/* Queries */
+int astral_locale_query(double latitude, double longitude, time_t timestamp, local_sky_t *sky);
+int astral_locale_batch(const double *latitudes, const double *longitudes, int location_count,
+                        const time_t *timestamps, int timestamp_count, local_sky_t *results);
+
+/* Cache */
+uint64_t astral_locale_geohash(double latitude, double longitude);
+void astral_locale_cache_clear(void);
+void astral_locale_get_stats(astral_locale_stats_t *stats);
+
+#endif /* ASTRAL_LOCALE_H */
@@ -0,0 +1,308 @@
+/**
+ * Astral Watch - Implementation
+ *
+ * Every tick each subscription's value is recomputed once and compared
+ * with the last one seen; only differences become events. Values are
+ * computed and channels signalled outside watch_lock, which only guards
+ * the subscription table and the queues.
+ */
+
+#include "freestanding.h"
+#include "astral_watch.h"
+#include "astral_fs.h"
+#include "destiny_engine.h"
+#include "sync.h"
+
+typedef struct {
+    bool in_use;
+    uint32_t serial;                /* Tells a reused slot from the one a round saw */
+    int event_fd;
+    astral_watch_kind_t kind;
+    char path[128];
+    compiled_trigger_t compiled;
+    uint32_t value;                 /* Last value seen */
+    bool primed;                    /* value is valid */
+    
+    /* Ring of undelivered events */
+    astral_watch_event_t queue[ASTRAL_WATCH_QUEUE];
+    int head;
+    int count;
+    uint32_t dropped;
+} watch_subscription_t;
+
+/* One subscription as a dispatch round sees it, copied out of the table */
+typedef struct {
+    int id;
+    uint32_t serial;
+    int event_fd;
+    astral_watch_kind_t kind;
+    char path[128];
+    compiled_trigger_t compiled;
+    uint32_t value;
+    bool valid;                     /* value was computed */
+    bool changed;
+} watch_work_t;
+
+static watch_subscription_t subscriptions[ASTRAL_WATCH_MAX];
+static spinlock_t watch_lock = SPINLOCK_INIT;
+static uint32_t watch_serial = 0;
+static astral_watch_stats_t watch_stats;
+
+/* Dispatch runs on one thread (the publish worker), so one work list serves */
+static watch_work_t watch_work[ASTRAL_WATCH_MAX];
+
+static uint32_t content_hash(const char *data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/* Current contents hash of a watched file, -1 if it cannot be read */
+static int watch_path_value(const char *path, uint32_t *value) {
+    astral_fs_view_t view;
+    do {
+        if (astral_fs_view_file(path, &view) != 0) return -1;
+        /* The size covers changes past the cached head of large files */
+        *value = content_hash(view.data, view.length) ^ (uint32_t)view.size;
+    } while (!astral_fs_view_valid(&view));
+    return 0;
+}
+
+/*
+ * Evaluate a watched expression, computing the catalog bodies it needs
+ * first. Aspects are looked up pair by pair rather than through a
+ * snapshot, which belongs to the trigger tick.
+ */
+static uint32_t watch_expression_value(const compiled_trigger_t *compiled, celestial_data_t *data) {
+    body_subset_t bodies;
+    body_subset_clear(&bodies);
+    destiny_engine_trigger_bodies(compiled, &bodies);
+    
+    if (bodies.count > 0) {
+        body_catalog_compute(data->timestamp, &bodies);
+    }
+    return destiny_engine_evaluate_compiled(compiled, data) ? 1 : 0;
+}
+
+static void watch_enqueue(watch_subscription_t *sub, int id, uint32_t tick, time_t timestamp) {
+    if (sub->count == ASTRAL_WATCH_QUEUE) {
+        /* Keep the newest; the consumer learns how many it missed */
+        sub->head = (sub->head + 1) % ASTRAL_WATCH_QUEUE;
+        sub->count--;
+        sub->dropped++;
+        watch_stats.dropped++;
+    }
+    
+    astral_watch_event_t *event = &sub->queue[(sub->head + sub->count) % ASTRAL_WATCH_QUEUE];
+    event->subscription = id;
+    event->tick = tick;
+    event->timestamp = timestamp;
+    event->value = sub->value;
+    event->dropped = sub->dropped;
+    sub->dropped = 0;
+    sub->count++;
+    watch_stats.events++;
+}
+
+/* Wake a channel once per tick with the number of changed subscriptions */
+static void watch_signal(int event_fd, uint64_t changes) {
+#ifdef USERLAND_BUILD
+    /* 8 bytes is what an eventfd expects and a pipe reader can frame */
+    if (event_fd >= 0 && write(event_fd, &changes, sizeof(changes)) < 0) {
+        fprintf(stderr, "[ASTRAL WATCH] Cannot signal fd %d\n", event_fd);
+    }
+#else
+    (void)event_fd;
+    (void)changes;
+#endif
+}
+
+/**
+ * Subscribe to changes of an /astral path or a trigger expression
+ *
+ * Returns the subscription id. The current value is taken as the
+ * baseline, so the first event marks a real change.
+ */
+int astral_watch_subscribe(int event_fd, const char *filter) {
+    if (!filter) return -1;
+    
+    watch_subscription_t candidate;
+    memset(&candidate, 0, sizeof(candidate));
+    candidate.in_use = true;
+    candidate.event_fd = event_fd;
+    
+    if (filter[0] == '/') {
+        candidate.kind = ASTRAL_WATCH_PATH;
+        strncpy(candidate.path, filter, sizeof(candidate.path) - 1);
+        if (watch_path_value(candidate.path, &candidate.value) != 0) {
+            fprintf(stderr, "[ASTRAL WATCH] No such astral file: %s\n", filter);
+            return -1;
+        }
+        candidate.primed = true;
+    } else {
+        candidate.kind = ASTRAL_WATCH_EXPRESSION;
+        if (destiny_engine_compile_trigger(filter, &candidate.compiled) != 0) {
+            fprintf(stderr, "[ASTRAL WATCH] Cannot compile filter: %s\n", filter);
+            return -1;
+        }
+        
+        /* Baseline against the published state, if there is one yet */
+        astral_fs_view_t view;
+        celestial_data_t data;
+        if (astral_fs_view_state(&view) == 0) {
+            do {
+                memcpy(&data, view.state, sizeof(data));
+            } while (!astral_fs_view_valid(&view));
+            if (data.timestamp != 0) {
+                candidate.value = watch_expression_value(&candidate.compiled, &data);
+                candidate.primed = true;
+            }
+        }
+    }
+    
+    unsigned long flags = spin_lock(&watch_lock);
+    int id = -1;
+    for (int i = 0; i < ASTRAL_WATCH_MAX; i++) {
+        if (!subscriptions[i].in_use) {
+            id = i;
+            candidate.serial = ++watch_serial;
+            memcpy(&subscriptions[i], &candidate, sizeof(candidate));
+            watch_stats.subscriptions++;
+            break;
+        }
+    }
+    spin_unlock(&watch_lock, flags);
+    
+    if (id < 0) {
+        fprintf(stderr, "[ASTRAL WATCH] Subscription table full\n");
+    }
+    return id;
+}
+
+/**
+ * Remove a subscription and discard its queued events
+ */
+int astral_watch_unsubscribe(int subscription) {
+    if (subscription < 0 || subscription >= ASTRAL_WATCH_MAX) return -1;
+    
+    unsigned long flags = spin_lock(&watch_lock);
+    int result = -1;
+    if (subscriptions[subscription].in_use) {
+        subscriptions[subscription].in_use = false;
+        watch_stats.subscriptions--;
+        result = 0;
+    }
+    spin_unlock(&watch_lock, flags);
+    return result;
+}
+
+/**
+ * Detect changes for every subscription and deliver them as one batch
+ *
+ * Returns the number of subscriptions that changed this tick.
+ */
+int astral_watch_dispatch(celestial_data_t *data) {
+    if (!data) return -1;
+    
+    /* Copy the subscriptions out, then render and evaluate unlocked */
+    unsigned long flags = spin_lock(&watch_lock);
+    uint32_t tick = ++watch_stats.ticks;
+    int count = 0;
+    for (int i = 0; i < ASTRAL_WATCH_MAX; i++) {
+        watch_subscription_t *sub = &subscriptions[i];
+        if (!sub->in_use) continue;
+        
+        watch_work_t *work = &watch_work[count++];
+        work->id = i;
+        work->serial = sub->serial;
+        work->event_fd = sub->event_fd;
+        work->kind = sub->kind;
+        memcpy(work->path, sub->path, sizeof(work->path));
+        memcpy(&work->compiled, &sub->compiled, sizeof(work->compiled));
+    }
+    spin_unlock(&watch_lock, flags);
+    
+    for (int i = 0; i < count; i++) {
+        watch_work_t *work = &watch_work[i];
+        work->changed = false;
+        if (work->kind == ASTRAL_WATCH_PATH) {
+            work->valid = watch_path_value(work->path, &work->value) == 0;
+        } else {
+            work->value = watch_expression_value(&work->compiled, data);
+            work->valid = true;
+        }
+    }
+    
+    /* Subscriptions removed or replaced meanwhile are skipped */
+    int changed = 0;
+    flags = spin_lock(&watch_lock);
+    for (int i = 0; i < count; i++) {
+        watch_work_t *work = &watch_work[i];
+        watch_subscription_t *sub = &subscriptions[work->id];
+        if (!work->valid || !sub->in_use || sub->serial != work->serial) continue;
+        
+        work->changed = sub->primed && work->value != sub->value;
+        sub->value = work->value;
+        sub->primed = true;
+        if (work->changed) {
+            watch_enqueue(sub, work->id, tick, data->timestamp);
+            changed++;
+        }
+    }
+    spin_unlock(&watch_lock, flags);
+    
+    /* One wakeup per channel, however many of its subscriptions changed */
+    for (int i = 0; i < count; i++) {
+        if (!watch_work[i].changed) continue;
+        
+        int event_fd = watch_work[i].event_fd;
+        uint64_t changes = 0;
+        for (int j = i; j < count; j++) {
+            if (watch_work[j].changed && watch_work[j].event_fd == event_fd) {
+                watch_work[j].changed = false;
+                changes++;
+            }
+        }
+        watch_signal(event_fd, changes);
+    }
+    
+    return changed;
+}
+
+/**
+ * Drain queued events for every subscription on a channel
+ *
+ * Returns the number of events copied, oldest first per subscription.
+ */
+int astral_watch_read(int event_fd, astral_watch_event_t *events, int max_events) {
+    if (!events || max_events <= 0) return -1;
+    
+    unsigned long flags = spin_lock(&watch_lock);
+    int count = 0;
+    for (int i = 0; i < ASTRAL_WATCH_MAX && count < max_events; i++) {
+        watch_subscription_t *sub = &subscriptions[i];
+        if (!sub->in_use || sub->event_fd != event_fd) continue;
+        
+        while (sub->count > 0 && count < max_events) {
+            events[count++] = sub->queue[sub->head];
+            sub->head = (sub->head + 1) % ASTRAL_WATCH_QUEUE;
+            sub->count--;
+        }
+    }
+    spin_unlock(&watch_lock, flags);
+    return count;
+}
+
+/**
+ * Get dispatch statistics
+ */
+void astral_watch_get_stats(astral_watch_stats_t *stats) {
+    if (!stats) return;
+    
+    unsigned long flags = spin_lock(&watch_lock);
+    *stats = watch_stats;
+    spin_unlock(&watch_lock, flags);
+}
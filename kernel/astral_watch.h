@@ -0,0 +1,53 @@
+/**
+ * Astral Watch - Listening to the Sky
+ *
+ * Change notification for /astral files and trigger expressions. A
+ * consumer subscribes a filter on an event channel and is told only when
+ * the value behind it changes. Changes are collected once per tick and
+ * delivered as one batch: in userland the channel is an eventfd or pipe
+ * that receives a 64-bit count, in the kernel it is just a queue key.
+ */
+
+#ifndef ASTRAL_WATCH_H
+#define ASTRAL_WATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ephemeris_provider.h"
+
+#define ASTRAL_WATCH_MAX    64      /* Live subscriptions */
+#define ASTRAL_WATCH_QUEUE  16      /* Undelivered events per subscription */
+
+typedef enum {
+    ASTRAL_WATCH_PATH = 0,          /* "/astral/moon_phase": contents changed */
+    ASTRAL_WATCH_EXPRESSION         /* 'moon == "Full"': result flipped */
+} astral_watch_kind_t;
+
+typedef struct {
+    int subscription;
+    uint32_t tick;                  /* Dispatch round that saw the change */
+    time_t timestamp;               /* Celestial state timestamp */
+    uint32_t value;                 /* Content hash, or 1/0 for expressions */
+    uint32_t dropped;               /* Events lost to a full queue before this one */
+} astral_watch_event_t;
+
+typedef struct {
+    uint32_t ticks;
+    uint64_t events;
+    uint64_t dropped;
+    int subscriptions;
+} astral_watch_stats_t;
+
+/* Subscriptions; event_fd is the eventfd/pipe to signal, or a kernel channel */
+int astral_watch_subscribe(int event_fd, const char *filter);
+int astral_watch_unsubscribe(int subscription);
+
+/* Once per tick, after astral_fs_update_state(); from one thread at a time */
+int astral_watch_dispatch(celestial_data_t *data);
+
+/* Drain queued events for every subscription on a channel */
+int astral_watch_read(int event_fd, astral_watch_event_t *events, int max_events);
+
+void astral_watch_get_stats(astral_watch_stats_t *stats);
+
+#endif /* ASTRAL_WATCH_H */
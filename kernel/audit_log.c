@@ -0,0 +1,595 @@
+/**
+ * Audit Log - Implementation
+ *
+ * Segment payload, after the header:
+ *
+ *   names       name_count x (uint8 length, bytes)
+ *   tick        varint delta from the previous tick (first_tick to start)
+ *   timestamp   zigzag varint delta from the previous timestamp
+ *   trigger     varint index into names
+ *   priority    zigzag varint
+ *   mode        runs of (uint8 mode, varint length)
+ *   latency     varint microseconds
+ *   exit        zigzag varint
+ *
+ * Every column holds record_count values.
+ */
+
+#include "freestanding.h"
+#include "audit_log.h"
+#include "astral_format.h"
+#include "sync.h"
+
+#ifdef USERLAND_BUILD
+#define AUDIT_INDEX_MAX     65536   /* The file keeps everything; this is what a query sees */
+#else
+#define AUDIT_INDEX_MAX     256
+#endif
+#define AUDIT_ARENA_BYTES   (512 * 1024)
+#define AUDIT_SEGMENT_MAX   (64 * 1024)     /* Worst case is about 49 KB */
+
+/* One segment's columns, raw; the open segment and decoded ones alike */
+typedef struct {
+    int count;
+    uint32_t first_seq;
+    int name_count;
+    char names[AUDIT_SEGMENT_NAMES][64];
+    uint64_t tick[AUDIT_SEGMENT_RECORDS];
+    int64_t timestamp[AUDIT_SEGMENT_RECORDS];
+    uint8_t name[AUDIT_SEGMENT_RECORDS];
+    int32_t priority[AUDIT_SEGMENT_RECORDS];
+    uint8_t mode[AUDIT_SEGMENT_RECORDS];
+    uint32_t latency[AUDIT_SEGMENT_RECORDS];
+    int32_t exit_status[AUDIT_SEGMENT_RECORDS];
+} audit_columns_t;
+
+/* Where a sealed segment is and what it could contain */
+typedef struct {
+    uint64_t offset;                /* In the arena, or in the file */
+    uint32_t size;                  /* Header and payload */
+    uint32_t first_seq;
+    uint32_t count;
+    int64_t first;
+    int64_t last;
+    uint64_t name_bloom;            /* Bit (name hash % 64) per trigger */
+    bool in_file;                   /* Otherwise in the arena */
+} audit_index_t;
+
+static audit_record_t batch[AUDIT_BATCH_MAX];
+static int batch_count = 0;
+static audit_columns_t open_columns;
+static audit_columns_t scan_columns;
+static audit_index_t segment_index[AUDIT_INDEX_MAX];
+static int index_count = 0;
+static uint8_t segment_buffer[AUDIT_SEGMENT_MAX];
+static uint8_t arena[AUDIT_ARENA_BYTES];
+static uint32_t arena_used = 0;
+static uint32_t next_seq = 1;
+static audit_log_stats_t audit_stats;
+static spinlock_t audit_lock = SPINLOCK_INIT;
+
+#ifdef USERLAND_BUILD
+static char log_path[256];
+static bool index_loaded = true;    /* No file: nothing to load */
+#endif
+
+static uint32_t name_hash(const char *name) {
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint64_t name_bit(const char *name) {
+    return 1ULL << (name_hash(name) & 63);
+}
+
+static void put_varint(uint8_t *data, uint32_t *pos, uint64_t value) {
+    while (value >= 0x80) {
+        data[(*pos)++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    data[(*pos)++] = (uint8_t)value;
+}
+
+static bool get_varint(const uint8_t *data, uint32_t *pos, uint32_t end, uint64_t *value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*pos >= end) return false;
+        uint8_t byte = data[(*pos)++];
+        *value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+static uint64_t zigzag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t unzigzag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/* Encode a segment into segment_buffer; returns its total size */
+static uint32_t audit_encode(const audit_columns_t *columns) {
+    audit_segment_header_t header;
+    uint8_t *data = segment_buffer;
+    uint32_t pos = sizeof(header);
+    int n = columns->count;
+    
+    for (int i = 0; i < columns->name_count; i++) {
+        size_t length = strlen(columns->names[i]);
+        data[pos++] = (uint8_t)length;
+        memcpy(data + pos, columns->names[i], length);
+        pos += (uint32_t)length;
+    }
+    
+    uint64_t tick = columns->tick[0];
+    for (int i = 0; i < n; i++) {
+        put_varint(data, &pos, columns->tick[i] - tick);
+        tick = columns->tick[i];
+    }
+    int64_t timestamp = columns->timestamp[0];
+    for (int i = 0; i < n; i++) {
+        put_varint(data, &pos, zigzag(columns->timestamp[i] - timestamp));
+        timestamp = columns->timestamp[i];
+    }
+    for (int i = 0; i < n; i++) {
+        put_varint(data, &pos, columns->name[i]);
+    }
+    for (int i = 0; i < n; i++) {
+        put_varint(data, &pos, zigzag(columns->priority[i]));
+    }
+    for (int i = 0; i < n; ) {
+        int run = 1;
+        while (i + run < n && columns->mode[i + run] == columns->mode[i]) run++;
+        data[pos++] = columns->mode[i];
+        put_varint(data, &pos, (uint64_t)run);
+        i += run;
+    }
+    for (int i = 0; i < n; i++) {
+        put_varint(data, &pos, columns->latency[i]);
+    }
+    for (int i = 0; i < n; i++) {
+        put_varint(data, &pos, zigzag(columns->exit_status[i]));
+    }
+    
+    header.magic = AUDIT_SEGMENT_MAGIC;
+    header.version = AUDIT_SEGMENT_VERSION;
+    header.name_count = (uint16_t)columns->name_count;
+    header.record_count = (uint32_t)n;
+    header.payload_size = pos - (uint32_t)sizeof(header);
+    header.checksum = astral_format_crc32(data + sizeof(header), header.payload_size);
+    header.first_timestamp = columns->timestamp[0];
+    header.last_timestamp = columns->timestamp[n - 1];
+    header.first_tick = columns->tick[0];
+    memcpy(data, &header, sizeof(header));
+    return pos;
+}
+
+/* Decode a whole segment image; -1 if it is damaged */
+static int audit_decode(const uint8_t *data, uint32_t size, audit_columns_t *columns) {
+    audit_segment_header_t header;
+    if (size < sizeof(header)) return -1;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != AUDIT_SEGMENT_MAGIC || header.version != AUDIT_SEGMENT_VERSION ||
+        header.record_count == 0 || header.record_count > AUDIT_SEGMENT_RECORDS ||
+        header.name_count > AUDIT_SEGMENT_NAMES ||
+        header.payload_size != size - sizeof(header) ||
+        astral_format_crc32(data + sizeof(header), header.payload_size) != header.checksum) {
+        return -1;
+    }
+    
+    uint32_t pos = sizeof(header);
+    int n = (int)header.record_count;
+    uint64_t value;
+    columns->count = n;
+    columns->name_count = header.name_count;
+    
+    for (int i = 0; i < columns->name_count; i++) {
+        if (pos >= size) return -1;
+        uint8_t length = data[pos++];
+        if (length >= sizeof(columns->names[i]) || pos + length > size) return -1;
+        memcpy(columns->names[i], data + pos, length);
+        columns->names[i][length] = '\0';
+        pos += length;
+    }
+    
+    uint64_t tick = header.first_tick;
+    for (int i = 0; i < n; i++) {
+        if (!get_varint(data, &pos, size, &value)) return -1;
+        tick += value;
+        columns->tick[i] = tick;
+    }
+    int64_t timestamp = header.first_timestamp;
+    for (int i = 0; i < n; i++) {
+        if (!get_varint(data, &pos, size, &value)) return -1;
+        timestamp += unzigzag(value);
+        columns->timestamp[i] = timestamp;
+    }
+    for (int i = 0; i < n; i++) {
+        if (!get_varint(data, &pos, size, &value) || value >= (uint64_t)columns->name_count) return -1;
+        columns->name[i] = (uint8_t)value;
+    }
+    for (int i = 0; i < n; i++) {
+        if (!get_varint(data, &pos, size, &value)) return -1;
+        columns->priority[i] = (int32_t)unzigzag(value);
+    }
+    for (int i = 0; i < n; ) {
+        if (pos >= size) return -1;
+        uint8_t mode = data[pos++];
+        if (!get_varint(data, &pos, size, &value) || value == 0 || value > (uint64_t)(n - i)) return -1;
+        for (uint32_t r = 0; r < (uint32_t)value; r++) {
+            columns->mode[i++] = mode;
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        if (!get_varint(data, &pos, size, &value)) return -1;
+        columns->latency[i] = (uint32_t)value;
+    }
+    for (int i = 0; i < n; i++) {
+        if (!get_varint(data, &pos, size, &value)) return -1;
+        columns->exit_status[i] = (int32_t)unzigzag(value);
+    }
+    return 0;
+}
+
+static void audit_index_drop_oldest(void) {
+    audit_stats.dropped += segment_index[0].count;
+    audit_stats.records -= segment_index[0].count;
+    audit_stats.bytes -= segment_index[0].size;
+    audit_stats.segments--;
+    memmove(&segment_index[0], &segment_index[1], (size_t)(index_count - 1) * sizeof(segment_index[0]));
+    index_count--;
+}
+
+static void audit_index_add(const audit_columns_t *columns, uint64_t offset, uint32_t size, bool in_file) {
+    if (index_count == AUDIT_INDEX_MAX) {
+        fprintf(stderr, "[AUDIT] Segment index full; oldest segment no longer queried\n");
+        audit_index_drop_oldest();
+    }
+    
+    audit_index_t *entry = &segment_index[index_count++];
+    entry->offset = offset;
+    entry->size = size;
+    entry->first_seq = columns->first_seq;
+    entry->count = (uint32_t)columns->count;
+    entry->first = columns->timestamp[0];
+    entry->last = columns->timestamp[0];
+    entry->name_bloom = 0;
+    entry->in_file = in_file;
+    for (int i = 0; i < columns->count; i++) {
+        if (columns->timestamp[i] < entry->first) entry->first = columns->timestamp[i];
+        if (columns->timestamp[i] > entry->last) entry->last = columns->timestamp[i];
+    }
+    for (int i = 0; i < columns->name_count; i++) {
+        entry->name_bloom |= name_bit(columns->names[i]);
+    }
+    
+    audit_stats.records += entry->count;
+    audit_stats.bytes += size;
+    audit_stats.segments++;
+}
+
+#ifdef USERLAND_BUILD
+/* Rebuild the index from the segment headers and names in the file */
+static void audit_index_load(void) {
+    if (index_loaded) return;
+    index_loaded = true;
+    
+    FILE *file = fopen(log_path, "rb");
+    if (!file) return;
+    
+    audit_segment_header_t header;
+    uint64_t offset = 0;
+    while (fread(&header, sizeof(header), 1, file) == 1) {
+        uint32_t size = (uint32_t)sizeof(header) + header.payload_size;
+        if (header.magic != AUDIT_SEGMENT_MAGIC || size > AUDIT_SEGMENT_MAX ||
+            fread(segment_buffer + sizeof(header), 1, header.payload_size, file) != header.payload_size) {
+            fprintf(stderr, "[AUDIT] Ignoring damaged tail of %s\n", log_path);
+            break;
+        }
+        memcpy(segment_buffer, &header, sizeof(header));
+        if (audit_decode(segment_buffer, size, &scan_columns) == 0) {
+            scan_columns.first_seq = next_seq;
+            audit_index_add(&scan_columns, offset, size, true);
+        }
+        next_seq += header.record_count;
+        offset += size;
+    }
+    fclose(file);
+}
+#endif
+
+/* Move the open segment to the arena or the file */
+static void audit_seal(void) {
+    if (open_columns.count == 0) return;
+    uint32_t size = audit_encode(&open_columns);
+
+#ifdef USERLAND_BUILD
+    if (log_path[0]) {
+        FILE *file = fopen(log_path, "ab");
+        if (file) {
+            fseek(file, 0, SEEK_END);
+            long offset = ftell(file);
+            bool written = fwrite(segment_buffer, 1, size, file) == size;
+            if (fclose(file) == 0 && written && offset >= 0) {
+                audit_index_add(&open_columns, (uint64_t)offset, size, true);
+                open_columns.count = 0;
+                open_columns.name_count = 0;
+                return;
+            }
+        }
+        fprintf(stderr, "[AUDIT] Cannot append to %s; keeping the segment in memory\n", log_path);
+    }
+#endif
+
+    /* The arena keeps the newest segments that fit */
+    while (index_count > 0 && !segment_index[0].in_file &&
+           (arena_used + size > AUDIT_ARENA_BYTES || index_count == AUDIT_INDEX_MAX)) {
+        uint32_t drop = segment_index[0].size;
+        memmove(arena, arena + drop, arena_used - drop);
+        arena_used -= drop;
+        audit_index_drop_oldest();
+        for (int i = 0; i < index_count; i++) {
+            if (!segment_index[i].in_file) segment_index[i].offset -= drop;
+        }
+    }
+    if (arena_used + size > AUDIT_ARENA_BYTES) {
+        fprintf(stderr, "[AUDIT] Arena full; dropping %d records\n", open_columns.count);
+        audit_stats.dropped += (uint64_t)open_columns.count;
+        open_columns.count = 0;
+        open_columns.name_count = 0;
+        return;
+    }
+    memcpy(arena + arena_used, segment_buffer, size);
+    audit_index_add(&open_columns, arena_used, size, false);
+    arena_used += size;
+    open_columns.count = 0;
+    open_columns.name_count = 0;
+}
+
+static int audit_name_index(const char *trigger) {
+    for (int i = 0; i < open_columns.name_count; i++) {
+        if (strcmp(open_columns.names[i], trigger) == 0) return i;
+    }
+    return -1;
+}
+
+/* Fetch a sealed segment's image; NULL if it cannot be read */
+static const uint8_t *audit_segment_image(const audit_index_t *entry) {
+#ifdef USERLAND_BUILD
+    if (entry->in_file) {
+        FILE *file = fopen(log_path, "rb");
+        if (!file) return NULL;
+        bool ok = fseek(file, (long)entry->offset, SEEK_SET) == 0 &&
+                  fread(segment_buffer, 1, entry->size, file) == entry->size;
+        fclose(file);
+        return ok ? segment_buffer : NULL;
+    }
+#endif
+    return arena + entry->offset;
+}
+
+/* Copy matching records of one segment; returns false once records is full */
+static bool audit_collect(const audit_columns_t *columns, time_t from, time_t to, const char *trigger,
+                          uint32_t *cursor, audit_record_t *records, int max_records, int *count) {
+    int wanted = -1;
+    if (trigger) {
+        for (int i = 0; i < columns->name_count; i++) {
+            if (strcmp(columns->names[i], trigger) == 0) wanted = i;
+        }
+        if (wanted < 0) return true;
+    }
+    
+    for (int i = 0; i < columns->count; i++) {
+        uint32_t seq = columns->first_seq + (uint32_t)i;
+        if (seq < *cursor) continue;
+        if (columns->timestamp[i] < (int64_t)from || columns->timestamp[i] > (int64_t)to) continue;
+        if (wanted >= 0 && columns->name[i] != wanted) continue;
+        
+        audit_record_t *record = &records[(*count)++];
+        record->seq = seq;
+        record->tick = columns->tick[i];
+        record->timestamp = (time_t)columns->timestamp[i];
+        strncpy(record->trigger, columns->names[columns->name[i]], sizeof(record->trigger) - 1);
+        record->trigger[sizeof(record->trigger) - 1] = '\0';
+        record->priority = columns->priority[i];
+        record->mode = columns->mode[i];
+        record->spawn_latency_us = columns->latency[i];
+        record->exit_status = columns->exit_status[i];
+        
+        if (*count == max_records) {
+            *cursor = seq + 1;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Initialize the audit log, forgetting anything held in memory
+ */
+int audit_log_init(void) {
+    unsigned long flags = spin_lock(&audit_lock);
+    batch_count = 0;
+    open_columns.count = 0;
+    open_columns.name_count = 0;
+    index_count = 0;
+    arena_used = 0;
+    next_seq = 1;
+    memset(&audit_stats, 0, sizeof(audit_stats));
+#ifdef USERLAND_BUILD
+    log_path[0] = '\0';
+    index_loaded = true;
+#endif
+    spin_unlock(&audit_lock, flags);
+    return 0;
+}
+
+/**
+ * Append sealed segments to a file (userland only)
+ *
+ * Existing segments in the file are indexed on first use, so queries
+ * see the whole history and new records continue its sequence.
+ */
+int audit_log_set_path(const char *path) {
+#ifdef USERLAND_BUILD
+    audit_log_sync();
+    audit_log_init();
+    
+    unsigned long flags = spin_lock(&audit_lock);
+    if (path) {
+        strncpy(log_path, path, sizeof(log_path) - 1);
+        log_path[sizeof(log_path) - 1] = '\0';
+        index_loaded = false;
+    }
+    spin_unlock(&audit_lock, flags);
+    return 0;
+#else
+    (void)path;
+    return -1;
+#endif
+}
+
+/**
+ * Add an awakening to this tick's batch
+ */
+int audit_log_record(const audit_record_t *record) {
+    if (!record) return -1;
+    
+    /* Flushing takes the lock itself; recheck, another writer may refill */
+    unsigned long flags = spin_lock(&audit_lock);
+    while (batch_count == AUDIT_BATCH_MAX) {
+        spin_unlock(&audit_lock, flags);
+        audit_log_flush();
+        flags = spin_lock(&audit_lock);
+    }
+    batch[batch_count++] = *record;
+    spin_unlock(&audit_lock, flags);
+    return 0;
+}
+
+/**
+ * Move this tick's batch into the open segment
+ *
+ * Returns the number of records flushed. A full segment is sealed.
+ */
+int audit_log_flush(void) {
+    unsigned long flags = spin_lock(&audit_lock);
+#ifdef USERLAND_BUILD
+    audit_index_load();
+#endif
+
+    int flushed = batch_count;
+    for (int b = 0; b < batch_count; b++) {
+        const audit_record_t *record = &batch[b];
+        int name = audit_name_index(record->trigger);
+        if (open_columns.count == AUDIT_SEGMENT_RECORDS ||
+            (name < 0 && open_columns.name_count == AUDIT_SEGMENT_NAMES)) {
+            audit_seal();
+            name = -1;
+        }
+        if (name < 0) {
+            name = open_columns.name_count++;
+            strncpy(open_columns.names[name], record->trigger, sizeof(open_columns.names[name]) - 1);
+            open_columns.names[name][sizeof(open_columns.names[name]) - 1] = '\0';
+        }
+        
+        int i = open_columns.count++;
+        if (i == 0) open_columns.first_seq = next_seq;
+        next_seq++;
+        open_columns.tick[i] = record->tick;
+        open_columns.timestamp[i] = (int64_t)record->timestamp;
+        open_columns.name[i] = (uint8_t)name;
+        open_columns.priority[i] = record->priority;
+        open_columns.mode[i] = record->mode;
+        open_columns.latency[i] = record->spawn_latency_us;
+        open_columns.exit_status[i] = record->exit_status;
+    }
+    batch_count = 0;
+    
+    if (open_columns.count == AUDIT_SEGMENT_RECORDS) {
+        audit_seal();
+    }
+    spin_unlock(&audit_lock, flags);
+    return flushed;
+}
+
+/**
+ * Seal the open segment, even if it is not full
+ */
+int audit_log_sync(void) {
+    audit_log_flush();
+    
+    unsigned long flags = spin_lock(&audit_lock);
+    audit_seal();
+    spin_unlock(&audit_lock, flags);
+    return 0;
+}
+
+/**
+ * Query records by time and trigger
+ *
+ * Only segments whose time span overlaps [from, to] and whose names
+ * may include the trigger are read and decoded. Returns the number of
+ * records written.
+ */
+int audit_log_query(time_t from, time_t to, const char *trigger, uint32_t *cursor,
+                    audit_record_t *records, int max_records) {
+    if (!cursor || !records || max_records <= 0) return -1;
+    
+    unsigned long flags = spin_lock(&audit_lock);
+#ifdef USERLAND_BUILD
+    audit_index_load();
+#endif
+
+    int count = 0;
+    bool more = true;
+    uint64_t bit = trigger ? name_bit(trigger) : 0;
+    audit_stats.scanned = 0;
+    
+    for (int s = 0; s < index_count && more; s++) {
+        const audit_index_t *entry = &segment_index[s];
+        if (entry->first_seq + entry->count <= *cursor) continue;
+        if (entry->last < (int64_t)from || entry->first > (int64_t)to) continue;
+        if (trigger && !(entry->name_bloom & bit)) continue;
+        
+        const uint8_t *image = audit_segment_image(entry);
+        if (!image || audit_decode(image, entry->size, &scan_columns) != 0) {
+            fprintf(stderr, "[AUDIT] Damaged segment at %lu\n", (unsigned long)entry->offset);
+            continue;
+        }
+        scan_columns.first_seq = entry->first_seq;
+        audit_stats.scanned++;
+        more = audit_collect(&scan_columns, from, to, trigger, cursor, records, max_records, &count);
+    }
+    
+    if (more) {
+        more = audit_collect(&open_columns, from, to, trigger, cursor, records, max_records, &count);
+    }
+    if (more) {
+        *cursor = next_seq;
+    }
+    
+    spin_unlock(&audit_lock, flags);
+    return count;
+}
+
+/**
+ * Get audit log statistics
+ */
+void audit_log_get_stats(audit_log_stats_t *stats) {
+    if (!stats) return;
+    
+    unsigned long flags = spin_lock(&audit_lock);
+#ifdef USERLAND_BUILD
+    audit_index_load();
+#endif
+    *stats = audit_stats;
+    stats->records += (uint64_t)open_columns.count;
+    spin_unlock(&audit_lock, flags);
+}
@@ -0,0 +1,86 @@
+/**
+ * Audit Log - The Book of Awakenings
+ *
+ * Append-only record of every ritual awakening. Records are batched per
+ * tick and packed into columnar segments: each column is delta-, varint-
+ * or run-length coded, and trigger names are a per-segment dictionary.
+ * An index of each segment's time span and trigger names lets a query
+ * skip every segment that cannot match. In userland the sealed segments
+ * are appended to a file; in the kernel they live in a memory arena.
+ */
+
+#ifndef AUDIT_LOG_H
+#define AUDIT_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "ephemeris_provider.h"
+
+#define AUDIT_SEGMENT_RECORDS   1024    /* Records per sealed segment */
+#define AUDIT_SEGMENT_NAMES     128     /* Distinct triggers per segment */
+#define AUDIT_BATCH_MAX         128     /* Awakenings per tick */
+#define AUDIT_SEGMENT_MAGIC     0x53445541u     /* "AUDS" */
+#define AUDIT_SEGMENT_VERSION   1
+
+/*
+ * The destiny engine does not spawn ritual handlers yet, so every record
+ * has spawn_latency_us 0 and exit_status AUDIT_NOT_SPAWNED; the columns
+ * are kept so the format need not change once it does.
+ */
+#define AUDIT_NOT_SPAWNED       (-1)    /* exit_status of a ritual with no handler run */
+
+typedef struct {
+    uint32_t seq;                   /* Position in the log, set when flushed */
+    uint64_t tick;
+    time_t timestamp;
+    char trigger[64];
+    int32_t priority;
+    uint8_t mode;                   /* execution_mode_t */
+    uint32_t spawn_latency_us;      /* 0 while no handler is spawned */
+    int32_t exit_status;            /* AUDIT_NOT_SPAWNED while no handler is spawned */
+} audit_record_t;
+
+/* On-disk segment header; the payload follows */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t name_count;
+    uint32_t record_count;
+    uint32_t payload_size;
+    uint32_t checksum;              /* CRC-32 of the payload */
+    int64_t first_timestamp;
+    int64_t last_timestamp;
+    uint64_t first_tick;
+} audit_segment_header_t;
+
+typedef struct {
+    uint64_t records;
+    uint64_t bytes;                 /* Sealed segment bytes */
+    uint64_t dropped;               /* Records evicted from the kernel arena */
+    int segments;
+    int scanned;                    /* Segments decoded by the last query */
+} audit_log_stats_t;
+
+int audit_log_init(void);
+
+/* Userland: append sealed segments to this file; NULL keeps them in memory */
+int audit_log_set_path(const char *path);
+
+/* Writer: record during a tick, flush once at its end */
+int audit_log_record(const audit_record_t *record);
+int audit_log_flush(void);
+
+/* Seal the open segment now, e.g. before exit */
+int audit_log_sync(void);
+
+/*
+ * Records with from <= timestamp <= to, optionally for one trigger,
+ * oldest first. Start with *cursor = 0 and call until it returns 0.
+ */
+int audit_log_query(time_t from, time_t to, const char *trigger, uint32_t *cursor,
+                    audit_record_t *records, int max_records);
+
+void audit_log_get_stats(audit_log_stats_t *stats);
+
+#endif /* AUDIT_LOG_H */
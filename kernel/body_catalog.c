@@ -0,0 +1,534 @@
+/**
+ * Body Catalog - Implementation
+ *
+ * Names, kinds and orbital elements live in parallel arrays, and so do
+ * the computed longitudes. A validity bitmap per timestamp lets
+ * queries that only mention Mars skip the other few thousand bodies.
+ */
+
+#include "freestanding.h"
+#include "body_catalog.h"
+#include "sync.h"
+
+#ifdef USERLAND_BUILD
+#include <pthread.h>
+#endif
+
+#define NAME_HASH_SIZE (BODY_CATALOG_MAX * 2)
+#define MAX_WORKERS    8
+
+static const char* BODY_KIND_NAMES[] = {
+    "planet", "asteroid", "node", "point", "star"
+};
+
+/* Built-in bodies beyond the ten ephemeris planets */
+static const struct {
+    const char *name;
+    body_kind_t kind;
+    double period_days;     /* Negative = retrograde, 0 = fixed */
+    double epoch_degree;    /* Longitude at 1970-01-01 00:00 UTC */
+} BUILTIN_BODIES[] = {
+    {"North Node",  BODY_NODE,     -6798.38, 345.27},   /* Mean node */
+    {"South Node",  BODY_NODE,     -6798.38, 165.27},
+    {"Lilith",      BODY_POINT,    3232.6,   302.68},   /* Mean lunar apogee */
+    {"Chiron",      BODY_ASTEROID, 18416.0,  5.0}
+};
+
+static int catalog_count = 0;
+static bool catalog_ready = false;
+
+/* Structure-of-arrays body elements */
+static char body_names[BODY_CATALOG_MAX][BODY_NAME_MAX];
+static uint8_t body_kinds[BODY_CATALOG_MAX];
+static double body_periods[BODY_CATALOG_MAX];
+static double body_epochs[BODY_CATALOG_MAX];
+
+/* Name -> index + 1 (0 = empty slot) */
+static uint16_t name_index[NAME_HASH_SIZE];
+
+/*
+ * Structure-of-arrays positions for positions_time, shared by every
+ * caller; positions_lock guards them along with the elements and name
+ * index. The aspect engine takes it while holding its own lock, never
+ * the other way round. positions_generation moves whenever the elements
+ * or the timestamp change, so work done outside the lock can tell
+ * whether it is still current.
+ */
+static spinlock_t positions_lock = SPINLOCK_INIT;
+static time_t positions_time = 0;
+static uint32_t positions_generation = 0;
+static double positions_degree[BODY_CATALOG_MAX];
+static uint8_t positions_sign[BODY_CATALOG_MAX];
+static uint64_t positions_valid[BODY_CATALOG_MAX / 64];
+
+static uint32_t name_hash(const char *name) {
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/* Index of a named body, -1 if unknown; positions_lock held */
+static int find_index(const char *name) {
+    uint32_t slot = name_hash(name) % NAME_HASH_SIZE;
+    while (name_index[slot] != 0) {
+        int index = name_index[slot] - 1;
+        if (strcmp(body_names[index], name) == 0) {
+            return index;
+        }
+        slot = (slot + 1) % NAME_HASH_SIZE;
+    }
+    return -1;
+}
+
+/**
+ * Initialize the catalog with the ephemeris planets and built-in points
+ */
+int body_catalog_init(void) {
+    if (catalog_ready) return 0;
+    
+    catalog_count = 0;
+    memset(name_index, 0, sizeof(name_index));
+    memset(positions_valid, 0, sizeof(positions_valid));
+    catalog_ready = true;
+    
+    for (int i = 0; i < EPHEMERIS_PLANET_COUNT; i++) {
+        body_catalog_add(ephemeris_planet_name(i), BODY_PLANET, ephemeris_planet_period(i), 0.0);
+    }
+    
+    int builtin_count = sizeof(BUILTIN_BODIES) / sizeof(BUILTIN_BODIES[0]);
+    for (int i = 0; i < builtin_count; i++) {
+        body_catalog_add(BUILTIN_BODIES[i].name, BUILTIN_BODIES[i].kind,
+                         BUILTIN_BODIES[i].period_days, BUILTIN_BODIES[i].epoch_degree);
+    }
+    
+    return 0;
+}
+
+/**
+ * Add a body (or update one with the same name); returns its index
+ */
+int body_catalog_add(const char *name, body_kind_t kind, double period_days, double epoch_degree) {
+    if (!name || !*name) return -1;
+    body_catalog_init();
+    
+    unsigned long flags = spin_lock(&positions_lock);
+    int index = find_index(name);
+    if (index < 0) {
+        if (catalog_count >= BODY_CATALOG_MAX) {
+            spin_unlock(&positions_lock, flags);
+            fprintf(stderr, "[ORACLE] Body catalog full\n");
+            return -1;
+        }
+        
+        index = catalog_count;
+        strncpy(body_names[index], name, BODY_NAME_MAX - 1);
+        body_names[index][BODY_NAME_MAX - 1] = '\0';
+        
+        uint32_t slot = name_hash(body_names[index]) % NAME_HASH_SIZE;
+        while (name_index[slot] != 0) {
+            slot = (slot + 1) % NAME_HASH_SIZE;
+        }
+        name_index[slot] = (uint16_t)(index + 1);
+        catalog_count++;
+    } else if (index < EPHEMERIS_PLANET_COUNT) {
+        spin_unlock(&positions_lock, flags);
+        return index; /* The ephemeris planets are fixed */
+    }
+    
+    body_kinds[index] = (uint8_t)kind;
+    body_periods[index] = period_days;
+    body_epochs[index] = epoch_degree;
+    positions_valid[index / 64] &= ~(1ULL << (index % 64));
+    positions_generation++;
+    spin_unlock(&positions_lock, flags);
+    return index;
+}
+
+#ifdef USERLAND_BUILD
+/**
+ * Load bodies from catalog text, one per line:
+ *
+ *   <name> <kind> <period days> <epoch degree>
+ *
+ * Names may contain spaces if quoted. Returns the number of bodies loaded.
+ */
+int body_catalog_load_text(const char *text) {
+    if (!text) return -1;
+    body_catalog_init();
+    
+    int loaded = 0;
+    int line_no = 0;
+    const char *line = text;
+    
+    while (*line) {
+        const char *next = strchr(line, '\n');
+        size_t len = next ? (size_t)(next - line) : strlen(line);
+        char buf[256];
+        line_no++;
+        
+        if (len < sizeof(buf)) {
+            memcpy(buf, line, len);
+            buf[len] = '\0';
+            
+            char *cursor = buf;
+            while (*cursor == ' ' || *cursor == '\t') cursor++;
+            
+            if (*cursor && *cursor != '#') {
+                char name[BODY_NAME_MAX] = {0};
+                char kind_name[16] = {0};
+                double period = 0.0, epoch = 0.0;
+                int parsed;
+                
+                if (*cursor == '"') {
+                    char *close = strchr(cursor + 1, '"');
+                    size_t name_len = close ? (size_t)(close - cursor - 1) : 0;
+                    if (close && name_len < sizeof(name)) {
+                        memcpy(name, cursor + 1, name_len);
+                        parsed = 1 + sscanf(close + 1, "%15s %lf %lf", kind_name, &period, &epoch);
+                    } else {
+                        parsed = 0;
+                    }
+                } else {
+                    parsed = sscanf(cursor, "%23s %15s %lf %lf", name, kind_name, &period, &epoch);
+                }
+                
+                int kind = -1;
+                for (int k = 0; k <= BODY_FIXED_STAR; k++) {
+                    if (strcmp(kind_name, BODY_KIND_NAMES[k]) == 0) kind = k;
+                }
+                
+                /* A period of 0 or a non-finite value would never yield a sign */
+                bool elements_ok = isfinite(period) && isfinite(epoch) && period != 0.0;
+                if (elements_ok) {
+                    epoch = fmod(epoch, 360.0);
+                    if (epoch < 0.0) epoch += 360.0;
+                    if (epoch >= 360.0) epoch = 0.0;
+                }
+                
+                if (parsed == 4 && kind >= 0 && elements_ok &&
+                    body_catalog_add(name, (body_kind_t)kind, period, epoch) >= 0) {
+                    loaded++;
+                } else {
+                    fprintf(stderr, "[ORACLE] Body catalog line %d ignored\n", line_no);
+                }
+            }
+        }
+        
+        if (!next) break;
+        line = next + 1;
+    }
+    
+    return loaded;
+}
+
+/**
+ * Load bodies from a catalog file
+ */
+int body_catalog_load_file(const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) return -1;
+    
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (size < 0) {
+        fclose(fp);
+        return -1;
+    }
+    
+    char *text = malloc((size_t)size + 1);
+    if (!text) {
+        fclose(fp);
+        return -1;
+    }
+    size_t len = fread(text, 1, (size_t)size, fp);
+    text[len] = '\0';
+    fclose(fp);
+    
+    int loaded = body_catalog_load_text(text);
+    free(text);
+    return loaded;
+}
+#else
+int body_catalog_load_text(const char *text) {
+    (void)text;
+    return -1;
+}
+
+int body_catalog_load_file(const char *path) {
+    (void)path;
+    return -1;
+}
+#endif /* USERLAND_BUILD */
+
+/**
+ * Number of bodies in the catalog
+ */
+int body_catalog_count(void) {
+    body_catalog_init();
+    return catalog_count;
+}
+
+/**
+ * Find a body by name, -1 if unknown
+ */
+int body_catalog_find(const char *name) {
+    if (!name) return -1;
+    body_catalog_init();
+    
+    unsigned long flags = spin_lock(&positions_lock);
+    int index = find_index(name);
+    spin_unlock(&positions_lock, flags);
+    return index;
+}
+
+/**
+ * Get a body name
+ */
+const char* body_catalog_name(int index) {
+    if (index < 0 || index >= catalog_count) return "Unknown";
+    return body_names[index];
+}
+
+/**
+ * Get a body kind
+ */
+body_kind_t body_catalog_kind(int index) {
+    if (index < 0 || index >= catalog_count) return BODY_PLANET;
+    return (body_kind_t)body_kinds[index];
+}
+
+/**
+ * Get the catalog keyword for a body kind
+ */
+const char* body_catalog_kind_name(body_kind_t kind) {
+    if (kind >= BODY_PLANET && kind <= BODY_FIXED_STAR) {
+        return BODY_KIND_NAMES[kind];
+    }
+    return "unknown";
+}
+
+/**
+ * Empty a subset
+ */
+void body_subset_clear(body_subset_t *subset) {
+    memset(subset, 0, sizeof(*subset));
+}
+
+/**
+ * Add a body to a subset
+ */
+void body_subset_add(body_subset_t *subset, int index) {
+    if (index < 0 || index >= BODY_CATALOG_MAX) return;
+    uint64_t bit = 1ULL << (index % 64);
+    if (!(subset->bits[index / 64] & bit)) {
+        subset->bits[index / 64] |= bit;
+        subset->count++;
+    }
+}
+
+/**
+ * Check subset membership
+ */
+bool body_subset_contains(const body_subset_t *subset, int index) {
+    if (index < 0 || index >= BODY_CATALOG_MAX) return false;
+    return (subset->bits[index / 64] >> (index % 64)) & 1;
+}
+
+/* Compute [begin, end) for bodies selected by mask (NULL = all) */
+static void compute_range(double days, int begin, int end, const uint64_t *mask,
+                          const double *periods, const double *epochs,
+                          double *degrees, uint8_t *signs) {
+    for (int i = begin; i < end; i++) {
+        if (mask && !((mask[i / 64] >> (i % 64)) & 1)) continue;
+        
+        /* Same form as the ephemeris simulation so planets agree exactly */
+        double degree = epochs[i];
+        if (periods[i] != 0.0) {
+            degree += fmod(days / periods[i], 1.0) * 360.0;
+        }
+        if (degree < 0.0) degree += 360.0;
+        if (degree >= 360.0) degree -= 360.0;
+        
+        degrees[i] = degree;
+        signs[i] = (uint8_t)(((int)degree / 30) % 12);
+    }
+}
+
+/* Drop every position when the timestamp moves; positions_lock held */
+static void positions_retime(time_t timestamp) {
+    if (timestamp != positions_time) {
+        memset(positions_valid, 0, sizeof(positions_valid));
+        positions_time = timestamp;
+        positions_generation++;
+    }
+}
+
+#ifdef USERLAND_BUILD
+/* Elements copied out under positions_lock, and the results */
+typedef struct {
+    double periods[BODY_CATALOG_MAX];
+    double epochs[BODY_CATALOG_MAX];
+    double degrees[BODY_CATALOG_MAX];
+    uint8_t signs[BODY_CATALOG_MAX];
+} compute_scratch_t;
+
+typedef struct {
+    double days;
+    int begin;
+    int end;
+    const uint64_t *mask;
+    compute_scratch_t *scratch;
+} compute_chunk_t;
+
+static void *compute_worker(void *arg) {
+    compute_chunk_t *chunk = arg;
+    compute_scratch_t *scratch = chunk->scratch;
+    compute_range(chunk->days, chunk->begin, chunk->end, chunk->mask,
+                  scratch->periods, scratch->epochs, scratch->degrees, scratch->signs);
+    return NULL;
+}
+
+/* Split count bodies across worker threads; runs without positions_lock */
+static void compute_parallel(double days, int count, const uint64_t *mask,
+                             compute_scratch_t *scratch) {
+    compute_chunk_t chunks[MAX_WORKERS];
+    pthread_t threads[MAX_WORKERS];
+    int workers = (count + BODY_PARALLEL_CHUNK - 1) / BODY_PARALLEL_CHUNK;
+    if (workers > MAX_WORKERS) workers = MAX_WORKERS;
+    
+    /* Split on 64-body boundaries so workers never share a mask word */
+    int per_worker = ((count + workers - 1) / workers + 63) & ~63;
+    int started = 0;
+    for (int w = 0; w < workers; w++) {
+        chunks[w].days = days;
+        chunks[w].begin = w * per_worker;
+        chunks[w].end = (w + 1) * per_worker < count ? (w + 1) * per_worker : count;
+        chunks[w].mask = mask;
+        chunks[w].scratch = scratch;
+        if (chunks[w].begin >= chunks[w].end) break;
+        if (pthread_create(&threads[w], NULL, compute_worker, &chunks[w]) != 0) {
+            compute_worker(&chunks[w]);
+            continue;
+        }
+        started |= 1 << w;
+    }
+    for (int w = 0; w < workers; w++) {
+        if (started & (1 << w)) pthread_join(threads[w], NULL);
+    }
+}
+#endif
+
+/**
+ * Compute longitudes for a subset (NULL = whole catalog) at a timestamp
+ *
+ * Bodies already valid for this timestamp are skipped, so successive
+ * queries for different subsets of the same tick share work.
+ */
+int body_catalog_compute(time_t timestamp, const body_subset_t *subset) {
+    body_catalog_init();
+    
+    unsigned long flags = spin_lock(&positions_lock);
+    positions_retime(timestamp);
+    
+    /* Only compute what is requested and not yet valid */
+    uint64_t mask[BODY_CATALOG_MAX / 64];
+    int count = catalog_count;
+    int words = (count + 63) / 64;
+    int pending = 0;
+    for (int w = 0; w < words; w++) {
+        uint64_t want = subset ? subset->bits[w] : ~0ULL;
+        mask[w] = want & ~positions_valid[w];
+        for (uint64_t m = mask[w]; m; m &= m - 1) {
+            pending++;
+        }
+    }
+    if (pending == 0) {
+        spin_unlock(&positions_lock, flags);
+        return 0;
+    }
+    
+    double days = difftime(timestamp, 0) / 86400.0;
+
+#ifdef USERLAND_BUILD
+    /*
+     * Workers run without the lock so other callers are not held up for
+     * the thread lifecycle. Their results are published only if nothing
+     * moved meanwhile; otherwise the bodies stay invalid and are computed
+     * lazily by the next reader.
+     */
+    compute_scratch_t *scratch = pending > BODY_PARALLEL_CHUNK ? malloc(sizeof(*scratch)) : NULL;
+    if (scratch) {
+        uint32_t generation = positions_generation;
+        memcpy(scratch->periods, body_periods, (size_t)count * sizeof(double));
+        memcpy(scratch->epochs, body_epochs, (size_t)count * sizeof(double));
+        spin_unlock(&positions_lock, flags);
+        
+        compute_parallel(days, count, mask, scratch);
+        
+        flags = spin_lock(&positions_lock);
+        if (positions_generation == generation) {
+            for (int w = 0; w < words; w++) {
+                for (uint64_t m = mask[w]; m; m &= m - 1) {
+                    int i = w * 64 + __builtin_ctzll(m);
+                    positions_degree[i] = scratch->degrees[i];
+                    positions_sign[i] = scratch->signs[i];
+                }
+                positions_valid[w] |= mask[w];
+            }
+        }
+        spin_unlock(&positions_lock, flags);
+        free(scratch);
+        return pending;
+    }
+#endif
+    
+    compute_range(days, 0, count, mask, body_periods, body_epochs,
+                  positions_degree, positions_sign);
+    for (int w = 0; w < words; w++) {
+        positions_valid[w] |= mask[w];
+    }
+    spin_unlock(&positions_lock, flags);
+    return pending;
+}
+
+/* Make one body's position valid for timestamp; positions_lock held */
+static void compute_one(int index, time_t timestamp) {
+    positions_retime(timestamp);
+    
+    uint64_t bit = 1ULL << (index % 64);
+    if (!(positions_valid[index / 64] & bit)) {
+        compute_range(difftime(timestamp, 0) / 86400.0, index, index + 1, NULL,
+                      body_periods, body_epochs, positions_degree, positions_sign);
+        positions_valid[index / 64] |= bit;
+    }
+}
+
+/**
+ * Longitude of one body, computing it lazily if needed
+ */
+double body_catalog_degree(int index, time_t timestamp) {
+    if (index < 0 || index >= body_catalog_count()) return 0.0;
+    
+    unsigned long flags = spin_lock(&positions_lock);
+    compute_one(index, timestamp);
+    double degree = positions_degree[index];
+    spin_unlock(&positions_lock, flags);
+    return degree;
+}
+
+/**
+ * Zodiac sign index of one body, computing it lazily if needed
+ */
+int body_catalog_sign(int index, time_t timestamp) {
+    if (index < 0 || index >= body_catalog_count()) return -1;
+    
+    unsigned long flags = spin_lock(&positions_lock);
+    compute_one(index, timestamp);
+    int sign = positions_sign[index];
+    spin_unlock(&positions_lock, flags);
+    return sign;
+}
@@ -0,0 +1,60 @@
+/**
+ * Body Catalog - The Wider Heavens
+ *
+ * Catalog of celestial bodies beyond the ten classic planets: lunar
+ * nodes, Lilith, asteroids and fixed stars. Bodies are stored as
+ * structure-of-arrays and their longitudes are computed on demand for
+ * just the subset a query references, in parallel chunks when the
+ * subset is large.
+ *
+ * Indices 0-9 always mirror the ephemeris planets (Sun .. Pluto).
+ */
+
+#ifndef BODY_CATALOG_H
+#define BODY_CATALOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ephemeris_provider.h"
+
+#define BODY_CATALOG_MAX     8192
+#define BODY_NAME_MAX        24
+#define BODY_PARALLEL_CHUNK  1024   /* Bodies per worker when computing in parallel */
+#define BODY_CATALOG_DEFAULT "/etc/spiro/bodies.catalog"
+
+typedef enum {
+    BODY_PLANET = 0,
+    BODY_ASTEROID,
+    BODY_NODE,
+    BODY_POINT,          /* Calculated points such as Black Moon Lilith */
+    BODY_FIXED_STAR
+} body_kind_t;
+
+/* Set of catalog indices a query needs */
+typedef struct {
+    uint64_t bits[BODY_CATALOG_MAX / 64];
+    int count;
+} body_subset_t;
+
+/* Catalog management */
+int body_catalog_init(void);
+int body_catalog_add(const char *name, body_kind_t kind, double period_days, double epoch_degree);
+int body_catalog_load_text(const char *text);
+int body_catalog_load_file(const char *path);
+int body_catalog_count(void);
+int body_catalog_find(const char *name);
+const char* body_catalog_name(int index);
+body_kind_t body_catalog_kind(int index);
+const char* body_catalog_kind_name(body_kind_t kind);
+
+/* Subsets */
+void body_subset_clear(body_subset_t *subset);
+void body_subset_add(body_subset_t *subset, int index);
+bool body_subset_contains(const body_subset_t *subset, int index);
+
+/* Position computation into the catalog's SoA buffers */
+int body_catalog_compute(time_t timestamp, const body_subset_t *subset);
+double body_catalog_degree(int index, time_t timestamp);
+int body_catalog_sign(int index, time_t timestamp);
+
+#endif /* BODY_CATALOG_H */
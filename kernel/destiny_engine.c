@@ -6,13 +6,44 @@
 
 #include "freestanding.h"
 #include "destiny_engine.h"
+#include "audit_log.h"
+#include "simd.h"
+#include "sync.h"
+#ifndef USERLAND_BUILD
+#include "work_queue.h"
+#endif
 
 #define MAX_TRIGGERS 128
+#define AWAKEN_BATCH 8      /* Awakenings collected per hold of registry_lock */
 
+/* Fact bits: moon phase, day of month, then 12 signs per planet */
+#define FACT_MOON   0
+#define FACT_DAY    8
+#define FACT_SIGN   40
+#define FACT_BITS   (FACT_SIGN + EPHEMERIS_PLANET_COUNT * 12)
+
+/* Triggers are added and removed from any CPU while the tick reads them */
 static trigger_t trigger_registry[MAX_TRIGGERS];
 static int trigger_count = 0;
+static spinlock_t registry_lock = SPINLOCK_INIT;
 static ritual_profile_t current_profile;
 
+#ifndef USERLAND_BUILD
+/* The tick only batches audit rows; the worker encodes them */
+static int audit_queue = -1;
+
+static void destiny_flush_audit(void *arg) {
+    (void)arg;
+    audit_log_flush();
+}
+#endif
+
+/* DSL moon values, indexed by moon_phase_t */
+static const char* MOON_DSL_NAMES[] = {
+    "New", "Waxing Crescent", "First Quarter", "Waxing Gibbous",
+    "Full", "Waning Gibbous", "Last Quarter", "Waning Crescent"
+};
+
 /**
  * Initialize the Destiny Engine
  */
@@ -21,6 +52,26 @@ int destiny_engine_init(void) {
     trigger_count = 0;
     memset(&current_profile, 0, sizeof(current_profile));
     
+    body_catalog_init();
+#ifdef USERLAND_BUILD
+    /* Extra bodies are optional; triggers that name them fail to compile */
+    const char *catalog = getenv("SPIRO_BODY_CATALOG");
+    int loaded = body_catalog_load_file(catalog ? catalog : BODY_CATALOG_DEFAULT);
+    if (loaded > 0) {
+        printf("[DESTINY ENGINE] %d catalog bodies loaded\n", loaded);
+    }
+#endif
+
+    audit_log_init();
+#ifdef USERLAND_BUILD
+    const char *audit_path = getenv("SPIRO_AUDIT_LOG");
+    if (audit_path && audit_path[0]) {
+        audit_log_set_path(audit_path);
+    }
+#else
+    audit_queue = work_queue_create("audit", WORK_PRIORITY_LOW);
+#endif
+
     printf("[DESTINY ENGINE] Awakening... Cosmic orchestration begins.\n");
     return 0;
 }
@@ -29,6 +80,7 @@ int destiny_engine_init(void) {
  * Shutdown the engine
  */
 int destiny_engine_shutdown(void) {
+    audit_log_sync();
     printf("[DESTINY ENGINE] The wheel of destiny stops turning...\n");
     return 0;
 }
@@ -38,12 +90,21 @@ int destiny_engine_shutdown(void) {
  */
 int destiny_engine_add_trigger(const char *name, const char *expr, 
                                const char *exec_path, execution_mode_t mode) {
+    unsigned long flags = spin_lock(&registry_lock);
     if (trigger_count >= MAX_TRIGGERS) {
+        spin_unlock(&registry_lock, flags);
         fprintf(stderr, "[DESTINY ENGINE] Trigger registry full\n");
         return -1;
     }
     
     trigger_t *trigger = &trigger_registry[trigger_count];
+    memset(trigger, 0, sizeof(*trigger));
+    if (destiny_engine_compile_trigger(expr, &trigger->compiled) != 0) {
+        spin_unlock(&registry_lock, flags);
+        fprintf(stderr, "[DESTINY ENGINE] Cannot compile trigger '%s': %s\n", name, expr);
+        return -1;
+    }
+    
     strncpy(trigger->name, name, sizeof(trigger->name) - 1);
     strncpy(trigger->expression, expr, sizeof(trigger->expression) - 1);
     strncpy(trigger->exec_path, exec_path, sizeof(trigger->exec_path) - 1);
@@ -51,6 +112,7 @@ int destiny_engine_add_trigger(const char *name, const char *expr,
     trigger->active = true;
     
     trigger_count++;
+    spin_unlock(&registry_lock, flags);
     printf("[DESTINY ENGINE] Trigger registered: '%s'\n", name);
     return 0;
 }
@@ -59,6 +121,7 @@ int destiny_engine_add_trigger(const char *name, const char *expr,
  * Remove a trigger
  */
 int destiny_engine_remove_trigger(const char *name) {
+    unsigned long flags = spin_lock(&registry_lock);
     for (int i = 0; i < trigger_count; i++) {
         if (strcmp(trigger_registry[i].name, name) == 0) {
             /* Shift remaining triggers */
@@ -66,85 +129,432 @@ int destiny_engine_remove_trigger(const char *name) {
                 trigger_registry[j] = trigger_registry[j + 1];
             }
             trigger_count--;
+            spin_unlock(&registry_lock, flags);
             printf("[DESTINY ENGINE] Trigger removed: '%s'\n", name);
             return 0;
         }
     }
+    spin_unlock(&registry_lock, flags);
     return -1;
 }
 
 /**
  * Get a trigger by name
+ *
+ * The pointer stays valid until a trigger is removed.
  */
 trigger_t* destiny_engine_get_trigger(const char *name) {
+    trigger_t *found = NULL;
+    unsigned long flags = spin_lock(&registry_lock);
     for (int i = 0; i < trigger_count; i++) {
         if (strcmp(trigger_registry[i].name, name) == 0) {
-            return &trigger_registry[i];
+            found = &trigger_registry[i];
+            break;
         }
     }
-    return NULL;
+    spin_unlock(&registry_lock, flags);
+    return found;
+}
+
+/**
+ * Copy a trigger by name, so readers never hold a registry pointer
+ */
+int destiny_engine_copy_trigger(const char *name, trigger_t *trigger) {
+    int result = -1;
+    unsigned long flags = spin_lock(&registry_lock);
+    for (int i = 0; i < trigger_count; i++) {
+        if (strcmp(trigger_registry[i].name, name) == 0) {
+            memcpy(trigger, &trigger_registry[i], sizeof(*trigger));
+            result = 0;
+            break;
+        }
+    }
+    spin_unlock(&registry_lock, flags);
+    return result;
+}
+
+/**
+ * Copy the name of the trigger at a registry position, for cursor-style
+ * iteration. Returns -1 past the end.
+ */
+int destiny_engine_trigger_name_at(int index, char *buf, size_t len) {
+    if (!buf || len == 0) return -1;
+    
+    int result = -1;
+    unsigned long flags = spin_lock(&registry_lock);
+    if (index >= 0 && index < trigger_count) {
+        strncpy(buf, trigger_registry[index].name, len - 1);
+        buf[len - 1] = '\0';
+        result = 0;
+    }
+    spin_unlock(&registry_lock, flags);
+    return result;
+}
+
+/**
+ * Number of registered triggers
+ */
+int destiny_engine_trigger_count(void) {
+    return trigger_count;
 }
 
 /**
  * List all triggers
  */
 int destiny_engine_list_triggers(trigger_t *triggers, int max_count) {
+    unsigned long flags = spin_lock(&registry_lock);
     int count = trigger_count < max_count ? trigger_count : max_count;
     memcpy(triggers, trigger_registry, count * sizeof(trigger_t));
+    spin_unlock(&registry_lock, flags);
     return count;
 }
 
-/**
- * Simple trigger expression evaluator
- * Supports basic conditions like: moon == "Full", numerology_day == 7
- */
-bool destiny_engine_evaluate_trigger(const char *expression, celestial_data_t *data) {
-    /* Simplified evaluation - in real implementation, use proper parser */
+static const char *skip_spaces(const char *p) {
+    while (*p == ' ' || *p == '\t') p++;
+    return p;
+}
+
+/* Consume a literal token, returning the position after it or NULL */
+static const char *expect(const char *p, const char *token) {
+    p = skip_spaces(p);
+    size_t len = strlen(token);
+    for (size_t i = 0; i < len; i++) {
+        if (p[i] != token[i]) return NULL;
+    }
+    return p + len;
+}
+
+/* Parse == or != */
+static const char *parse_comparison(const char *p, uint8_t *negate) {
+    const char *q;
+    if ((q = expect(p, "==")) != NULL) {
+        *negate = 0;
+        return q;
+    }
+    if ((q = expect(p, "!=")) != NULL) {
+        *negate = 1;
+        return q;
+    }
+    return NULL;
+}
+
+/* Parse a double-quoted string */
+static const char *parse_quoted(const char *p, char *out, size_t size) {
+    p = expect(p, "\"");
+    if (!p) return NULL;
     
-    /* Check for Full Moon */
-    if (strstr(expression, "moon == \"Full\"") != NULL) {
-        if (data->moon_phase != MOON_FULL) {
-            return false;
+    size_t len = 0;
+    while (*p && *p != '"') {
+        if (len + 1 >= size) return NULL;
+        out[len++] = *p++;
+    }
+    if (*p != '"') return NULL;
+    out[len] = '\0';
+    return p + 1;
+}
+
+static int moon_value(const char *name) {
+    for (int i = 0; i < 8; i++) {
+        if (strcmp(name, MOON_DSL_NAMES[i]) == 0 ||
+            strcmp(name, ephemeris_moon_phase_name((moon_phase_t)i)) == 0) {
+            return i;
         }
     }
+    return -1;
+}
+
+/* Parse one condition; returns the position after it or NULL */
+static const char *parse_condition(const char *p, trigger_condition_t *cond) {
+    char text[BODY_NAME_MAX];
+    const char *q;
     
-    /* Check for New Moon */
-    if (strstr(expression, "moon == \"New\"") != NULL) {
-        if (data->moon_phase != MOON_NEW) {
-            return false;
+    if ((q = expect(p, "moon")) != NULL) {
+        cond->kind = TRIGGER_COND_MOON;
+        if (!(q = parse_comparison(q, &cond->negate))) return NULL;
+        if (!(q = parse_quoted(q, text, sizeof(text)))) return NULL;
+        if ((cond->value = moon_value(text)) < 0) return NULL;
+        return q;
+    }
+    
+    if ((q = expect(p, "numerology_day")) != NULL) {
+        cond->kind = TRIGGER_COND_NUMEROLOGY;
+        if (!(q = parse_comparison(q, &cond->negate))) return NULL;
+        q = skip_spaces(q);
+        if (*q < '0' || *q > '9') return NULL;
+        int day = 0;
+        while (*q >= '0' && *q <= '9' && day < 1000) {
+            day = day * 10 + (*q++ - '0');
         }
+        cond->value = (int16_t)day;
+        return q;
+    }
+    
+    if ((q = expect(p, "planet[")) != NULL) {
+        cond->kind = TRIGGER_COND_PLANET_SIGN;
+        if (!(q = parse_quoted(q, text, sizeof(text)))) return NULL;
+        
+        /* Resolve the body once, here, instead of on every evaluation */
+        int body = body_catalog_find(text);
+        if (body < 0) return NULL;
+        cond->body = (int16_t)body;
+        
+        if (!(q = expect(q, "]"))) return NULL;
+        if (!(q = expect(q, ".sign"))) return NULL;
+        if (!(q = parse_comparison(q, &cond->negate))) return NULL;
+        if (!(q = parse_quoted(q, text, sizeof(text)))) return NULL;
+        if ((cond->value = ephemeris_sign_index(text)) < 0) return NULL;
+        return q;
+    }
+    
+    if ((q = expect(p, "aspect(")) != NULL) {
+        cond->kind = TRIGGER_COND_ASPECT;
+        if (!(q = parse_quoted(q, text, sizeof(text)))) return NULL;
+        int body = body_catalog_find(text);
+        if (!(q = expect(q, ","))) return NULL;
+        if (!(q = parse_quoted(q, text, sizeof(text)))) return NULL;
+        int body2 = body_catalog_find(text);
+        if (body < 0 || body2 < 0 || body == body2) return NULL;
+        cond->body = (int16_t)body;
+        cond->body2 = (int16_t)body2;
+        
+        if (!(q = expect(q, ")"))) return NULL;
+        if (!(q = parse_comparison(q, &cond->negate))) return NULL;
+        if (!(q = parse_quoted(q, text, sizeof(text)))) return NULL;
+        if ((cond->value = aspect_engine_type(text)) < 0) return NULL;
+        return q;
     }
     
-    /* Check numerology day */
-    char day_check[32];
-    for (int day = 1; day <= 31; day++) {
-        snprintf(day_check, sizeof(day_check), "numerology_day == %d", day);
-        if (strstr(expression, day_check) != NULL) {
-            if (data->numerology_day != day) {
-                return false;
+    return NULL;
+}
+
+static void set_fact(uint64_t *facts, int fact) {
+    facts[fact / 64] |= 1ull << (fact % 64);
+}
+
+/* The fact bit a condition tests, or -1 if it has none */
+static int condition_fact(const trigger_condition_t *cond) {
+    switch (cond->kind) {
+        case TRIGGER_COND_MOON:
+            if (cond->value >= 0 && cond->value < FACT_DAY - FACT_MOON) return FACT_MOON + cond->value;
+            break;
+        case TRIGGER_COND_NUMEROLOGY:
+            if (cond->value >= 0 && cond->value < FACT_SIGN - FACT_DAY) return FACT_DAY + cond->value;
+            break;
+        case TRIGGER_COND_PLANET_SIGN:
+            if (cond->body >= 0 && cond->body < EPHEMERIS_PLANET_COUNT &&
+                cond->value >= 0 && cond->value < 12) {
+                return FACT_SIGN + cond->body * 12 + cond->value;
             }
+            break;
+        default:
+            break;
+    }
+    return -1;
+}
+
+/* Build the bitmask form, or leave mask_groups at 0 if it has none */
+static void compile_masks(compiled_trigger_t *compiled) {
+    int groups = 0;
+    trigger_mask_group_t *group = &compiled->groups[0];
+    
+    for (int i = 0; i < compiled->count; i++) {
+        const trigger_condition_t *cond = &compiled->conditions[i];
+        int fact = condition_fact(cond);
+        if (fact < 0 || groups >= TRIGGER_MASK_GROUPS) {
+            compiled->mask_groups = 0;
+            return;
+        }
+        
+        set_fact(cond->negate ? group->forbidden : group->required, fact);
+        
+        if (cond->or_next || i == compiled->count - 1) {
+            groups++;
+            group++;
         }
     }
+    compiled->mask_groups = groups;
+}
+
+/**
+ * Compile a trigger expression
+ *
+ * Grammar: condition (('&&' | '||') condition)*, where && binds tighter
+ * than ||. Conditions:
+ *   moon == "Full"
+ *   numerology_day == 7
+ *   planet["Mars"].sign == "Scorpio"
+ *   aspect("Mars", "Venus") == "Square"
+ * Each also accepts !=.
+ */
+int destiny_engine_compile_trigger(const char *expression, compiled_trigger_t *compiled) {
+    if (!expression || !compiled) return -1;
+    
+    memset(compiled, 0, sizeof(*compiled));
+    const char *p = expression;
     
-    /* Check Mars in Scorpio (simplified) */
-    if (strstr(expression, "planet[\"Mars\"].sign == \"Scorpio\"") != NULL) {
-        bool mars_in_scorpio = false;
-        for (int i = 0; i < data->planet_count; i++) {
-            if (strcmp(data->planets[i].name, "Mars") == 0 &&
-                strcmp(data->planets[i].sign, "Scorpio") == 0) {
-                mars_in_scorpio = true;
-                break;
+    while (1) {
+        if (compiled->count >= TRIGGER_MAX_CONDITIONS) return -1;
+        
+        trigger_condition_t *cond = &compiled->conditions[compiled->count];
+        p = parse_condition(p, cond);
+        if (!p) return -1;
+        compiled->count++;
+        
+        p = skip_spaces(p);
+        if (*p == '\0') break;
+        
+        const char *q;
+        if ((q = expect(p, "&&")) != NULL) {
+            p = q;
+        } else if ((q = expect(p, "||")) != NULL) {
+            cond->or_next = 1;
+            p = q;
+        } else {
+            return -1;
+        }
+    }
+    
+    compile_masks(compiled);
+    return 0;
+}
+
+static bool evaluate_condition(const trigger_condition_t *cond, celestial_data_t *data) {
+    bool match;
+    
+    switch (cond->kind) {
+        case TRIGGER_COND_MOON:
+            match = data->moon_phase == (moon_phase_t)cond->value;
+            break;
+        case TRIGGER_COND_NUMEROLOGY:
+            match = data->numerology_day == cond->value;
+            break;
+        case TRIGGER_COND_PLANET_SIGN: {
+            int sign;
+            if (cond->body < data->planet_count) {
+                sign = ((int)data->planets[cond->body].degree / 30) % 12;
+            } else {
+                sign = body_catalog_sign(cond->body, data->timestamp);
             }
+            match = sign == cond->value;
+            break;
         }
-        if (!mars_in_scorpio) {
-            return false;
+        case TRIGGER_COND_ASPECT:
+            match = aspect_engine_between(data, cond->body, cond->body2) == (aspect_type_t)cond->value;
+            break;
+        default:
+            match = false;
+            break;
+    }
+    
+    return cond->negate ? !match : match;
+}
+
+/**
+ * Evaluate a compiled trigger
+ */
+bool destiny_engine_evaluate_compiled(const compiled_trigger_t *compiled, celestial_data_t *data) {
+    bool group = true;
+    
+    for (int i = 0; i < compiled->count; i++) {
+        const trigger_condition_t *cond = &compiled->conditions[i];
+        
+        /* Skip the rest of a group once it has failed */
+        if (group && !evaluate_condition(cond, data)) {
+            group = false;
+        }
+        
+        if (cond->or_next || i == compiled->count - 1) {
+            if (group) return true;
+            group = true;
         }
     }
     
-    /* If we got here, all conditions passed */
+    return false;
+}
+
+/*
+ * A tick's fact bits; false if planet signs would come from the
+ * catalog, which the bitmask form does not cover
+ */
+static bool tick_facts(const celestial_data_t *data, uint64_t *facts) {
+    memset(facts, 0, TRIGGER_FACT_WORDS * sizeof(uint64_t));
+    if (data->planet_count < EPHEMERIS_PLANET_COUNT) return false;
+    
+    if ((int)data->moon_phase >= 0 && (int)data->moon_phase < FACT_DAY - FACT_MOON) {
+        set_fact(facts, FACT_MOON + (int)data->moon_phase);
+    }
+    if (data->numerology_day >= 0 && data->numerology_day < FACT_SIGN - FACT_DAY) {
+        set_fact(facts, FACT_DAY + data->numerology_day);
+    }
+    for (int i = 0; i < EPHEMERIS_PLANET_COUNT; i++) {
+        int sign = ((int)data->planets[i].degree / 30) % 12;
+        if (sign >= 0) set_fact(facts, FACT_SIGN + i * 12 + sign);
+    }
     return true;
 }
 
+/* Some group has all its required bits and none of its forbidden ones */
+SIMD_KERNEL static inline __attribute__((always_inline))
+bool match_masks_lanes(const compiled_trigger_t *compiled, const uint64_t *facts) {
+    simd_u64x4 set = *(const simd_u64x4 *)facts;
+    
+    for (int g = 0; g < compiled->mask_groups; g++) {
+        simd_u64x4 required = *(const simd_u64x4 *)compiled->groups[g].required;
+        simd_u64x4 forbidden = *(const simd_u64x4 *)compiled->groups[g].forbidden;
+        simd_u64x4 miss = (required & ~set) | (forbidden & set);
+        if ((miss[0] | miss[1] | miss[2] | miss[3]) == 0) return true;
+    }
+    return false;
+}
+
+SIMD_KERNEL static bool match_masks(const compiled_trigger_t *compiled, const uint64_t *facts) {
+    return match_masks_lanes(compiled, facts);
+}
+
+SIMD_KERNEL SIMD_AVX static bool match_masks_avx(const compiled_trigger_t *compiled, const uint64_t *facts) {
+    return match_masks_lanes(compiled, facts);
+}
+
+/**
+ * Add the catalog bodies a compiled trigger references to a subset
+ */
+void destiny_engine_trigger_bodies(const compiled_trigger_t *compiled, body_subset_t *subset) {
+    for (int i = 0; i < compiled->count; i++) {
+        const trigger_condition_t *cond = &compiled->conditions[i];
+        if (cond->kind == TRIGGER_COND_PLANET_SIGN || cond->kind == TRIGGER_COND_ASPECT) {
+            if (cond->body >= EPHEMERIS_PLANET_COUNT) body_subset_add(subset, cond->body);
+        }
+        if (cond->kind == TRIGGER_COND_ASPECT && cond->body2 >= EPHEMERIS_PLANET_COUNT) {
+            body_subset_add(subset, cond->body2);
+        }
+    }
+}
+
+/**
+ * Add the bodies a compiled trigger takes aspects between to a subset
+ */
+void destiny_engine_trigger_aspect_bodies(const compiled_trigger_t *compiled, body_subset_t *subset) {
+    for (int i = 0; i < compiled->count; i++) {
+        if (compiled->conditions[i].kind == TRIGGER_COND_ASPECT) {
+            body_subset_add(subset, compiled->conditions[i].body);
+            body_subset_add(subset, compiled->conditions[i].body2);
+        }
+    }
+}
+
+/**
+ * Evaluate a trigger expression (compiled on the fly)
+ * Supports conditions like: moon == "Full", numerology_day == 7
+ */
+bool destiny_engine_evaluate_trigger(const char *expression, celestial_data_t *data) {
+    compiled_trigger_t compiled;
+    
+    if (destiny_engine_compile_trigger(expression, &compiled) != 0) {
+        return false;
+    }
+    return destiny_engine_evaluate_compiled(&compiled, data);
+}
+
 /**
  * Calculate astral priority
  * Priority = base_priority + moon_influence + planet_influence
@@ -181,6 +591,20 @@ int destiny_engine_calculate_astral_priority(int base_priority, celestial_data_t
     return priority;
 }
 
+/* An awakening copied out of the registry, logged once registry_lock is dropped */
+typedef struct {
+    audit_record_t record;
+    char exec_path[256];
+} awakening_t;
+
+static void record_awakenings(const awakening_t *batch, int count) {
+    for (int i = 0; i < count; i++) {
+        printf("[DESTINY ENGINE] Trigger awakened: '%s' -> %s\n",
+               batch[i].record.trigger, batch[i].exec_path);
+        audit_log_record(&batch[i].record);
+    }
+}
+
 /**
  * Execute the destiny tick - evaluate triggers and awaken rituals
  */
@@ -193,26 +617,110 @@ int destiny_engine_tick(void) {
         return -1;
     }
     
+    return destiny_engine_tick_with(&data);
+}
+
+/**
+ * Execute the destiny tick against an already computed celestial state
+ */
+int destiny_engine_tick_with(celestial_data_t *data) {
+    if (!data) return -1;
+    
     printf("[DESTINY ENGINE] Cosmic tick - Moon: %s (%.1f%% illuminated), Day: %d\n",
-           ephemeris_moon_phase_name(data.moon_phase),
-           data.moon_illumination * 100.0,
-           data.numerology_day);
+           ephemeris_moon_phase_name(data->moon_phase),
+           data->moon_illumination * 100.0,
+           data->numerology_day);
     
-    /* Evaluate all active triggers */
+    /* Compute only the catalog bodies that active triggers reference */
+    body_subset_t bodies;
+    body_subset_t aspect_bodies;
+    body_subset_clear(&bodies);
+    body_subset_clear(&aspect_bodies);
+    unsigned long flags = spin_lock(&registry_lock);
+    for (int i = 0; i < trigger_count; i++) {
+        if (trigger_registry[i].active) {
+            destiny_engine_trigger_bodies(&trigger_registry[i].compiled, &bodies);
+            destiny_engine_trigger_aspect_bodies(&trigger_registry[i].compiled, &aspect_bodies);
+        }
+    }
+    spin_unlock(&registry_lock, flags);
+    if (bodies.count > 0) {
+        body_catalog_compute(data->timestamp, &bodies);
+    }
+    
+    /* One aspect table per tick, shared by every trigger */
+    if (aspect_bodies.count > 0) {
+        aspect_engine_snapshot(data, &aspect_bodies);
+    }
+    
+    /* One fact set per tick for every trigger with a bitmask form */
+    uint64_t facts[TRIGGER_FACT_WORDS];
+    bool use_masks = tick_facts(data, facts);
+    bool avx = simd_has_avx();
+    
+    /*
+     * Evaluate all active triggers. Awakenings are copied into a batch
+     * and logged with registry_lock dropped, so a console write or an
+     * audit flush never runs with interrupts off.
+     */
     int awakened = 0;
+    int priority = destiny_engine_calculate_astral_priority(0, data);
+    awakening_t batch[AWAKEN_BATCH];
+    int batched = 0;
+    flags = spin_lock(&registry_lock);
     for (int i = 0; i < trigger_count; i++) {
         if (!trigger_registry[i].active) continue;
         
-        if (destiny_engine_evaluate_trigger(trigger_registry[i].expression, &data)) {
-            printf("[DESTINY ENGINE] Trigger awakened: '%s' -> %s\n",
-                   trigger_registry[i].name,
-                   trigger_registry[i].exec_path);
+        const compiled_trigger_t *compiled = &trigger_registry[i].compiled;
+        bool match;
+        if (use_masks && compiled->mask_groups > 0) {
+            match = avx ? match_masks_avx(compiled, facts) : match_masks(compiled, facts);
+        } else {
+            match = destiny_engine_evaluate_compiled(compiled, data);
+        }
+        
+        trigger_registry[i].evaluations++;
+        if (match) {
+            trigger_registry[i].awakenings++;
+            trigger_registry[i].last_awakened = data->timestamp;
             awakened++;
             
-            /* In real implementation, spawn ritual handler here */
+            /*
+             * In real implementation, spawn ritual handler here. Until
+             * then there is no latency or exit status to record.
+             */
+            awakening_t *awakening = &batch[batched++];
+            audit_record_t *record = &awakening->record;
+            memset(record, 0, sizeof(*record));
+            record->tick = soul_core_get_astral_tick();
+            record->timestamp = data->timestamp;
+            strncpy(record->trigger, trigger_registry[i].name, sizeof(record->trigger) - 1);
+            record->priority = priority;
+            record->mode = (uint8_t)trigger_registry[i].mode;
+            record->exit_status = AUDIT_NOT_SPAWNED;
+            strncpy(awakening->exec_path, trigger_registry[i].exec_path,
+                    sizeof(awakening->exec_path) - 1);
+            awakening->exec_path[sizeof(awakening->exec_path) - 1] = '\0';
+            
+            if (batched == AWAKEN_BATCH) {
+                spin_unlock(&registry_lock, flags);
+                record_awakenings(batch, batched);
+                batched = 0;
+                flags = spin_lock(&registry_lock);
+            }
         }
     }
-    
+    spin_unlock(&registry_lock, flags);
+    record_awakenings(batch, batched);
+#ifdef USERLAND_BUILD
+    audit_log_flush();
+#else
+    /* Inline only when the queue is full */
+    if (work_queue_enqueue(audit_queue, destiny_flush_audit, NULL) != 0) {
+        audit_log_flush();
+    }
+#endif
+
     if (awakened > 0) {
         printf("[DESTINY ENGINE] %d ritual(s) awakened this cosmic tick\n", awakened);
     }
@@ -236,3 +744,10 @@ int destiny_engine_save_profile(const char *profile_name) {
     printf("[DESTINY ENGINE] Saving profile: %s\n", profile_name);
     return 0;
 }
+
+/**
+ * Get the loaded profile; its name is empty until one is loaded
+ */
+const ritual_profile_t* destiny_engine_current_profile(void) {
+    return &current_profile;
+}
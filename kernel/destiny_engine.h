@@ -10,6 +10,8 @@
 
 #include "soul_core.h"
 #include "ephemeris_provider.h"
+#include "body_catalog.h"
+#include "aspect_engine.h"
 #include <stdbool.h>
 
 /* Ritual Execution Mode */
@@ -19,6 +21,46 @@ typedef enum {
     EXEC_MODE_OBSERVER
 } execution_mode_t;
 
+/* Compiled trigger conditions */
+#define TRIGGER_MAX_CONDITIONS 16
+
+typedef enum {
+    TRIGGER_COND_MOON = 0,       /* moon == "Full" */
+    TRIGGER_COND_NUMEROLOGY,     /* numerology_day == 7 */
+    TRIGGER_COND_PLANET_SIGN,    /* planet["Mars"].sign == "Scorpio" */
+    TRIGGER_COND_ASPECT          /* aspect("Mars","Venus") == "Square" */
+} trigger_condition_kind_t;
+
+typedef struct {
+    uint8_t kind;
+    uint8_t negate;              /* != instead of == */
+    uint8_t or_next;             /* Next condition starts a new || group */
+    int16_t body;                /* Body catalog index, resolved at compile time */
+    int16_t body2;               /* Second body of an aspect */
+    int16_t value;               /* Moon phase, day, sign or aspect type */
+} trigger_condition_t;
+
+/*
+ * Bitmask form. A tick's moon phase, day and planet signs are bits of
+ * one 256-bit fact set; an || group of plain conditions is the bits it
+ * needs set and the bits it needs clear. Triggers with aspects, catalog
+ * bodies or more groups keep condition-by-condition evaluation.
+ */
+#define TRIGGER_FACT_WORDS  4
+#define TRIGGER_MASK_GROUPS 4
+
+typedef struct {
+    uint64_t required[TRIGGER_FACT_WORDS];
+    uint64_t forbidden[TRIGGER_FACT_WORDS];
+} trigger_mask_group_t;
+
+typedef struct {
+    int count;
+    trigger_condition_t conditions[TRIGGER_MAX_CONDITIONS];
+    int mask_groups;             /* 0 = no bitmask form */
+    trigger_mask_group_t groups[TRIGGER_MASK_GROUPS];
+} compiled_trigger_t;
+
 /* Trigger Definition */
 typedef struct {
     char name[64];
@@ -26,6 +68,10 @@ typedef struct {
     char exec_path[256];
     execution_mode_t mode;
     bool active;
+    compiled_trigger_t compiled;
+    uint32_t evaluations;    /* Ticks it was evaluated on */
+    uint32_t awakenings;     /* Ticks it matched on */
+    time_t last_awakened;    /* Celestial timestamp of the last match, 0 = never */
 } trigger_t;
 
 /* Ritual Profile */
@@ -40,19 +86,28 @@ typedef struct {
 int destiny_engine_init(void);
 int destiny_engine_shutdown(void);
 int destiny_engine_tick(void);
+int destiny_engine_tick_with(celestial_data_t *data);
 
 /* Trigger Management */
 int destiny_engine_add_trigger(const char *name, const char *expr, 
                                const char *exec_path, execution_mode_t mode);
 int destiny_engine_remove_trigger(const char *name);
 trigger_t* destiny_engine_get_trigger(const char *name);
+int destiny_engine_copy_trigger(const char *name, trigger_t *trigger);
+int destiny_engine_trigger_name_at(int index, char *buf, size_t len);
+int destiny_engine_trigger_count(void);
 int destiny_engine_list_triggers(trigger_t *triggers, int max_count);
 
 /* Profile Management */
 int destiny_engine_load_profile(const char *profile_name);
 int destiny_engine_save_profile(const char *profile_name);
+const ritual_profile_t* destiny_engine_current_profile(void);
 
 /* Evaluation */
+int destiny_engine_compile_trigger(const char *expression, compiled_trigger_t *compiled);
+bool destiny_engine_evaluate_compiled(const compiled_trigger_t *compiled, celestial_data_t *data);
+void destiny_engine_trigger_bodies(const compiled_trigger_t *compiled, body_subset_t *subset);
+void destiny_engine_trigger_aspect_bodies(const compiled_trigger_t *compiled, body_subset_t *subset);
 bool destiny_engine_evaluate_trigger(const char *expression, celestial_data_t *data);
 int destiny_engine_calculate_astral_priority(int base_priority, celestial_data_t *data);
 
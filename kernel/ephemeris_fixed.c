@@ -0,0 +1,103 @@
+/**
+ * Ephemeris Fixed-Point Path - Implementation
+ *
+ * A rate is round(2^64 / period_in_seconds). Multiplying a timestamp by
+ * it modulo 2^64 yields the fraction of the orbit travelled, and the
+ * top 32 bits are the angle. On the -m32 kernel that is three 32-bit
+ * multiplies and no libgcc call.
+ */
+
+#include "freestanding.h"
+#include "ephemeris_fixed.h"
+
+/* Known new moon: January 6, 2000, 18:14 UTC */
+#define KNOWN_NEW_MOON 947182440
+
+/* round(2^64 / (29.530588853 * 86400)) */
+static const uint64_t SYNODIC_RATE = 7229926345099ULL;
+
+/* round(2^64 / (orbital period * 86400)), Sun through Pluto */
+static const uint64_t ORBITAL_RATES[EPHEMERIS_FIXED_BODIES] = {
+    584542046091ULL,    /* Sun      365.25 d   */
+    7814933467592ULL,   /* Moon     27.32 d    */
+    2427009006873ULL,   /* Mercury  87.97 d    */
+    950173486135ULL,    /* Venus    224.70 d   */
+    310786314499ULL,    /* Mars     686.98 d   */
+    49278602945ULL,     /* Jupiter  4332.59 d  */
+    19843816033ULL,     /* Saturn   10759.22 d */
+    6957133204ULL,      /* Uranus   30688.5 d  */
+    3547638535ULL,      /* Neptune  60182 d    */
+    2357596978ULL       /* Pluto    90560 d    */
+};
+
+static ephemeris_angle_t angle_at(int64_t seconds, uint64_t rate) {
+    return (ephemeris_angle_t)(((uint64_t)seconds * rate) >> 32);
+}
+
+/**
+ * Moon phase angle (0 = new, half turn = full)
+ */
+ephemeris_angle_t ephemeris_fixed_moon_phase(time_t timestamp) {
+    return angle_at((int64_t)timestamp - KNOWN_NEW_MOON, SYNODIC_RATE);
+}
+
+/**
+ * Planet ecliptic longitude angle
+ */
+ephemeris_angle_t ephemeris_fixed_planet_longitude(int body, time_t timestamp) {
+    if (body < 0 || body >= EPHEMERIS_FIXED_BODIES) return 0;
+    return angle_at((int64_t)timestamp, ORBITAL_RATES[body]);
+}
+
+/**
+ * Moon rate in 2^-64 turns per second
+ */
+uint64_t ephemeris_fixed_moon_rate(void) {
+    return SYNODIC_RATE;
+}
+
+/**
+ * Planet rate in 2^-64 turns per second
+ */
+uint64_t ephemeris_fixed_planet_rate(int body) {
+    if (body < 0 || body >= EPHEMERIS_FIXED_BODIES) return 0;
+    return ORBITAL_RATES[body];
+}
+
+/**
+ * Moon phase enum - eight buckets centred on the principal phases
+ */
+moon_phase_t ephemeris_fixed_moon_phase_enum(ephemeris_angle_t phase) {
+    /* Shift by 1/16 turn so each bucket starts on a multiple of 1/8 */
+    return (moon_phase_t)((ephemeris_angle_t)(phase + (1u << 28)) >> 29);
+}
+
+/**
+ * Moon illumination in Q16 (full at half a turn, new at zero)
+ */
+uint32_t ephemeris_fixed_illumination(ephemeris_angle_t phase) {
+    uint32_t distance = phase >= EPHEMERIS_ANGLE_HALF ? phase - EPHEMERIS_ANGLE_HALF
+                                                      : EPHEMERIS_ANGLE_HALF - phase;
+    return (EPHEMERIS_ANGLE_HALF - distance) >> 15;
+}
+
+/**
+ * Zodiac sign index (12 signs per turn)
+ */
+int ephemeris_fixed_sign_index(ephemeris_angle_t longitude) {
+    return (int)(((uint64_t)longitude * 12) >> 32);
+}
+
+/**
+ * Angle to degrees (0 - 360)
+ */
+double ephemeris_fixed_to_degrees(ephemeris_angle_t angle) {
+    return (double)angle * (360.0 / 4294967296.0);
+}
+
+/**
+ * Angle to turns (0.0 - 1.0)
+ */
+double ephemeris_fixed_to_turns(ephemeris_angle_t angle) {
+    return (double)angle * (1.0 / 4294967296.0);
+}
@@ -0,0 +1,43 @@
+/**
+ * Ephemeris Fixed-Point Path - Integer Oracle
+ *
+ * Moon phase, illumination, planet longitude and sign index computed
+ * with integer angle units (2^32 per turn) and precomputed reciprocal
+ * periods. No FPU state and no 64-bit divides are needed, and results
+ * are bit-reproducible across machines.
+ *
+ * Build the kernel with EPHEMERIS_FIXED_POINT (make FIXED_POINT=1) to
+ * make this the offline simulation path.
+ */
+
+#ifndef EPHEMERIS_FIXED_H
+#define EPHEMERIS_FIXED_H
+
+#include <stdint.h>
+#include "ephemeris_provider.h"
+
+/* 2^32 angle units per full turn */
+typedef uint32_t ephemeris_angle_t;
+
+#define EPHEMERIS_ANGLE_HALF    0x80000000u
+#define EPHEMERIS_FIXED_ONE     65536u      /* Q16 unit for illumination */
+#define EPHEMERIS_FIXED_BODIES  10
+
+/* Angle at a timestamp: top 32 bits of (seconds * rate) mod 2^64 */
+ephemeris_angle_t ephemeris_fixed_moon_phase(time_t timestamp);
+ephemeris_angle_t ephemeris_fixed_planet_longitude(int body, time_t timestamp);
+
+/* Per-second rates in 2^-64 turns, for incremental accumulation */
+uint64_t ephemeris_fixed_moon_rate(void);
+uint64_t ephemeris_fixed_planet_rate(int body);
+
+/* Derived quantities */
+moon_phase_t ephemeris_fixed_moon_phase_enum(ephemeris_angle_t phase);
+uint32_t ephemeris_fixed_illumination(ephemeris_angle_t phase);   /* Q16, 0..65536 */
+int ephemeris_fixed_sign_index(ephemeris_angle_t longitude);
+
+/* Conversions at the celestial_data_t boundary */
+double ephemeris_fixed_to_degrees(ephemeris_angle_t angle);
+double ephemeris_fixed_to_turns(ephemeris_angle_t angle);
+
+#endif /* EPHEMERIS_FIXED_H */
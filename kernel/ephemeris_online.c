@@ -0,0 +1,604 @@
+/**
+ * Ephemeris Online Backend - Implementation
+ *
+ * Two segment slots are published under per-slot sequence counters.
+ * The prefetch thread only ever rewrites the slot that does not cover
+ * the present, so readers almost never have to retry and never wait
+ * on a fetch in progress.
+ */
+
+#include "freestanding.h"
+#include "ephemeris_online.h"
+
+#ifdef USERLAND_BUILD
+
+#include <pthread.h>
+#include <dirent.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#define MAX_SOURCES         8
+#define SEGMENT_TEXT_MAX    65536
+#define LOOKUP_RETRIES      3
+
+typedef struct {
+    volatile uint32_t seq;      /* Odd while the slot is being refilled */
+    bool valid;
+    time_t fetched_at;
+    ephemeris_segment_t segment;
+} segment_slot_t;
+
+static const ephemeris_source_ops_t *source_table[MAX_SOURCES];
+static int source_count = 0;
+
+static const ephemeris_source_ops_t *active_ops = NULL;
+static void *active_handle = NULL;
+
+static segment_slot_t slots[2];
+static ephemeris_online_stats_t stats;
+
+static pthread_mutex_t writer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t wake_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t prefetch_thread;
+static volatile bool prefetch_running = false;
+
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+/* Normalize into [0, turn); false for values that are not finite */
+static bool wrap_turn(double *value, double turn) {
+    double v = fmod(*value, turn);
+    if (v < 0) v += turn;
+    if (v >= turn) v -= turn;
+    if (!(v >= 0.0 && v < turn)) return false;
+
+    *value = v;
+    return true;
+}
+
+/**
+ * Parse the text segment format:
+ *
+ *   # spiro-ephemeris 1
+ *   start <unix time>
+ *   step <seconds>
+ *   <moon phase> <Sun deg> <Moon deg> ... <Pluto deg>   (one line per sample)
+ *
+ * Phases are wrapped into [0, 1) and degrees into [0, 360); a sample
+ * that is not a finite number rejects the segment.
+ */
+int ephemeris_segment_parse(const char *text, ephemeris_segment_t *segment) {
+    if (!text || !segment) return -1;
+
+    memset(segment, 0, sizeof(*segment));
+    bool have_start = false;
+
+    const char *line = text;
+    while (*line) {
+        const char *next = strchr(line, '\n');
+        size_t len = next ? (size_t)(next - line) : strlen(line);
+        char buf[512];
+        if (len >= sizeof(buf)) return -1;
+        memcpy(buf, line, len);
+        buf[len] = '\0';
+
+        if (buf[0] == '#' || buf[0] == '\0') {
+            /* Comment or blank line */
+        } else if (strncmp(buf, "start ", 6) == 0) {
+            segment->start = (time_t)strtol(buf + 6, NULL, 10);
+            have_start = true;
+        } else if (strncmp(buf, "step ", 5) == 0) {
+            segment->step = (int32_t)strtol(buf + 5, NULL, 10);
+        } else {
+            if (segment->sample_count >= EPHEMERIS_SEGMENT_SAMPLES) return -1;
+
+            int n = segment->sample_count;
+            char *cursor = buf;
+            char *end;
+            segment->moon_phase[n] = strtod(cursor, &end);
+            if (end == cursor || !wrap_turn(&segment->moon_phase[n], 1.0)) return -1;
+            for (int b = 0; b < EPHEMERIS_SEGMENT_BODIES; b++) {
+                cursor = end;
+                segment->degree[n][b] = strtod(cursor, &end);
+                if (end == cursor || !wrap_turn(&segment->degree[n][b], 360.0)) return -1;
+            }
+            segment->sample_count++;
+        }
+
+        if (!next) break;
+        line = next + 1;
+    }
+
+    if (!have_start || segment->step <= 0 || segment->sample_count < 2) {
+        return -1;
+    }
+    return 0;
+}
+
+/* ---- file: source - a drop directory of <start>.eph files ---- */
+
+static int file_source_open(const char *location, void **handle) {
+    DIR *dir = opendir(location);
+    if (!dir) return -1;
+    closedir(dir);
+    *handle = strdup(location);
+    return *handle ? 0 : -1;
+}
+
+static int file_source_fetch(void *handle, time_t want, ephemeris_segment_t *segment) {
+    const char *dirpath = handle;
+    DIR *dir = opendir(dirpath);
+    if (!dir) return -1;
+
+    /* Latest segment starting at or before the wanted instant */
+    long best = -1;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        char *end;
+        long start = strtol(entry->d_name, &end, 10);
+        if (end == entry->d_name || strcmp(end, ".eph") != 0) continue;
+        if (start <= (long)want && start > best) best = start;
+    }
+    closedir(dir);
+    if (best < 0) return -1;
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%ld.eph", dirpath, best);
+    FILE *fp = fopen(path, "r");
+    if (!fp) return -1;
+
+    char *text = malloc(SEGMENT_TEXT_MAX);
+    if (!text) {
+        fclose(fp);
+        return -1;
+    }
+    size_t len = fread(text, 1, SEGMENT_TEXT_MAX - 1, fp);
+    text[len] = '\0';
+    fclose(fp);
+
+    int result = ephemeris_segment_parse(text, segment);
+    free(text);
+    return result;
+}
+
+static void file_source_close(void *handle) {
+    free(handle);
+}
+
+static const ephemeris_source_ops_t file_source = {
+    .scheme = "file",
+    .open = file_source_open,
+    .fetch = file_source_fetch,
+    .close = file_source_close,
+};
+
+/* ---- unix: source - "FETCH <time>\n" request, segment text reply ---- */
+
+static int unix_source_open(const char *location, void **handle) {
+    if (strlen(location) >= sizeof(((struct sockaddr_un *)0)->sun_path)) return -1;
+    *handle = strdup(location);
+    return *handle ? 0 : -1;
+}
+
+static int unix_source_fetch(void *handle, time_t want, ephemeris_segment_t *segment) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    struct timeval timeout = {2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, handle, sizeof(addr.sun_path) - 1);
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    char request[64];
+    int req_len = snprintf(request, sizeof(request), "FETCH %ld\n", (long)want);
+    if (write(fd, request, req_len) != req_len) {
+        close(fd);
+        return -1;
+    }
+
+    char *text = malloc(SEGMENT_TEXT_MAX);
+    if (!text) {
+        close(fd);
+        return -1;
+    }
+    size_t len = 0;
+    while (len < SEGMENT_TEXT_MAX - 1) {
+        ssize_t n = read(fd, text + len, SEGMENT_TEXT_MAX - 1 - len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        len += (size_t)n;
+    }
+    text[len] = '\0';
+    close(fd);
+
+    int result = ephemeris_segment_parse(text, segment);
+    free(text);
+    return result;
+}
+
+static void unix_source_close(void *handle) {
+    free(handle);
+}
+
+static const ephemeris_source_ops_t unix_source = {
+    .scheme = "unix",
+    .open = unix_source_open,
+    .fetch = unix_source_fetch,
+    .close = unix_source_close,
+};
+
+/**
+ * Register a segment source
+ */
+int ephemeris_online_register_source(const ephemeris_source_ops_t *ops) {
+    if (!ops || !ops->scheme || !ops->fetch) return -1;
+    if (source_count >= MAX_SOURCES) return -1;
+
+    source_table[source_count++] = ops;
+    return 0;
+}
+
+static const ephemeris_source_ops_t *find_source(const char *scheme, size_t len) {
+    if (source_count == 0) {
+        ephemeris_online_register_source(&file_source);
+        ephemeris_online_register_source(&unix_source);
+    }
+
+    for (int i = 0; i < source_count; i++) {
+        if (strlen(source_table[i]->scheme) == len &&
+            strncmp(source_table[i]->scheme, scheme, len) == 0) {
+            return source_table[i];
+        }
+    }
+    return NULL;
+}
+
+/* Writer side of a slot's sequence counter; caller holds writer_lock */
+static void slot_write_begin(segment_slot_t *slot) {
+    __atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void slot_write_end(segment_slot_t *slot) {
+    __atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Select the source by URI, e.g. "file:/var/lib/spiro/ephemeris"
+ */
+int ephemeris_online_set_source(const char *uri) {
+    if (!uri) return -1;
+
+    const char *colon = strchr(uri, ':');
+    if (!colon) {
+        fprintf(stderr, "[ORACLE] Source URI needs a scheme: %s\n", uri);
+        return -1;
+    }
+
+    const ephemeris_source_ops_t *ops = find_source(uri, (size_t)(colon - uri));
+    if (!ops) {
+        fprintf(stderr, "[ORACLE] Unknown ephemeris source scheme: %s\n", uri);
+        return -1;
+    }
+
+    void *handle = NULL;
+    if (ops->open && ops->open(colon + 1, &handle) != 0) {
+        fprintf(stderr, "[ORACLE] Cannot open ephemeris source: %s\n", uri);
+        return -1;
+    }
+
+    pthread_mutex_lock(&writer_lock);
+    if (active_ops && active_ops->close) {
+        active_ops->close(active_handle);
+    }
+    active_ops = ops;
+    active_handle = handle;
+    for (int s = 0; s < 2; s++) {
+        slot_write_begin(&slots[s]);
+        slots[s].valid = false;
+        slots[s].fetched_at = 0;
+        memset(&slots[s].segment, 0, sizeof(slots[s].segment));
+        slot_write_end(&slots[s]);
+    }
+    pthread_mutex_unlock(&writer_lock);
+
+    printf("[ORACLE] Ephemeris source: %s\n", uri);
+    return 0;
+}
+
+static time_t segment_end(const ephemeris_segment_t *segment) {
+    return segment->start + (time_t)segment->step * (segment->sample_count - 1);
+}
+
+static bool slot_covers(const segment_slot_t *slot, time_t t, time_t now) {
+    return slot->valid &&
+           now - slot->fetched_at <= EPHEMERIS_ONLINE_MAX_AGE &&
+           t >= slot->segment.start && t <= segment_end(&slot->segment);
+}
+
+/* Caller holds writer_lock; readers may be inside either slot */
+static void publish_segment(const ephemeris_segment_t *segment, time_t now) {
+    /* Keep the slot that covers the present; otherwise replace the older data */
+    bool covers0 = slot_covers(&slots[0], now, now);
+    bool covers1 = slot_covers(&slots[1], now, now);
+    int target;
+    if (covers0 != covers1) {
+        target = covers0 ? 1 : 0;
+    } else {
+        target = 0;
+        if (slots[0].valid && (!slots[1].valid ||
+                               slots[1].segment.start < slots[0].segment.start)) {
+            target = 1;
+        }
+    }
+
+    segment_slot_t *slot = &slots[target];
+    slot_write_begin(slot);
+
+    slot->segment = *segment;
+    slot->fetched_at = now;
+    slot->valid = true;
+
+    slot_write_end(slot);
+}
+
+static int fetch_and_publish(time_t want) {
+    ephemeris_segment_t *segment = malloc(sizeof(*segment));
+    if (!segment) return -1;
+
+    pthread_mutex_lock(&writer_lock);
+    if (!active_ops) {
+        pthread_mutex_unlock(&writer_lock);
+        free(segment);
+        return -1;
+    }
+
+    uint64_t begin = monotonic_us();
+    int result = active_ops->fetch(active_handle, want, segment);
+    uint64_t latency = monotonic_us() - begin;
+
+    stats.fetch_count++;
+    stats.last_latency_us = latency;
+    if (latency > stats.max_latency_us) stats.max_latency_us = latency;
+
+    if (result == 0) {
+        time_t now = time(NULL);
+        publish_segment(segment, now);
+        stats.last_fetch = now;
+    } else {
+        stats.fetch_failures++;
+    }
+    pthread_mutex_unlock(&writer_lock);
+
+    free(segment);
+    return result;
+}
+
+static void *prefetch_main(void *arg) {
+    (void)arg;
+
+    while (prefetch_running) {
+        time_t now = time(NULL);
+        time_t ahead = now + EPHEMERIS_ONLINE_LOOKAHEAD;
+
+        if (!slot_covers(&slots[0], ahead, now) && !slot_covers(&slots[1], ahead, now)) {
+            fetch_and_publish(ahead);
+        }
+        if (!slot_covers(&slots[0], now, now) && !slot_covers(&slots[1], now, now)) {
+            fetch_and_publish(now);
+        }
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += EPHEMERIS_ONLINE_POLL_MS / 1000;
+        deadline.tv_nsec += (long)(EPHEMERIS_ONLINE_POLL_MS % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        pthread_mutex_lock(&wake_lock);
+        if (prefetch_running) {
+            pthread_cond_timedwait(&wake_cond, &wake_lock, &deadline);
+        }
+        pthread_mutex_unlock(&wake_lock);
+    }
+
+    return NULL;
+}
+
+/**
+ * Start the background prefetcher
+ */
+int ephemeris_online_start(void) {
+    if (prefetch_running) return 0;
+    if (!active_ops) {
+        fprintf(stderr, "[ORACLE] No ephemeris source configured\n");
+        return -1;
+    }
+
+    prefetch_running = true;
+    if (pthread_create(&prefetch_thread, NULL, prefetch_main, NULL) != 0) {
+        prefetch_running = false;
+        return -1;
+    }
+
+    printf("[ORACLE] Prefetching ephemeris segments %ds ahead\n", EPHEMERIS_ONLINE_LOOKAHEAD);
+    return 0;
+}
+
+/**
+ * Stop the background prefetcher
+ */
+int ephemeris_online_stop(void) {
+    if (!prefetch_running) return 0;
+
+    pthread_mutex_lock(&wake_lock);
+    prefetch_running = false;
+    pthread_cond_signal(&wake_cond);
+    pthread_mutex_unlock(&wake_lock);
+
+    pthread_join(prefetch_thread, NULL);
+    return 0;
+}
+
+/**
+ * Fetch the segment covering a given instant synchronously
+ */
+int ephemeris_online_sync(time_t want) {
+    return fetch_and_publish(want);
+}
+
+static double wrap_lerp(double a, double b, double f, double turn) {
+    double d = b - a;
+    if (d > turn / 2) d -= turn;
+    if (d < -turn / 2) d += turn;
+
+    double v = a + d * f;
+    if (v < 0) v += turn;
+    if (v >= turn) v -= turn;
+    return v;
+}
+
+/**
+ * Look up an instant in the cached segments without blocking
+ */
+int ephemeris_online_lookup(time_t timestamp, double *moon_phase, double *degrees) {
+    time_t now = time(NULL);
+
+    for (int s = 0; s < 2; s++) {
+        segment_slot_t *slot = &slots[s];
+
+        for (int attempt = 0; attempt < LOOKUP_RETRIES; attempt++) {
+            uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+            if (seq & 1) break; /* Being refilled - try the other slot */
+
+            /* The slot may be torn; bound every index before the arrays are read */
+            const ephemeris_segment_t *segment = &slot->segment;
+            bool valid = __atomic_load_n(&slot->valid, __ATOMIC_RELAXED);
+            time_t fetched_at = __atomic_load_n(&slot->fetched_at, __ATOMIC_RELAXED);
+            time_t start = __atomic_load_n(&segment->start, __ATOMIC_RELAXED);
+            int32_t step = __atomic_load_n(&segment->step, __ATOMIC_RELAXED);
+            int sample_count = __atomic_load_n(&segment->sample_count, __ATOMIC_RELAXED);
+            if (step <= 0 || sample_count < 2 || sample_count > EPHEMERIS_SEGMENT_SAMPLES) {
+                if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != seq) continue;
+                break;
+            }
+            if (!valid || now - fetched_at > EPHEMERIS_ONLINE_MAX_AGE ||
+                timestamp < start || timestamp > start + (time_t)step * (sample_count - 1)) {
+                if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != seq) continue;
+                break;
+            }
+
+            long offset = (long)(timestamp - start);
+            long index_long = offset / step;
+            if (index_long < 0) index_long = 0;
+            if (index_long > sample_count - 2) index_long = sample_count - 2;
+            int index = (int)index_long;
+            double f = (double)(offset - (long)index * step) / step;
+
+            double phase = wrap_lerp(segment->moon_phase[index],
+                                     segment->moon_phase[index + 1], f, 1.0);
+            double out[EPHEMERIS_SEGMENT_BODIES];
+            for (int b = 0; b < EPHEMERIS_SEGMENT_BODIES; b++) {
+                out[b] = wrap_lerp(segment->degree[index][b],
+                                   segment->degree[index + 1][b], f, 360.0);
+            }
+
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq) {
+                continue; /* Raced the writer - retry */
+            }
+
+            *moon_phase = phase;
+            memcpy(degrees, out, sizeof(out));
+            __atomic_fetch_add(&stats.online_hits, 1, __ATOMIC_RELAXED);
+            return 0;
+        }
+    }
+
+    __atomic_fetch_add(&stats.offline_fallbacks, 1, __ATOMIC_RELAXED);
+    return -1;
+}
+
+/**
+ * Snapshot the freshness and latency metrics
+ */
+void ephemeris_online_get_stats(ephemeris_online_stats_t *out) {
+    if (!out) return;
+
+    pthread_mutex_lock(&writer_lock);
+    *out = stats;
+    out->online_hits = __atomic_load_n(&stats.online_hits, __ATOMIC_RELAXED);
+    out->offline_fallbacks = __atomic_load_n(&stats.offline_fallbacks, __ATOMIC_RELAXED);
+    out->coverage_start = 0;
+    out->coverage_end = 0;
+    for (int s = 0; s < 2; s++) {
+        if (!slots[s].valid) continue;
+        time_t start = slots[s].segment.start;
+        time_t end = segment_end(&slots[s].segment);
+        if (out->coverage_start == 0 || start < out->coverage_start) out->coverage_start = start;
+        if (end > out->coverage_end) out->coverage_end = end;
+    }
+    out->prefetch_running = prefetch_running;
+    pthread_mutex_unlock(&writer_lock);
+}
+
+#else /* Freestanding kernel: no sockets or threads - always simulate */
+
+int ephemeris_online_register_source(const ephemeris_source_ops_t *ops) {
+    (void)ops;
+    return -1;
+}
+
+int ephemeris_online_set_source(const char *uri) {
+    (void)uri;
+    return -1;
+}
+
+int ephemeris_online_start(void) {
+    return -1;
+}
+
+int ephemeris_online_stop(void) {
+    return 0;
+}
+
+int ephemeris_online_sync(time_t want) {
+    (void)want;
+    return -1;
+}
+
+int ephemeris_online_lookup(time_t timestamp, double *moon_phase, double *degrees) {
+    (void)timestamp;
+    (void)moon_phase;
+    (void)degrees;
+    return -1;
+}
+
+void ephemeris_online_get_stats(ephemeris_online_stats_t *out) {
+    if (out) memset(out, 0, sizeof(*out));
+}
+
+int ephemeris_segment_parse(const char *text, ephemeris_segment_t *segment) {
+    (void)text;
+    (void)segment;
+    return -1;
+}
+
+#endif /* USERLAND_BUILD */
@@ -0,0 +1,76 @@
+/**
+ * Ephemeris Online Backend - Voices from Afar
+ *
+ * Fetches ephemeris segments from a pluggable source and prefetches
+ * them ahead of the current time on a background thread. Segments are
+ * double-buffered; readers never block on I/O and fall back to the
+ * offline simulation whenever the cache is stale or does not cover
+ * the requested instant.
+ */
+
+#ifndef EPHEMERIS_ONLINE_H
+#define EPHEMERIS_ONLINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ephemeris_provider.h"
+
+/* Samples per segment and bodies per sample */
+#define EPHEMERIS_SEGMENT_SAMPLES 64
+#define EPHEMERIS_SEGMENT_BODIES  10
+
+/* Defaults: prefetch 15 minutes ahead, treat data older than 6h as stale */
+#define EPHEMERIS_ONLINE_LOOKAHEAD  900
+#define EPHEMERIS_ONLINE_MAX_AGE    21600
+#define EPHEMERIS_ONLINE_POLL_MS    1000
+
+/* A run of evenly spaced celestial samples */
+typedef struct {
+    time_t start;               /* Timestamp of the first sample */
+    int32_t step;               /* Seconds between samples */
+    int sample_count;
+    double moon_phase[EPHEMERIS_SEGMENT_SAMPLES];   /* 0.0 = new, 0.5 = full */
+    double degree[EPHEMERIS_SEGMENT_SAMPLES][EPHEMERIS_SEGMENT_BODIES];
+} ephemeris_segment_t;
+
+/* Pluggable segment source, selected by URI scheme ("file:", "unix:") */
+typedef struct {
+    const char *scheme;
+    int (*open)(const char *location, void **handle);
+    int (*fetch)(void *handle, time_t want, ephemeris_segment_t *segment);
+    void (*close)(void *handle);
+} ephemeris_source_ops_t;
+
+/* Freshness and latency metrics */
+typedef struct {
+    uint64_t fetch_count;
+    uint64_t fetch_failures;
+    uint64_t online_hits;       /* Reads served from a cached segment */
+    uint64_t offline_fallbacks; /* Reads that fell back to simulation */
+    uint64_t last_latency_us;
+    uint64_t max_latency_us;
+    time_t last_fetch;          /* Wall-clock time of last good fetch */
+    time_t coverage_start;      /* Earliest instant covered by the cache */
+    time_t coverage_end;        /* Latest instant covered by the cache */
+    bool prefetch_running;
+} ephemeris_online_stats_t;
+
+/* Source management */
+int ephemeris_online_register_source(const ephemeris_source_ops_t *ops);
+int ephemeris_online_set_source(const char *uri);
+
+/* Lifecycle */
+int ephemeris_online_start(void);
+int ephemeris_online_stop(void);
+int ephemeris_online_sync(time_t want);
+
+/* Non-blocking lookup; returns -1 when the caller must use the simulation */
+int ephemeris_online_lookup(time_t timestamp, double *moon_phase, double *degrees);
+
+/* Metrics */
+void ephemeris_online_get_stats(ephemeris_online_stats_t *stats);
+
+/* Segment parsing (shared by the built-in sources) */
+int ephemeris_segment_parse(const char *text, ephemeris_segment_t *segment);
+
+#endif /* EPHEMERIS_ONLINE_H */
@@ -6,6 +6,9 @@
 
 #include "freestanding.h"
 #include "ephemeris_provider.h"
+#include "ephemeris_online.h"
+#include "ephemeris_fixed.h"
+#include "simd.h"
 
 static bool is_online_mode = false;
 static const char* MOON_PHASE_NAMES[] = {
@@ -24,6 +27,48 @@ static const char* ZODIAC_SIGNS[] = {
     "Libra", "Scorpio", "Sagittarius", "Capricorn", "Aquarius", "Pisces"
 };
 
+static const char* PLANET_NAMES[] = {
+    "Sun", "Moon", "Mercury", "Venus", "Mars",
+    "Jupiter", "Saturn", "Uranus", "Neptune", "Pluto"
+};
+
+static const double ORBITAL_PERIODS[] = {
+    365.25, 27.32, 87.97, 224.70, 686.98,
+    4332.59, 10759.22, 30688.5, 60182, 90560
+};
+
+#define PLANET_COUNT EPHEMERIS_PLANET_COUNT
+
+#define SYNODIC_MONTH_SECONDS (29.530588853 * 86400.0)
+#define NUMEROLOGY_CHECK_SECONDS 900 /* Local midnight always falls on a quarter hour */
+
+#ifndef EPHEMERIS_FIXED_POINT
+/* Degrees per second for each body, filled on first ephemeris_state_init() */
+static double step_rates[EPHEMERIS_STEP_LANES];
+static bool step_rates_ready = false;
+
+/* Advance every longitude by its rate and wrap into [0, 360), four at a time */
+SIMD_KERNEL static inline __attribute__((always_inline)) void step_degrees_lanes(double *degree, double dt) {
+    const simd_f64x4 full = {360.0, 360.0, 360.0, 360.0};
+    const simd_f64x4 zero = {0.0, 0.0, 0.0, 0.0};
+    
+    for (int i = 0; i < EPHEMERIS_STEP_LANES; i += SIMD_LANES) {
+        simd_f64x4 lanes = *(simd_f64x4 *)&degree[i] + *(const simd_f64x4 *)&step_rates[i] * dt;
+        lanes -= (simd_f64x4)((simd_i64x4)full & (simd_i64x4)(lanes >= full));
+        lanes += (simd_f64x4)((simd_i64x4)full & (simd_i64x4)(lanes < zero));
+        *(simd_f64x4 *)&degree[i] = lanes;
+    }
+}
+
+SIMD_KERNEL static void step_degrees(double *degree, double dt) {
+    step_degrees_lanes(degree, dt);
+}
+
+SIMD_KERNEL SIMD_AVX static void step_degrees_avx(double *degree, double dt) {
+    step_degrees_lanes(degree, dt);
+}
+#endif
+
 /**
  * Initialize the Ephemeris Provider
  */
@@ -32,7 +77,9 @@ int ephemeris_init(bool online_mode) {
     
     if (online_mode) {
         printf("[ORACLE] Awakening in ONLINE mode - connecting to cosmic sources...\n");
-        printf("[ORACLE] Note: Online mode requires external API (not implemented yet)\n");
+        if (ephemeris_online_start() != 0) {
+            printf("[ORACLE] No prefetch source - readers fall back to simulation\n");
+        }
     } else {
         printf("[ORACLE] Awakening in OFFLINE mode - using deterministic simulation\n");
     }
@@ -44,6 +91,9 @@ int ephemeris_init(bool online_mode) {
  * Shutdown the provider
  */
 int ephemeris_shutdown(void) {
+    if (is_online_mode) {
+        ephemeris_online_stop();
+    }
     printf("[ORACLE] The Oracle sleeps...\n");
     return 0;
 }
@@ -59,6 +109,7 @@ double ephemeris_calculate_moon_phase(time_t timestamp) {
     
     double days_since = difftime(timestamp, known_new_moon) / 86400.0;
     double phase = fmod(days_since, synodic_month) / synodic_month;
+    if (phase < 0.0) phase += 1.0;  /* Before the reference new moon */
     
     return phase; /* 0.0 = new, 0.5 = full */
 }
@@ -86,32 +137,81 @@ int ephemeris_calculate_numerology_day(time_t timestamp) {
     return tm_info->tm_mday;
 }
 
+/**
+ * Fill planet names and zodiac signs from ecliptic degrees
+ */
+static void ephemeris_fill_planets(const double *degrees, celestial_data_t *data) {
+    data->planet_count = PLANET_COUNT;
+    for (int i = 0; i < PLANET_COUNT; i++) {
+        strncpy(data->planets[i].name, PLANET_NAMES[i], sizeof(data->planets[i].name) - 1);
+        data->planets[i].degree = degrees[i];
+        
+        /* Determine zodiac sign (12 signs, 30 degrees each) */
+        int sign_index = ((int)degrees[i] / 30) % 12;
+        strncpy(data->planets[i].sign, ZODIAC_SIGNS[sign_index], 
+                sizeof(data->planets[i].sign) - 1);
+    }
+}
+
 /**
  * Simulate planet positions (deterministic)
  */
 void ephemeris_simulate_planets(time_t timestamp, celestial_data_t *data) {
     /* Simplified planetary motion simulation */
-    const char* planet_names[] = {"Sun", "Moon", "Mercury", "Venus", "Mars", 
-                                   "Jupiter", "Saturn", "Uranus", "Neptune", "Pluto"};
-    const double orbital_periods[] = {365.25, 27.32, 87.97, 224.70, 686.98, 
-                                      4332.59, 10759.22, 30688.5, 60182, 90560};
-    
-    data->planet_count = 10;
-    for (int i = 0; i < 10; i++) {
-        strncpy(data->planets[i].name, planet_names[i], sizeof(data->planets[i].name) - 1);
+    double degrees[PLANET_COUNT];
+    double days_since_epoch = difftime(timestamp, 0) / 86400.0;
+    
+    for (int i = 0; i < PLANET_COUNT; i++) {
+        /* Calculate position based on orbital period; fmod keeps the sign before 1970 */
+        degrees[i] = fmod(days_since_epoch / ORBITAL_PERIODS[i], 1.0) * 360.0;
+        if (degrees[i] < 0.0) degrees[i] += 360.0;
+    }
+    
+    ephemeris_fill_planets(degrees, data);
+}
+
+#ifdef EPHEMERIS_FIXED_POINT
+/**
+ * Fill moon and planets from fixed-point accumulators
+ *
+ * Each accumulator is (seconds * rate) mod 2^64; the top 32 bits are
+ * the angle. sign_cache (may be NULL) skips sign lookups for bodies
+ * that stayed in their sign.
+ */
+static void ephemeris_fixed_apply(uint64_t phase_acc, const uint64_t *body_acc,
+                                  int *sign_cache, celestial_data_t *data) {
+    ephemeris_angle_t phase = (ephemeris_angle_t)(phase_acc >> 32);
+    data->moon_phase = ephemeris_fixed_moon_phase_enum(phase);
+    data->moon_illumination = ephemeris_fixed_illumination(phase) *
+                              (1.0 / EPHEMERIS_FIXED_ONE);
+    
+    data->planet_count = PLANET_COUNT;
+    for (int i = 0; i < PLANET_COUNT; i++) {
+        ephemeris_angle_t longitude = (ephemeris_angle_t)(body_acc[i] >> 32);
+        data->planets[i].degree = ephemeris_fixed_to_degrees(longitude);
         
-        /* Calculate position based on orbital period */
-        double days_since_epoch = difftime(timestamp, 0) / 86400.0;
-        double position = fmod(days_since_epoch / orbital_periods[i], 1.0) * 360.0;
-        data->planets[i].degree = position;
+        int sign_index = ephemeris_fixed_sign_index(longitude);
+        if (sign_cache && sign_cache[i] == sign_index) continue;
+        if (sign_cache) sign_cache[i] = sign_index;
         
-        /* Determine zodiac sign (12 signs, 30 degrees each) */
-        int sign_index = ((int)position / 30) % 12;
-        strncpy(data->planets[i].sign, ZODIAC_SIGNS[sign_index], 
+        strncpy(data->planets[i].name, PLANET_NAMES[i], sizeof(data->planets[i].name) - 1);
+        strncpy(data->planets[i].sign, ZODIAC_SIGNS[sign_index],
                 sizeof(data->planets[i].sign) - 1);
     }
 }
 
+/**
+ * Closed-form fixed-point accumulators at a timestamp
+ */
+static void ephemeris_fixed_accumulate(time_t timestamp, uint64_t *phase_acc,
+                                       uint64_t *body_acc) {
+    *phase_acc = (uint64_t)((int64_t)timestamp - 947182440) * ephemeris_fixed_moon_rate();
+    for (int i = 0; i < PLANET_COUNT; i++) {
+        body_acc[i] = (uint64_t)(int64_t)timestamp * ephemeris_fixed_planet_rate(i);
+    }
+}
+#endif /* EPHEMERIS_FIXED_POINT */
+
 /**
  * Get current celestial data
  */
@@ -128,8 +228,27 @@ int ephemeris_get_data_at_time(time_t timestamp, celestial_data_t *data) {
     
     data->timestamp = timestamp;
     
+    /* Prefer a prefetched online segment; never wait for one */
+    double phase = 0.0;
+    double degrees[PLANET_COUNT];
+    bool from_segment = is_online_mode &&
+                        ephemeris_online_lookup(timestamp, &phase, degrees) == 0;
+    
+#ifdef EPHEMERIS_FIXED_POINT
+    if (!from_segment) {
+        uint64_t phase_acc;
+        uint64_t body_acc[PLANET_COUNT];
+        ephemeris_fixed_accumulate(timestamp, &phase_acc, body_acc);
+        ephemeris_fixed_apply(phase_acc, body_acc, NULL, data);
+        data->numerology_day = ephemeris_calculate_numerology_day(timestamp);
+        return 0;
+    }
+#endif
+    
     /* Calculate moon phase */
-    double phase = ephemeris_calculate_moon_phase(timestamp);
+    if (!from_segment) {
+        phase = ephemeris_calculate_moon_phase(timestamp);
+    }
     data->moon_phase = ephemeris_get_moon_phase_enum(phase);
     
     /* Moon illumination (simplified: full at 0.5, new at 0.0/1.0) */
@@ -139,13 +258,131 @@ int ephemeris_get_data_at_time(time_t timestamp, celestial_data_t *data) {
     data->numerology_day = ephemeris_calculate_numerology_day(timestamp);
     
     /* Planet positions */
-    ephemeris_simulate_planets(timestamp, data);
+    if (from_segment) {
+        ephemeris_fill_planets(degrees, data);
+    } else {
+        ephemeris_simulate_planets(timestamp, data);
+    }
     
     return 0;
 }
 
 /**
- * Sync with online source (stub)
+ * Re-anchor a stepping state to the closed-form result
+ */
+static void ephemeris_state_anchor(ephemeris_state_t *state, time_t timestamp) {
+    ephemeris_get_data_at_time(timestamp, &state->data);
+    
+#ifdef EPHEMERIS_FIXED_POINT
+    ephemeris_fixed_accumulate(timestamp, &state->phase_acc, state->body_acc);
+    for (int i = 0; i < PLANET_COUNT; i++) {
+        state->sign_index[i] = ephemeris_fixed_sign_index(
+            (ephemeris_angle_t)(state->body_acc[i] >> 32));
+    }
+#else
+    state->moon_phase = ephemeris_calculate_moon_phase(timestamp);
+    for (int i = 0; i < PLANET_COUNT; i++) {
+        state->degree[i] = state->data.planets[i].degree;
+        state->sign_index[i] = ((int)state->degree[i] / 30) % 12;
+    }
+#endif
+    
+    state->next_day_check = timestamp - (timestamp % NUMEROLOGY_CHECK_SECONDS) +
+                            NUMEROLOGY_CHECK_SECONDS;
+    state->steps_since_anchor = 0;
+}
+
+/**
+ * Initialize a stepping state at a given time
+ */
+int ephemeris_state_init(ephemeris_state_t *state, time_t timestamp) {
+    if (!state) return -1;
+    
+#ifndef EPHEMERIS_FIXED_POINT
+    if (!step_rates_ready) {
+        for (int i = 0; i < PLANET_COUNT; i++) {
+            step_rates[i] = 360.0 / (ORBITAL_PERIODS[i] * 86400.0);
+        }
+        step_rates_ready = true;
+    }
+#endif
+    
+    memset(state, 0, sizeof(*state));
+    ephemeris_state_anchor(state, timestamp);
+    return 0;
+}
+
+/**
+ * Advance a stepping state by dt seconds
+ *
+ * Positions and phase move by precomputed rates instead of being
+ * recomputed from the epoch; sign names are only looked up again when
+ * a body leaves its 30-degree sign.
+ */
+int ephemeris_step(ephemeris_state_t *state, long dt) {
+    if (!state) return -1;
+    
+    time_t timestamp = state->data.timestamp + dt;
+    
+    /* Online segments are authoritative; long jumps and drift re-anchor */
+    if (is_online_mode || dt > EPHEMERIS_MAX_STEP || dt < -EPHEMERIS_MAX_STEP ||
+        state->steps_since_anchor >= EPHEMERIS_REANCHOR_STEPS) {
+        ephemeris_state_anchor(state, timestamp);
+        return 0;
+    }
+    
+    celestial_data_t *data = &state->data;
+    data->timestamp = timestamp;
+    
+#ifdef EPHEMERIS_FIXED_POINT
+    /* Modular accumulation is exact: identical to the closed form, no drift */
+    state->phase_acc += (uint64_t)(int64_t)dt * ephemeris_fixed_moon_rate();
+    for (int i = 0; i < PLANET_COUNT; i++) {
+        state->body_acc[i] += (uint64_t)(int64_t)dt * ephemeris_fixed_planet_rate(i);
+    }
+    ephemeris_fixed_apply(state->phase_acc, state->body_acc, state->sign_index, data);
+#else
+    /* Wrap into [0, 1) like the closed form, in either direction */
+    double phase = fmod(state->moon_phase + (double)dt / SYNODIC_MONTH_SECONDS, 1.0);
+    if (phase < 0.0) phase += 1.0;
+    if (phase >= 1.0) phase -= 1.0;
+    state->moon_phase = phase;
+    data->moon_phase = ephemeris_get_moon_phase_enum(phase);
+    data->moon_illumination = 1.0 - fabs(phase - 0.5) * 2.0;
+    
+    if (simd_has_avx()) {
+        step_degrees_avx(state->degree, (double)dt);
+    } else {
+        step_degrees(state->degree, (double)dt);
+    }
+    
+    for (int i = 0; i < PLANET_COUNT; i++) {
+        double degree = state->degree[i];
+        data->planets[i].degree = degree;
+        
+        double lower = state->sign_index[i] * 30.0;
+        if (degree < lower || degree >= lower + 30.0) {
+            int sign_index = ((int)degree / 30) % 12;
+            state->sign_index[i] = sign_index;
+            strncpy(data->planets[i].sign, ZODIAC_SIGNS[sign_index],
+                    sizeof(data->planets[i].sign) - 1);
+        }
+    }
+#endif
+    
+    /* The civil day can only change on a quarter-hour boundary */
+    if (dt < 0 || timestamp >= state->next_day_check) {
+        data->numerology_day = ephemeris_calculate_numerology_day(timestamp);
+        state->next_day_check = timestamp - (timestamp % NUMEROLOGY_CHECK_SECONDS) +
+                                NUMEROLOGY_CHECK_SECONDS;
+    }
+    
+    state->steps_since_anchor++;
+    return 0;
+}
+
+/**
+ * Sync with online source - fetch the segment covering now
  */
 int ephemeris_sync_online(void) {
     if (!is_online_mode) {
@@ -154,7 +391,10 @@ int ephemeris_sync_online(void) {
     }
     
     printf("[ORACLE] Synchronizing with cosmic sources...\n");
-    printf("[ORACLE] (Online sync not yet implemented - using offline simulation)\n");
+    if (ephemeris_online_sync(time(NULL)) != 0) {
+        fprintf(stderr, "[ORACLE] Sync failed - using offline simulation\n");
+        return -1;
+    }
     return 0;
 }
 
@@ -167,3 +407,45 @@ const char* ephemeris_moon_phase_name(moon_phase_t phase) {
     }
     return "Unknown";
 }
+
+/**
+ * Get the name of one of the ten simulated planets
+ */
+const char* ephemeris_planet_name(int index) {
+    if (index >= 0 && index < PLANET_COUNT) {
+        return PLANET_NAMES[index];
+    }
+    return "Unknown";
+}
+
+/**
+ * Get the orbital period (days) of one of the ten simulated planets
+ */
+double ephemeris_planet_period(int index) {
+    if (index >= 0 && index < PLANET_COUNT) {
+        return ORBITAL_PERIODS[index];
+    }
+    return 0.0;
+}
+
+/**
+ * Get zodiac sign name
+ */
+const char* ephemeris_sign_name(int index) {
+    if (index >= 0 && index < 12) {
+        return ZODIAC_SIGNS[index];
+    }
+    return "Unknown";
+}
+
+/**
+ * Look up a zodiac sign by name, -1 if unknown
+ */
+int ephemeris_sign_index(const char *name) {
+    for (int i = 0; i < 12; i++) {
+        if (strcmp(ZODIAC_SIGNS[i], name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
@@ -36,16 +36,35 @@ typedef struct {
     double degree;      /* 0-360 degrees */
 } planet_position_t;
 
+/* Sun, Moon, Mercury, Venus, Mars, Jupiter, Saturn, Uranus, Neptune, Pluto */
+#define EPHEMERIS_PLANET_COUNT 10
+
 /* Celestial Data */
 typedef struct {
     time_t timestamp;
     moon_phase_t moon_phase;
     double moon_illumination; /* 0.0 - 1.0 */
     int numerology_day;       /* 1-31 */
-    planet_position_t planets[10]; /* Sun, Moon, Mercury, Venus, Mars, Jupiter, Saturn, Uranus, Neptune, Pluto */
+    planet_position_t planets[EPHEMERIS_PLANET_COUNT];
     int planet_count;
 } celestial_data_t;
 
+/* Incremental stepping between consecutive ticks */
+#define EPHEMERIS_REANCHOR_STEPS 720    /* Closed-form re-anchor every 720 steps (1h of 5s ticks) */
+#define EPHEMERIS_MAX_STEP       86400  /* Larger jumps re-anchor immediately */
+#define EPHEMERIS_STEP_LANES     12     /* Planets padded to whole 4-lane vectors */
+
+typedef struct {
+    celestial_data_t data;      /* Current view, updated in place */
+    double moon_phase;          /* Raw phase: 0.0 = new, 0.5 = full */
+    double degree[EPHEMERIS_STEP_LANES];    /* Longitudes, stepped as vectors */
+    int sign_index[EPHEMERIS_PLANET_COUNT];
+    time_t next_day_check;      /* Next quarter-hour boundary for numerology */
+    uint32_t steps_since_anchor;
+    uint64_t phase_acc;         /* Fixed-point build: moon phase, 2^-64 turns */
+    uint64_t body_acc[EPHEMERIS_PLANET_COUNT];      /* Fixed-point build: longitudes, 2^-64 turns */
+} ephemeris_state_t;
+
 /* Ephemeris Provider Interface */
 int ephemeris_init(bool online_mode);
 int ephemeris_shutdown(void);
@@ -53,9 +72,19 @@ int ephemeris_get_current_data(celestial_data_t *data);
 int ephemeris_get_data_at_time(time_t timestamp, celestial_data_t *data);
 int ephemeris_sync_online(void);
 
+/* Stateful stepping */
+int ephemeris_state_init(ephemeris_state_t *state, time_t timestamp);
+int ephemeris_step(ephemeris_state_t *state, long dt);
+
 /* Helper functions */
 const char* ephemeris_moon_phase_name(moon_phase_t phase);
+const char* ephemeris_planet_name(int index);
+double ephemeris_planet_period(int index);
+const char* ephemeris_sign_name(int index);
+int ephemeris_sign_index(const char *name);
 double ephemeris_calculate_moon_phase(time_t timestamp);
+moon_phase_t ephemeris_get_moon_phase_enum(double phase);
+void ephemeris_simulate_planets(time_t timestamp, celestial_data_t *data);
 int ephemeris_calculate_numerology_day(time_t timestamp);
 
 #endif /* EPHEMERIS_PROVIDER_H */
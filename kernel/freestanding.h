@@ -11,6 +11,7 @@
 /* When building for userland tools, use standard headers */
 #ifdef USERLAND_BUILD
 
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -30,6 +31,9 @@
 /* String functions */
 #include "hal/kstring.h"
 
+/* Heap */
+#include "kmem.h"
+
 /* Console I/O */
 #include "hal/kprintf.h"
 #include "hal/timer.h"
@@ -41,6 +45,7 @@
 
 /* snprintf implementation for freestanding */
 int snprintf(char *str, size_t size, const char *format, ...);
+int vsnprintf(char *str, size_t size, const char *format, va_list args);
 
 /* Time functions - stub implementations */
 typedef long time_t;
@@ -58,6 +63,87 @@ static inline double fabs(double x) {
     return (x < 0.0) ? -x : x;
 }
 
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static inline double sqrt(double x) {
+    if (x <= 0.0) return 0.0;
+    double r;
+#ifdef __SSE2_MATH__
+    __asm__ ("sqrtsd %1, %0" : "=x"(r) : "x"(x));
+#else
+    __asm__ ("fsqrt" : "=t"(r) : "0"(x));
+#endif
+    return r;
+}
+
+static inline double sin(double x) {
+    /* Reduce to [-pi/2, pi/2], then Taylor series to x^17 */
+    x = fmod(x, 2.0 * M_PI);
+    if (x > M_PI) x -= 2.0 * M_PI;
+    if (x < -M_PI) x += 2.0 * M_PI;
+    if (x > M_PI / 2) x = M_PI - x;
+    if (x < -M_PI / 2) x = -M_PI - x;
+
+    double x2 = x * x;
+    double term = x;
+    double sum = x;
+    for (int n = 1; n <= 8; n++) {
+        term *= -x2 / (double)((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+static inline double cos(double x) {
+    return sin(x + M_PI / 2);
+}
+
+static inline double tan(double x) {
+    return sin(x) / cos(x);
+}
+
+static inline double atan(double x) {
+    /* atan(x) = pi/2 - atan(1/x), then shift by pi/6 into |x| <= tan(pi/12) */
+    bool negate = x < 0.0;
+    bool invert = false;
+    bool shift = false;
+    if (negate) x = -x;
+    if (x > 1.0) {
+        x = 1.0 / x;
+        invert = true;
+    }
+    if (x > 0.2679491924311227) {
+        x = (x * 1.7320508075688772 - 1.0) / (1.7320508075688772 + x);
+        shift = true;
+    }
+
+    double x2 = x * x;
+    double term = x;
+    double sum = x;
+    for (int n = 1; n <= 10; n++) {
+        term *= -x2;
+        sum += term / (double)(2 * n + 1);
+    }
+
+    if (shift) sum += M_PI / 6;
+    if (invert) sum = M_PI / 2 - sum;
+    return negate ? -sum : sum;
+}
+
+static inline double atan2(double y, double x) {
+    if (x > 0.0) return atan(y / x);
+    if (x < 0.0) return (y >= 0.0) ? atan(y / x) + M_PI : atan(y / x) - M_PI;
+    if (y > 0.0) return M_PI / 2;
+    if (y < 0.0) return -M_PI / 2;
+    return 0.0;
+}
+
+static inline double asin(double x) {
+    return atan2(x, sqrt(1.0 - x * x));
+}
+
 /* Basic tm structure */
 struct tm {
     int tm_sec;    /* seconds */
@@ -99,8 +185,8 @@ static inline struct tm *localtime(const time_t *timep) {
 
 /* No-op stubs for functions not needed in freestanding */
 #define sleep(x) delay_ms((x) * 1000)
-#define malloc(x) ((void*)0)
-#define free(x) ((void)0)
+#define malloc(x) kmalloc(x)
+#define free(x) kfree(x)
 #define exit(x) while(1) { __asm__ volatile ("hlt"); }
 
 #endif /* USERLAND_BUILD */
@@ -0,0 +1,194 @@
+/**
+ * SpiritOS Hardware Abstraction Layer - ACPI Tables Implementation
+ */
+
+#include "acpi.h"
+#include "multiboot.h"
+#include "kprintf.h"
+#include "kstring.h"
+
+#define EBDA_SEGMENT_PTR    0x40E       /* BIOS data area: EBDA segment */
+#define BIOS_AREA_START     0xE0000
+#define BIOS_AREA_END       0x100000
+
+#define MADT_PCAT_COMPAT    (1u << 0)
+#define MADT_LAPIC          0
+#define MADT_IOAPIC         1
+#define MADT_ISA_OVERRIDE   2
+#define MADT_LAPIC_ADDRESS  5
+#define LAPIC_ENABLED       (1u << 0)
+
+typedef struct __attribute__((packed)) {
+    char signature[8];              /* "RSD PTR " */
+    uint8_t checksum;
+    char oem_id[6];
+    uint8_t revision;               /* 0: ACPI 1.0, 2: XSDT fields follow */
+    uint32_t rsdt_address;
+    uint32_t length;
+    uint64_t xsdt_address;
+    uint8_t extended_checksum;
+    uint8_t reserved[3];
+} acpi_rsdp_t;
+
+typedef struct __attribute__((packed)) {
+    char signature[4];
+    uint32_t length;                /* Header included */
+    uint8_t revision;
+    uint8_t checksum;
+    char oem_id[6];
+    char oem_table_id[8];
+    uint32_t oem_revision;
+    uint32_t creator_id;
+    uint32_t creator_revision;
+} acpi_header_t;
+
+typedef struct __attribute__((packed)) {
+    acpi_header_t header;
+    uint32_t lapic_address;
+    uint32_t flags;
+} acpi_madt_header_t;
+
+static bool checksum_ok(const void *table, uint32_t length) {
+    const uint8_t *bytes = (const uint8_t *)table;
+    uint8_t sum = 0;
+    for (uint32_t i = 0; i < length; i++) {
+        sum += bytes[i];
+    }
+    return sum == 0;
+}
+
+/* The RSDP sits on a 16-byte boundary; only the 1.0 part is checksummed here */
+static const acpi_rsdp_t *rsdp_scan(uintptr_t start, uintptr_t end) {
+    for (uintptr_t address = start; address + 20 <= end; address += 16) {
+        const acpi_rsdp_t *rsdp = (const acpi_rsdp_t *)address;
+        if (memcmp(rsdp->signature, "RSD PTR ", 8) == 0 && checksum_ok(rsdp, 20)) {
+            return rsdp;
+        }
+    }
+    return NULL;
+}
+
+static const acpi_rsdp_t *rsdp_find(uint32_t multiboot_magic, uint32_t multiboot_addr) {
+    /* The loader's copy, the newer revision first */
+    if (multiboot_magic == MULTIBOOT2_BOOTLOADER_MAGIC) {
+        const multiboot_info_t *info = (const multiboot_info_t *)(uintptr_t)multiboot_addr;
+        const uint8_t *info_end = (const uint8_t *)info + info->total_size;
+        const acpi_rsdp_t *found = NULL;
+        for (const multiboot_tag_t *tag = multiboot_first_tag(info);
+             (const uint8_t *)tag < info_end && tag->type != MULTIBOOT_TAG_END;
+             tag = multiboot_next_tag(tag)) {
+            if (tag->type == MULTIBOOT_TAG_ACPI_NEW) {
+                return (const acpi_rsdp_t *)((const multiboot_tag_acpi_t *)tag)->rsdp;
+            }
+            if (tag->type == MULTIBOOT_TAG_ACPI_OLD) {
+                found = (const acpi_rsdp_t *)((const multiboot_tag_acpi_t *)tag)->rsdp;
+            }
+        }
+        if (found) return found;
+    }
+    
+    /* First KiB of the EBDA, then the BIOS read-only area */
+    uintptr_t ebda = (uintptr_t)(*(const volatile uint16_t *)EBDA_SEGMENT_PTR) << 4;
+    const acpi_rsdp_t *rsdp = ebda ? rsdp_scan(ebda, ebda + 1024) : NULL;
+    return rsdp ? rsdp : rsdp_scan(BIOS_AREA_START, BIOS_AREA_END);
+}
+
+/* Tables above 4 GiB are out of reach and skipped */
+static const acpi_header_t *table_at(uint64_t address, const char *signature) {
+    if (address == 0 || address >= 0x100000000ULL) return NULL;
+    const acpi_header_t *table = (const acpi_header_t *)(uintptr_t)address;
+    if (memcmp(table->signature, signature, 4) != 0) return NULL;
+    if (table->length < sizeof(*table) || !checksum_ok(table, table->length)) return NULL;
+    return table;
+}
+
+static const acpi_header_t *madt_find(const acpi_rsdp_t *rsdp) {
+    const acpi_header_t *root = NULL;
+    uint32_t entry_size = 4;
+    if (rsdp->revision >= 2 && checksum_ok(rsdp, rsdp->length)) {
+        root = table_at(rsdp->xsdt_address, "XSDT");
+        entry_size = 8;
+    }
+    if (!root) {
+        root = table_at(rsdp->rsdt_address, "RSDT");
+        entry_size = 4;
+    }
+    if (!root) return NULL;
+    
+    const uint8_t *entries = (const uint8_t *)(root + 1);
+    uint32_t count = (root->length - sizeof(*root)) / entry_size;
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t address;
+        if (entry_size == 8) {
+            memcpy(&address, entries + i * 8, 8);
+        } else {
+            uint32_t address32;
+            memcpy(&address32, entries + i * 4, 4);
+            address = address32;
+        }
+        const acpi_header_t *table = table_at(address, "APIC");
+        if (table) return table;
+    }
+    return NULL;
+}
+
+int acpi_read_madt(uint32_t multiboot_magic, uint32_t multiboot_addr, acpi_madt_t *madt) {
+    memset(madt, 0, sizeof(*madt));
+    for (uint32_t irq = 0; irq < 16; irq++) {
+        madt->isa_gsi[irq] = irq;   /* Identity unless overridden */
+    }
+    
+    const acpi_rsdp_t *rsdp = rsdp_find(multiboot_magic, multiboot_addr);
+    if (!rsdp) {
+        kprintf("[ACPI] No RSDP\n");
+        return -1;
+    }
+    const acpi_header_t *table = madt_find(rsdp);
+    if (!table || table->length < sizeof(acpi_madt_header_t)) {
+        kprintf("[ACPI] No MADT\n");
+        return -1;
+    }
+    
+    const acpi_madt_header_t *header = (const acpi_madt_header_t *)table;
+    madt->lapic_address = header->lapic_address;
+    madt->legacy_pics = (header->flags & MADT_PCAT_COMPAT) != 0;
+    
+    /* Entries: type, length, then the body */
+    const uint8_t *entry = (const uint8_t *)(header + 1);
+    const uint8_t *end = (const uint8_t *)table + table->length;
+    while (entry + 2 <= end && entry[1] >= 2 && entry + entry[1] <= end) {
+        switch (entry[0]) {
+            case MADT_LAPIC: {
+                uint32_t flags;
+                memcpy(&flags, entry + 4, 4);
+                if ((flags & LAPIC_ENABLED) && madt->cpu_count < ACPI_MAX_CPUS) {
+                    madt->cpu_apic_ids[madt->cpu_count++] = entry[3];
+                }
+                break;
+            }
+            case MADT_IOAPIC:
+                if (madt->ioapic_address == 0) {
+                    memcpy(&madt->ioapic_address, entry + 4, 4);
+                    memcpy(&madt->ioapic_gsi_base, entry + 8, 4);
+                }
+                break;
+            case MADT_ISA_OVERRIDE:
+                if (entry[3] < 16) {
+                    memcpy(&madt->isa_gsi[entry[3]], entry + 4, 4);
+                    memcpy(&madt->isa_flags[entry[3]], entry + 8, 2);
+                }
+                break;
+            case MADT_LAPIC_ADDRESS: {
+                uint64_t address;
+                memcpy(&address, entry + 4, 8);
+                if (address < 0x100000000ULL) madt->lapic_address = (uint32_t)address;
+                break;
+            }
+        }
+        entry += entry[1];
+    }
+    
+    kprintf("[ACPI] MADT: %u CPUs, local APIC at 0x%x, I/O APIC at 0x%x\n",
+            madt->cpu_count, madt->lapic_address, madt->ioapic_address);
+    return 0;
+}
@@ -0,0 +1,32 @@
+/**
+ * SpiritOS Hardware Abstraction Layer - ACPI Tables
+ *
+ * Just enough ACPI to start the other CPUs: find the RSDP (from the
+ * boot loader, else the BIOS areas), walk the RSDT or XSDT to the MADT
+ * and read the local APICs, the I/O APIC and the ISA overrides from it.
+ * Tables are read in place; the kernel maps the low 4 GiB 1:1.
+ */
+
+#ifndef ACPI_H
+#define ACPI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ACPI_MAX_CPUS       32      /* Enabled local APICs kept from the MADT */
+
+typedef struct {
+    uint32_t lapic_address;
+    uint32_t ioapic_address;        /* The first I/O APIC; 0 if none */
+    uint32_t ioapic_gsi_base;
+    uint32_t cpu_count;
+    uint8_t cpu_apic_ids[ACPI_MAX_CPUS];
+    uint32_t isa_gsi[16];           /* ISA IRQ -> global system interrupt */
+    uint16_t isa_flags[16];         /* MPS INTI polarity and trigger bits */
+    bool legacy_pics;               /* PCAT_COMPAT: 8259s are present */
+} acpi_madt_t;
+
+/* Read the MADT; -1 if there is no ACPI or no MADT */
+int acpi_read_madt(uint32_t multiboot_magic, uint32_t multiboot_addr, acpi_madt_t *madt);
+
+#endif /* ACPI_H */
@@ -0,0 +1,207 @@
+/**
+ * SpiritOS Hardware Abstraction Layer - Local and I/O APIC Implementation
+ *
+ * Both are memory-mapped (xAPIC mode, not x2APIC) at the addresses the
+ * MADT gives; the kernel sees physical memory below 4 GiB as is.
+ */
+
+#include <stddef.h>
+#include "apic.h"
+#include "interrupts.h"
+#include "timer.h"
+#include "kprintf.h"
+#include "../sync.h"
+
+/* Local APIC registers, byte offsets */
+#define LAPIC_ID            0x020
+#define LAPIC_TPR           0x080
+#define LAPIC_EOI           0x0B0
+#define LAPIC_SVR           0x0F0
+#define LAPIC_ICR_LOW       0x300
+#define LAPIC_ICR_HIGH      0x310
+#define LAPIC_LVT_TIMER     0x320
+#define LAPIC_LVT_ERROR     0x370
+#define LAPIC_TIMER_INITIAL 0x380
+#define LAPIC_TIMER_CURRENT 0x390
+#define LAPIC_TIMER_DIVIDE  0x3E0
+
+#define SVR_ENABLE          (1u << 8)
+#define LVT_MASKED          (1u << 16)
+#define TIMER_DIVIDE_16     0x3
+#define ICR_FIXED           0x000
+#define ICR_INIT            0x500
+#define ICR_STARTUP         0x600
+#define ICR_ASSERT          (1u << 14)
+#define ICR_PENDING         (1u << 12)
+
+#define APIC_BASE_MSR       0x1B
+#define APIC_BASE_ENABLE    (1u << 11)
+
+#define CALIBRATE_MS        10
+
+/* I/O APIC: an index register and a data window */
+#define IOAPIC_SELECT       0x00
+#define IOAPIC_WINDOW       0x10
+#define IOAPIC_REDIRECT     0x10        /* Two registers per input */
+#define REDIRECT_ACTIVE_LOW (1u << 13)
+#define REDIRECT_LEVEL      (1u << 15)
+#define REDIRECT_MASKED     (1u << 16)
+#define INTI_POLARITY_LOW   0x3
+#define INTI_TRIGGER_LEVEL  (0x3 << 2)
+
+static volatile uint32_t *lapic = NULL;
+static volatile uint32_t *ioapic = NULL;
+static uint32_t ioapic_gsi_base = 0;
+static uint32_t isa_gsi[16];
+static uint16_t isa_flags[16];
+static uint32_t redirect_low[16];       /* As last written, for masking */
+static uint8_t boot_apic_id = 0;
+static uint32_t timer_per_ms = 0;       /* Timer counts per millisecond */
+static spinlock_t ioapic_lock = SPINLOCK_INIT;
+
+static inline uint32_t lapic_read(uint32_t reg) {
+    return lapic[reg / 4];
+}
+
+static inline void lapic_write(uint32_t reg, uint32_t value) {
+    lapic[reg / 4] = value;
+}
+
+static inline void ioapic_write(uint32_t reg, uint32_t value) {
+    ioapic[IOAPIC_SELECT / 4] = reg;
+    ioapic[IOAPIC_WINDOW / 4] = value;
+}
+
+static void apic_enable_msr(void) {
+    uint32_t low, high;
+    __asm__ volatile ("rdmsr" : "=a"(low), "=d"(high) : "c"(APIC_BASE_MSR));
+    if (!(low & APIC_BASE_ENABLE)) {
+        low |= APIC_BASE_ENABLE;
+        __asm__ volatile ("wrmsr" : : "a"(low), "d"(high), "c"(APIC_BASE_MSR));
+    }
+}
+
+/* Accept everything, with the timer stopped until armed */
+static void lapic_setup(void) {
+    apic_enable_msr();
+    lapic_write(LAPIC_TPR, 0);
+    lapic_write(LAPIC_SVR, SVR_ENABLE | INTERRUPT_APIC_SPURIOUS);
+    lapic_write(LAPIC_LVT_ERROR, LVT_MASKED);
+    lapic_write(LAPIC_TIMER_DIVIDE, TIMER_DIVIDE_16);
+    lapic_write(LAPIC_LVT_TIMER, LVT_MASKED);
+    lapic_write(LAPIC_TIMER_INITIAL, 0);
+}
+
+static void icr_send(uint8_t apic_id, uint32_t command) {
+    while (lapic_read(LAPIC_ICR_LOW) & ICR_PENDING) {
+        __asm__ volatile ("pause");
+    }
+    lapic_write(LAPIC_ICR_HIGH, (uint32_t)apic_id << 24);
+    lapic_write(LAPIC_ICR_LOW, command);
+}
+
+/**
+ * Enable the boot CPU's local APIC
+ *
+ * The I/O APIC inputs are left masked until interrupts_use_apic routes
+ * the ISA lines.
+ */
+int apic_init(const acpi_madt_t *madt) {
+    if (!madt->lapic_address || !madt->ioapic_address || !timer_tsc_khz()) {
+        return -1;
+    }
+    
+    lapic = (volatile uint32_t *)(uintptr_t)madt->lapic_address;
+    ioapic = (volatile uint32_t *)(uintptr_t)madt->ioapic_address;
+    ioapic_gsi_base = madt->ioapic_gsi_base;
+    for (int irq = 0; irq < 16; irq++) {
+        isa_gsi[irq] = madt->isa_gsi[irq];
+        isa_flags[irq] = madt->isa_flags[irq];
+    }
+    
+    lapic_setup();
+    boot_apic_id = apic_id();
+    
+    /* Count down from the top for CALIBRATE_MS of TSC time */
+    lapic_write(LAPIC_TIMER_INITIAL, 0xFFFFFFFF);
+    delay_ms(CALIBRATE_MS);
+    uint32_t elapsed = 0xFFFFFFFF - lapic_read(LAPIC_TIMER_CURRENT);
+    lapic_write(LAPIC_TIMER_INITIAL, 0);
+    timer_per_ms = elapsed / CALIBRATE_MS;
+    if (timer_per_ms == 0) timer_per_ms = 1;
+    
+    kprintf("[APIC] Local APIC %u, timer at %u counts/ms\n", boot_apic_id, timer_per_ms);
+    return 0;
+}
+
+void apic_init_cpu(void) {
+    lapic_setup();
+}
+
+bool apic_enabled(void) {
+    return lapic != NULL;
+}
+
+uint8_t apic_id(void) {
+    return (uint8_t)(lapic_read(LAPIC_ID) >> 24);
+}
+
+void apic_eoi(void) {
+    lapic_write(LAPIC_EOI, 0);
+}
+
+void apic_send_ipi(uint8_t apic_id, uint8_t vector) {
+    icr_send(apic_id, ICR_FIXED | ICR_ASSERT | vector);
+}
+
+void apic_send_init(uint8_t apic_id) {
+    icr_send(apic_id, ICR_INIT | ICR_ASSERT);
+}
+
+void apic_send_startup(uint8_t apic_id, uint8_t page) {
+    icr_send(apic_id, ICR_STARTUP | ICR_ASSERT | page);
+}
+
+void apic_timer_set_deadline(uint64_t tick) {
+    uint64_t now = timer_get_ticks();
+    uint64_t count = timer_per_ms;
+    if (tick > now) {
+        count = (tick - now) * timer_per_ms;
+    }
+    
+    /* Longer waits fire early; the handler just arms again */
+    if (count > 0xFFFFFFFF) count = 0xFFFFFFFF;
+    lapic_write(LAPIC_LVT_TIMER, INTERRUPT_APIC_TIMER);
+    lapic_write(LAPIC_TIMER_INITIAL, (uint32_t)count);
+}
+
+void ioapic_route(uint8_t irq, uint8_t vector, bool masked) {
+    if (irq >= 16 || !ioapic) return;
+    
+    /* ISA lines are edge triggered and active high unless overridden */
+    uint32_t low = vector;
+    if ((isa_flags[irq] & INTI_POLARITY_LOW) == INTI_POLARITY_LOW) low |= REDIRECT_ACTIVE_LOW;
+    if ((isa_flags[irq] & INTI_TRIGGER_LEVEL) == INTI_TRIGGER_LEVEL) low |= REDIRECT_LEVEL;
+    if (masked) low |= REDIRECT_MASKED;
+    
+    uint32_t input = isa_gsi[irq] - ioapic_gsi_base;
+    unsigned long flags = spin_lock(&ioapic_lock);
+    redirect_low[irq] = low;
+    ioapic_write(IOAPIC_REDIRECT + input * 2 + 1, (uint32_t)boot_apic_id << 24);
+    ioapic_write(IOAPIC_REDIRECT + input * 2, low);
+    spin_unlock(&ioapic_lock, flags);
+}
+
+void ioapic_set_masked(uint8_t irq, bool masked) {
+    if (irq >= 16 || !ioapic || !redirect_low[irq]) return;
+    
+    uint32_t input = isa_gsi[irq] - ioapic_gsi_base;
+    unsigned long flags = spin_lock(&ioapic_lock);
+    if (masked) {
+        redirect_low[irq] |= REDIRECT_MASKED;
+    } else {
+        redirect_low[irq] &= ~REDIRECT_MASKED;
+    }
+    ioapic_write(IOAPIC_REDIRECT + input * 2, redirect_low[irq]);
+    spin_unlock(&ioapic_lock, flags);
+}
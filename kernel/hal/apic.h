@@ -0,0 +1,46 @@
+/**
+ * SpiritOS Hardware Abstraction Layer - Local and I/O APIC
+ *
+ * Each CPU has a local APIC: it takes interrupts, sends IPIs to the
+ * other CPUs and has a timer of its own. The I/O APIC routes device
+ * IRQs in place of the 8259 PICs; every ISA line goes to the boot CPU.
+ * Only used once smp_init has found more than one CPU.
+ */
+
+#ifndef APIC_H
+#define APIC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "acpi.h"
+
+/* Enable the boot CPU's local APIC and calibrate its timer against the TSC */
+int apic_init(const acpi_madt_t *madt);
+
+/* Enable the calling CPU's local APIC; on each application processor */
+void apic_init_cpu(void);
+
+/* apic_init has run */
+bool apic_enabled(void);
+
+/* The calling CPU's local APIC ID */
+uint8_t apic_id(void);
+
+/* Acknowledge the interrupt in service */
+void apic_eoi(void);
+
+/* Send a fixed interrupt to another CPU */
+void apic_send_ipi(uint8_t apic_id, uint8_t vector);
+
+/* Startup: INIT, then a STARTUP pointing the CPU at page << 12 */
+void apic_send_init(uint8_t apic_id);
+void apic_send_startup(uint8_t apic_id, uint8_t page);
+
+/* One-shot timer interrupt at (or before) this tick, on this CPU */
+void apic_timer_set_deadline(uint64_t tick);
+
+/* Route an ISA IRQ, through its MADT override, to the boot CPU */
+void ioapic_route(uint8_t irq, uint8_t vector, bool masked);
+void ioapic_set_masked(uint8_t irq, bool masked);
+
+#endif /* APIC_H */
@@ -0,0 +1,261 @@
+/**
+ * SpiritOS Hardware Abstraction Layer - FPU/SSE/AVX State
+ *
+ * Whose state is in the registers (owner) and whose thread is running
+ * (current) are tracked apart, per CPU. While they differ CR0.TS is
+ * set, so the first FPU instruction traps and the registers change
+ * hands then. Each CPU only ever touches its own slot.
+ */
+
+#include "fpu.h"
+#include "interrupts.h"
+#include "kprintf.h"
+#include "kstring.h"
+#include "../smp.h"
+
+#define FPU_NM_VECTOR       7           /* Device not available */
+#define FXSAVE_SIZE         512
+#define MXCSR_DEFAULT       0x1F80      /* All SIMD exceptions masked */
+
+#define CR0_TS              (1u << 3)
+#define CR4_OSXSAVE         (1u << 18)
+#define CPUID_ECX_XSAVE     (1u << 26)
+#define CPUID_ECX_AVX       (1u << 28)
+#define XCR0_X87            (1u << 0)
+#define XCR0_SSE            (1u << 1)
+#define XCR0_AVX            (1u << 2)
+
+typedef struct {
+    fpu_context_t idle;             /* The CPU's boot or idle thread */
+    fpu_context_t *owner;
+    fpu_context_t *current;
+    bool ts_set;
+    uint64_t traps;
+    uint64_t saves;
+    uint64_t restores;
+} fpu_cpu_t;
+
+static fpu_cpu_t cpus[SMP_MAX_CPUS];
+static fpu_context_t clean_context;     /* What a thread starts from */
+static uint32_t xsave_mask = 0;
+static fpu_stats_t stats;               /* Features; counters live per CPU */
+
+static inline void cpuid(uint32_t leaf, uint32_t subleaf,
+                         uint32_t *eax, uint32_t *ebx, uint32_t *ecx, uint32_t *edx) {
+    __asm__ volatile ("cpuid"
+                      : "=a"(*eax), "=b"(*ebx), "=c"(*ecx), "=d"(*edx)
+                      : "a"(leaf), "c"(subleaf));
+}
+
+static inline unsigned long read_cr0(void) {
+    unsigned long value;
+    __asm__ volatile ("mov %%cr0, %0" : "=r"(value));
+    return value;
+}
+
+static inline void write_cr0(unsigned long value) {
+    __asm__ volatile ("mov %0, %%cr0" : : "r"(value) : "memory");
+}
+
+static inline unsigned long read_cr4(void) {
+    unsigned long value;
+    __asm__ volatile ("mov %%cr4, %0" : "=r"(value));
+    return value;
+}
+
+static inline void write_cr4(unsigned long value) {
+    __asm__ volatile ("mov %0, %%cr4" : : "r"(value) : "memory");
+}
+
+static inline void xsetbv(uint32_t index, uint32_t value) {
+    __asm__ volatile ("xsetbv" : : "c"(index), "a"(value), "d"(0) : "memory");
+}
+
+static void state_save(fpu_context_t *ctx) {
+    if (stats.xsave) {
+        __asm__ volatile ("xsave %0" : "+m"(ctx->area) : "a"(xsave_mask), "d"(0) : "memory");
+    } else {
+        __asm__ volatile ("fxsave %0" : "=m"(ctx->area) : : "memory");
+    }
+}
+
+static void state_restore(const fpu_context_t *ctx) {
+    if (stats.xsave) {
+        __asm__ volatile ("xrstor %0" : : "m"(ctx->area), "a"(xsave_mask), "d"(0) : "memory");
+    } else {
+        __asm__ volatile ("fxrstor %0" : : "m"(ctx->area) : "memory");
+    }
+}
+
+static void set_ts(fpu_cpu_t *cpu, bool on) {
+    if (on == cpu->ts_set) return;
+    if (on) {
+        write_cr0(read_cr0() | CR0_TS);
+    } else {
+        __asm__ volatile ("clts" ::: "memory");
+    }
+    cpu->ts_set = on;
+}
+
+/* #NM: the running thread wants the registers; hand them over */
+static interrupt_frame_t *fpu_trap(interrupt_frame_t *frame) {
+    fpu_cpu_t *cpu = &cpus[smp_cpu_index()];
+    set_ts(cpu, false);
+    cpu->traps++;
+    if (cpu->owner == cpu->current) {
+        return frame;
+    }
+    
+    if (cpu->owner) {
+        state_save(cpu->owner);
+        cpu->saves++;
+    }
+    if (cpu->current->used) {
+        state_restore(cpu->current);
+        cpu->restores++;
+    } else {
+        state_restore(&clean_context);
+        cpu->current->used = true;
+    }
+    cpu->owner = cpu->current;
+    return frame;
+}
+
+/* XSAVE and AVX as far as the CPU has them; true if XSAVE is on */
+static bool enable_xsave(uint32_t *mask) {
+    uint32_t eax, ebx, ecx, edx;
+    cpuid(1, 0, &eax, &ebx, &ecx, &edx);
+    if (!(ecx & CPUID_ECX_XSAVE)) return false;
+    
+    *mask = XCR0_X87 | XCR0_SSE;
+    if (ecx & CPUID_ECX_AVX) *mask |= XCR0_AVX;
+    write_cr4(read_cr4() | CR4_OSXSAVE);
+    xsetbv(0, *mask);
+    return true;
+}
+
+/* The calling thread keeps its registers as the CPU's idle context */
+static void adopt_idle(fpu_cpu_t *cpu) {
+    set_ts(cpu, false);
+    state_save(&cpu->idle);
+    cpu->idle.used = true;
+    cpu->owner = &cpu->idle;
+    cpu->current = &cpu->idle;
+}
+
+/**
+ * Enable XSAVE and AVX where present and take over #NM
+ */
+void fpu_init(void) {
+    uint32_t eax, ebx, ecx, edx;
+    uint32_t mask;
+    
+    memset(&stats, 0, sizeof(stats));
+    memset(cpus, 0, sizeof(cpus));
+    stats.state_size = FXSAVE_SIZE;
+    
+    if (enable_xsave(&mask)) {
+        /* EBX: the save area size for the features now in XCR0 */
+        cpuid(0xD, 0, &eax, &ebx, &ecx, &edx);
+        if (ebx <= FPU_STATE_SIZE) {
+            xsave_mask = mask;
+            stats.xsave = true;
+            stats.avx = (mask & XCR0_AVX) != 0;
+            stats.state_size = ebx;
+        } else {
+            xsetbv(0, XCR0_X87 | XCR0_SSE);
+        }
+    }
+    
+    /* The boot thread keeps its registers; everyone else starts clean */
+    fpu_cpu_t *cpu = &cpus[0];
+    adopt_idle(cpu);
+    uint32_t mxcsr = MXCSR_DEFAULT;
+    __asm__ volatile ("fninit; ldmxcsr %0" : : "m"(mxcsr));
+    state_save(&clean_context);
+    state_restore(&cpu->idle);
+    
+    interrupts_set_handler(FPU_NM_VECTOR, fpu_trap);
+    
+    kprintf("[FPU] SSE on, %s, %u-byte state switched lazily\n",
+            stats.avx ? "XSAVE with AVX" : (stats.xsave ? "XSAVE" : "FXSAVE"),
+            stats.state_size);
+}
+
+/**
+ * Give an application processor the boot CPU's XSAVE setup
+ *
+ * The trampoline has already turned SSE on.
+ */
+void fpu_init_cpu(void) {
+    uint32_t mask;
+    if (stats.xsave) {
+        enable_xsave(&mask);
+    }
+    
+    uint32_t mxcsr = MXCSR_DEFAULT;
+    __asm__ volatile ("fninit; ldmxcsr %0" : : "m"(mxcsr));
+    adopt_idle(&cpus[smp_cpu_index()]);
+}
+
+/**
+ * Switch to another thread's state (NULL for this CPU's idle thread)
+ *
+ * Nothing is saved or loaded here; CR0.TS defers that to the thread's
+ * first FPU instruction, if it ever executes one.
+ */
+void fpu_switch(fpu_context_t *ctx) {
+    fpu_cpu_t *cpu = &cpus[smp_cpu_index()];
+    cpu->current = ctx ? ctx : &cpu->idle;
+    set_ts(cpu, cpu->current != cpu->owner);
+}
+
+/**
+ * Drop a thread's state; its context can be reused by a new thread
+ */
+void fpu_release(fpu_context_t *ctx) {
+    if (!ctx) return;
+    fpu_cpu_t *cpu = &cpus[smp_cpu_index()];
+    if (cpu->owner == ctx) cpu->owner = NULL;
+    ctx->used = false;
+}
+
+/**
+ * Save registers held for a thread that is not running here
+ *
+ * Its state is then in memory and the thread can move to another CPU.
+ */
+void fpu_park(void) {
+    fpu_cpu_t *cpu = &cpus[smp_cpu_index()];
+    if (!cpu->owner || cpu->owner == cpu->current) return;
+    
+    set_ts(cpu, false);
+    state_save(cpu->owner);
+    cpu->saves++;
+    cpu->owner = NULL;
+    set_ts(cpu, true);
+}
+
+/**
+ * Some CPU holds ctx's registers unsaved
+ */
+bool fpu_live(const fpu_context_t *ctx) {
+    for (int i = 0; i < SMP_MAX_CPUS; i++) {
+        if (cpus[i].owner == ctx) return true;
+    }
+    return false;
+}
+
+bool fpu_has_avx(void) {
+    return stats.avx;
+}
+
+void fpu_get_stats(fpu_stats_t *out) {
+    if (!out) return;
+    *out = stats;
+    for (int i = 0; i < SMP_MAX_CPUS; i++) {
+        out->traps += cpus[i].traps;
+        out->saves += cpus[i].saves;
+        out->restores += cpus[i].restores;
+    }
+}
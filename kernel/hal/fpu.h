@@ -0,0 +1,64 @@
+/**
+ * SpiritOS Hardware Abstraction Layer - FPU/SSE/AVX State
+ *
+ * The boot stub turns SSE on; fpu_init adds XSAVE and AVX when the CPU
+ * has them. Register state is switched lazily: a thread switch only
+ * sets CR0.TS, and the first FPU or SIMD instruction after it traps
+ * (#NM) to save the previous owner and load the new thread's state.
+ * Threads that never touch the FPU never pay for it.
+ *
+ * Interrupt handlers must not use floating point or SIMD registers:
+ * they run on whatever state the interrupted thread left loaded.
+ *
+ * Each CPU switches lazily on its own. A thread whose registers are
+ * still live on one CPU cannot run on another until they are saved;
+ * see fpu_live and fpu_park.
+ */
+
+#ifndef FPU_H
+#define FPU_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FPU_STATE_SIZE      1024    /* x87 + SSE + AVX is 832 bytes */
+
+/* One thread's saved registers */
+typedef struct {
+    uint8_t area[FPU_STATE_SIZE] __attribute__((aligned(64)));
+    bool used;                      /* Has state worth restoring */
+} fpu_context_t;
+
+typedef struct {
+    uint32_t state_size;            /* Bytes saved per switch */
+    bool xsave;
+    bool avx;
+    uint64_t traps;                 /* #NM taken */
+    uint64_t saves;
+    uint64_t restores;
+} fpu_stats_t;
+
+/* Detect XSAVE/AVX, capture a clean state and take #NM; interrupts off */
+void fpu_init(void);
+
+/* The same setup on an application processor, whose thread becomes its idle context */
+void fpu_init_cpu(void);
+
+/* Make ctx (NULL: this CPU's boot or idle thread) the running state; on every thread switch */
+void fpu_switch(fpu_context_t *ctx);
+
+/* Forget a dead thread's state without saving it */
+void fpu_release(fpu_context_t *ctx);
+
+/* Save this CPU's registers if they belong to a thread that is not running */
+void fpu_park(void);
+
+/* ctx's registers are loaded, unsaved, on some CPU */
+bool fpu_live(const fpu_context_t *ctx);
+
+/* AVX registers are enabled in XCR0 and may be used */
+bool fpu_has_avx(void);
+
+void fpu_get_stats(fpu_stats_t *stats);
+
+#endif /* FPU_H */
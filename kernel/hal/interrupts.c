@@ -0,0 +1,300 @@
+/**
+ * SpiritOS Hardware Abstraction Layer - Interrupts Implementation
+ *
+ * Descriptor tables, PIC setup and the C side of interrupt dispatch.
+ * Once interrupts_use_apic has run, IRQs arrive through the I/O APIC
+ * and every vector from a device or another CPU is acknowledged at the
+ * local APIC instead of the PICs.
+ */
+
+#include "interrupts.h"
+#include "apic.h"
+#include "io.h"
+#include "kprintf.h"
+#include "kstring.h"
+
+/* 8259 PIC ports and commands */
+#define PIC1_COMMAND    0x20
+#define PIC1_DATA       0x21
+#define PIC2_COMMAND    0xA0
+#define PIC2_DATA       0xA1
+#define PIC_EOI         0x20
+#define PIC_READ_ISR    0x0B
+#define ICW1_INIT       0x11    /* Edge triggered, cascade, ICW4 follows */
+#define ICW4_8086       0x01
+
+#define IDT_INTERRUPT_GATE  0x8E    /* Present, ring 0, interrupts off on entry */
+
+#define EFLAGS_NEW_THREAD   0x202   /* Interrupts on, plus the always-set bit 1 */
+
+typedef struct __attribute__((packed)) {
+    uint16_t limit;
+    uintptr_t base;
+} descriptor_pointer_t;
+
+#ifdef __x86_64__
+typedef struct __attribute__((packed)) {
+    uint16_t offset_low;
+    uint16_t selector;
+    uint8_t ist;
+    uint8_t type;
+    uint16_t offset_middle;
+    uint32_t offset_high;
+    uint32_t reserved;
+} idt_entry_t;
+
+/* Null, ring 0 64-bit code, ring 0 data */
+static const uint64_t gdt[3] __attribute__((aligned(8))) = {
+    0,
+    0x00AF9A000000FFFFULL,
+    0x00CF92000000FFFFULL
+};
+#else
+typedef struct __attribute__((packed)) {
+    uint16_t offset_low;
+    uint16_t selector;
+    uint8_t zero;
+    uint8_t type;
+    uint16_t offset_high;
+} idt_entry_t;
+
+/* Null, ring 0 code, ring 0 data; flat 4 GiB */
+static const uint64_t gdt[3] __attribute__((aligned(8))) = {
+    0,
+    0x00CF9A000000FFFFULL,
+    0x00CF92000000FFFFULL
+};
+#endif
+
+static idt_entry_t idt[256] __attribute__((aligned(8)));
+static interrupt_handler_t handlers[INTERRUPT_VECTORS];
+static bool apic_mode = false;
+
+/* Entry points in boot/interrupts.S, one per vector */
+extern const uintptr_t interrupt_stub_table[INTERRUPT_VECTORS];
+
+static const char *EXCEPTION_NAMES[32] = {
+    "Divide error", "Debug", "NMI", "Breakpoint", "Overflow", "Bound range",
+    "Invalid opcode", "Device not available", "Double fault", "Coprocessor overrun",
+    "Invalid TSS", "Segment not present", "Stack fault", "General protection",
+    "Page fault", "Reserved", "x87 error", "Alignment check", "Machine check",
+    "SIMD error", "Virtualization", "Control protection", "Reserved", "Reserved",
+    "Reserved", "Reserved", "Reserved", "Reserved", "Reserved", "Reserved",
+    "Security", "Reserved"
+};
+
+static void gdt_load(void) {
+    descriptor_pointer_t pointer = { sizeof(gdt) - 1, (uintptr_t)gdt };
+#ifdef __x86_64__
+    /* No far jump to a 64-bit offset; a far return reloads CS instead */
+    __asm__ volatile (
+        "lgdt %0\n\t"
+        "pushq %1\n\t"
+        "leaq 1f(%%rip), %%rax\n\t"
+        "pushq %%rax\n\t"
+        "lretq\n"
+        "1:\n\t"
+        "mov %2, %%ax\n\t"
+        "mov %%ax, %%ds\n\t"
+        "mov %%ax, %%es\n\t"
+        "mov %%ax, %%fs\n\t"
+        "mov %%ax, %%gs\n\t"
+        "mov %%ax, %%ss\n\t"
+        : : "m"(pointer), "i"(GDT_KERNEL_CODE), "i"(GDT_KERNEL_DATA) : "rax", "memory");
+#else
+    __asm__ volatile (
+        "lgdt %0\n\t"
+        "ljmp %1, $1f\n"
+        "1:\n\t"
+        "mov %2, %%ax\n\t"
+        "mov %%ax, %%ds\n\t"
+        "mov %%ax, %%es\n\t"
+        "mov %%ax, %%fs\n\t"
+        "mov %%ax, %%gs\n\t"
+        "mov %%ax, %%ss\n\t"
+        : : "m"(pointer), "i"(GDT_KERNEL_CODE), "i"(GDT_KERNEL_DATA) : "eax", "memory");
+#endif
+}
+
+static void idt_fill(void) {
+    for (int vector = 0; vector < INTERRUPT_VECTORS; vector++) {
+        uintptr_t offset = interrupt_stub_table[vector];
+        idt[vector].offset_low = offset & 0xFFFF;
+        idt[vector].selector = GDT_KERNEL_CODE;
+        idt[vector].type = IDT_INTERRUPT_GATE;
+#ifdef __x86_64__
+        idt[vector].ist = 0;
+        idt[vector].offset_middle = (offset >> 16) & 0xFFFF;
+        idt[vector].offset_high = (uint32_t)(offset >> 32);
+        idt[vector].reserved = 0;
+#else
+        idt[vector].zero = 0;
+        idt[vector].offset_high = offset >> 16;
+#endif
+    }
+}
+
+static void idt_load(void) {
+    descriptor_pointer_t pointer = { sizeof(idt) - 1, (uintptr_t)idt };
+    __asm__ volatile ("lidt %0" : : "m"(pointer) : "memory");
+}
+
+/* Move IRQs off the CPU exception vectors and mask them all */
+static void pic_remap(void) {
+    outb(PIC1_COMMAND, ICW1_INIT);
+    io_wait();
+    outb(PIC2_COMMAND, ICW1_INIT);
+    io_wait();
+    outb(PIC1_DATA, INTERRUPT_IRQ_BASE);
+    io_wait();
+    outb(PIC2_DATA, INTERRUPT_IRQ_BASE + 8);
+    io_wait();
+    outb(PIC1_DATA, 0x04);      /* Slave on IRQ2 */
+    io_wait();
+    outb(PIC2_DATA, 0x02);      /* Cascade identity */
+    io_wait();
+    outb(PIC1_DATA, ICW4_8086);
+    io_wait();
+    outb(PIC2_DATA, ICW4_8086);
+    io_wait();
+    
+    outb(PIC1_DATA, 0xFB);      /* All masked but the cascade */
+    outb(PIC2_DATA, 0xFF);
+}
+
+/* IRQ 7 and 15 also fire spuriously; a real one is in service */
+static bool irq_spurious(uint8_t irq) {
+    uint16_t port = irq < 8 ? PIC1_COMMAND : PIC2_COMMAND;
+    outb(port, PIC_READ_ISR);
+    return !(inb(port) & (1 << (irq & 7)));
+}
+
+void interrupts_init(void) {
+    memset(handlers, 0, sizeof(handlers));
+    apic_mode = false;
+    gdt_load();
+    idt_fill();
+    idt_load();
+    pic_remap();
+    kprintf("[INTERRUPTS] GDT and IDT loaded, IRQs at vector %d\n", INTERRUPT_IRQ_BASE);
+}
+
+void interrupts_init_cpu(void) {
+    gdt_load();
+    idt_load();
+}
+
+/**
+ * Hand IRQ delivery to the I/O APIC
+ *
+ * Lines unmasked at the PICs are unmasked at the I/O APIC; then the
+ * PICs are masked for good. The cascade line (IRQ 2) has no device.
+ */
+void interrupts_use_apic(void) {
+    uint16_t masked = inb(PIC1_DATA) | (inb(PIC2_DATA) << 8);
+    outb(PIC1_DATA, 0xFF);
+    outb(PIC2_DATA, 0xFF);
+    
+    for (uint8_t irq = 0; irq < 16; irq++) {
+        if (irq == 2) continue;
+        ioapic_route(irq, INTERRUPT_IRQ_BASE + irq, (masked & (1 << irq)) != 0);
+    }
+    apic_mode = true;
+    kprintf("[INTERRUPTS] IRQs routed through the I/O APIC\n");
+}
+
+void interrupts_set_handler(uint8_t vector, interrupt_handler_t handler) {
+    if (vector < INTERRUPT_VECTORS) {
+        handlers[vector] = handler;
+    }
+}
+
+interrupt_frame_t *interrupt_frame_create(void *stack_top, void (*entry)(void)) {
+#ifdef __x86_64__
+    /* The entry point sees RSP as if called: 8 below a 16-byte boundary */
+    uint8_t *top = (uint8_t *)((uintptr_t)stack_top & ~(uintptr_t)15);
+    interrupt_frame_t *frame = (interrupt_frame_t *)(top - 16) - 1;
+    memset(frame, 0, sizeof(*frame));
+    frame->rip = (uintptr_t)entry;
+    frame->cs = GDT_KERNEL_CODE;
+    frame->rflags = EFLAGS_NEW_THREAD;
+    frame->rsp = (uintptr_t)(top - 8);
+    frame->ss = GDT_KERNEL_DATA;
+#else
+    /* 4 bytes above the frame keep the entry point's stack ABI-aligned */
+    interrupt_frame_t *frame = (interrupt_frame_t *)((uint8_t *)stack_top - 4) - 1;
+    memset(frame, 0, sizeof(*frame));
+    frame->gs = frame->fs = frame->es = frame->ds = GDT_KERNEL_DATA;
+    frame->cs = GDT_KERNEL_CODE;
+    frame->eip = (uint32_t)(uintptr_t)entry;
+    frame->eflags = EFLAGS_NEW_THREAD;
+#endif
+    return frame;
+}
+
+void irq_set_handler(uint8_t irq, interrupt_handler_t handler) {
+    if (irq >= 16) return;
+    interrupts_set_handler(INTERRUPT_IRQ_BASE + irq, handler);
+    irq_unmask(irq);
+}
+
+void irq_mask(uint8_t irq) {
+    if (apic_mode) {
+        ioapic_set_masked(irq, true);
+        return;
+    }
+    uint16_t port = irq < 8 ? PIC1_DATA : PIC2_DATA;
+    outb(port, inb(port) | (1 << (irq & 7)));
+}
+
+void irq_unmask(uint8_t irq) {
+    if (apic_mode) {
+        ioapic_set_masked(irq, false);
+        return;
+    }
+    uint16_t port = irq < 8 ? PIC1_DATA : PIC2_DATA;
+    outb(port, inb(port) & ~(1 << (irq & 7)));
+}
+
+/* Called by the stub; returns the frame to resume */
+interrupt_frame_t *interrupt_dispatch(interrupt_frame_t *frame) {
+    uint32_t vector = (uint32_t)frame->vector;
+    
+    /* Exceptions are fatal unless someone handles them (#NM: the FPU) */
+    if (vector < 32 && !handlers[vector]) {
+#ifdef __x86_64__
+        kprintf("\n[INTERRUPTS] %s (vector %u, error 0x%x) at rip %p\n",
+                EXCEPTION_NAMES[vector], vector, (uint32_t)frame->error, (void *)frame->rip);
+#else
+        kprintf("\n[INTERRUPTS] %s (vector %u, error 0x%x) at eip 0x%x\n",
+                EXCEPTION_NAMES[vector], vector, frame->error, frame->eip);
+#endif
+        kprintf("[INTERRUPTS] System halted.\n");
+        for (;;) {
+            __asm__ volatile ("cli; hlt");
+        }
+    }
+    
+    /* Acknowledge first: the handler may resume another thread */
+    if (apic_mode) {
+        if (vector == INTERRUPT_APIC_SPURIOUS) {
+            return frame;       /* Never acknowledged */
+        }
+        if (vector >= INTERRUPT_IRQ_BASE && vector != INTERRUPT_YIELD_VECTOR) {
+            apic_eoi();
+        }
+    } else if (vector >= INTERRUPT_IRQ_BASE && vector < INTERRUPT_IRQ_BASE + 16) {
+        uint8_t irq = vector - INTERRUPT_IRQ_BASE;
+        if ((irq == 7 || irq == 15) && irq_spurious(irq)) {
+            if (irq == 15) outb(PIC1_COMMAND, PIC_EOI);
+            return frame;
+        }
+        if (irq >= 8) outb(PIC2_COMMAND, PIC_EOI);
+        outb(PIC1_COMMAND, PIC_EOI);
+    }
+    
+    if (handlers[vector]) {
+        return handlers[vector](frame);
+    }
+    return frame;
+}
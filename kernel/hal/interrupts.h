@@ -0,0 +1,82 @@
+/**
+ * SpiritOS Hardware Abstraction Layer - Interrupts
+ *
+ * Flat GDT, IDT and the 8259 PICs remapped to vectors 32-47. Every
+ * vector goes through one assembly stub that saves the interrupted
+ * context as an interrupt_frame_t on its stack. A handler returns the
+ * frame to resume, which may belong to another thread: that is the
+ * whole context switch.
+ */
+
+#ifndef INTERRUPTS_H
+#define INTERRUPTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define GDT_KERNEL_CODE         0x08
+#define GDT_KERNEL_DATA         0x10
+
+#define INTERRUPT_IRQ_BASE      32      /* IRQ 0-15 -> vectors 32-47 */
+#define INTERRUPT_YIELD_VECTOR  48      /* int $48 gives up the CPU */
+#define INTERRUPT_APIC_TIMER    49      /* Local APIC timer, one per CPU */
+#define INTERRUPT_RESCHEDULE    50      /* IPI: look at the run queue again */
+#define INTERRUPT_APIC_SPURIOUS 63      /* Low four bits set, as older CPUs need */
+#define INTERRUPT_VECTORS       64      /* Vectors with a stub */
+
+/* Saved by the stub, lowest address first */
+#ifdef __x86_64__
+typedef struct {
+    uint64_t r15, r14, r13, r12, r11, r10, r9, r8;
+    uint64_t rbp, rdi, rsi, rdx, rcx, rbx, rax;
+    uint64_t vector;
+    uint64_t error;                 /* CPU error code, or 0 */
+    uint64_t rip, cs, rflags, rsp, ss;  /* Pushed by the CPU */
+} interrupt_frame_t;
+#else
+typedef struct {
+    uint32_t gs, fs, es, ds;
+    uint32_t edi, esi, ebp, esp, ebx, edx, ecx, eax;   /* pusha */
+    uint32_t vector;
+    uint32_t error;                 /* CPU error code, or 0 */
+    uint32_t eip, cs, eflags;       /* Pushed by the CPU */
+} interrupt_frame_t;
+#endif
+
+typedef interrupt_frame_t *(*interrupt_handler_t)(interrupt_frame_t *frame);
+
+/* Load the GDT and IDT and remap the PICs; all IRQs start masked */
+void interrupts_init(void);
+
+/* Load the same GDT and IDT on an application processor */
+void interrupts_init_cpu(void);
+
+/* Move IRQ delivery from the PICs to the I/O APIC, keeping each line's mask */
+void interrupts_use_apic(void);
+
+/* Handle a vector; IRQ vectors are acknowledged before the handler runs */
+void interrupts_set_handler(uint8_t vector, interrupt_handler_t handler);
+
+/* A frame at the top of a fresh stack that resumes into entry, interrupts on */
+interrupt_frame_t *interrupt_frame_create(void *stack_top, void (*entry)(void));
+
+/* Handle an IRQ line and unmask it */
+void irq_set_handler(uint8_t irq, interrupt_handler_t handler);
+void irq_mask(uint8_t irq);
+void irq_unmask(uint8_t irq);
+
+static inline void interrupts_enable(void) {
+    __asm__ volatile ("sti" ::: "memory");
+}
+
+static inline void interrupts_disable(void) {
+    __asm__ volatile ("cli" ::: "memory");
+}
+
+static inline bool interrupts_enabled(void) {
+    unsigned long flags;
+    __asm__ volatile ("pushf; pop %0" : "=r"(flags));
+    return (flags & 0x200) != 0;
+}
+
+#endif /* INTERRUPTS_H */
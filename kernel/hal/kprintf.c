@@ -8,9 +8,13 @@
 #include "vga.h"
 #include "serial.h"
 #include "kstring.h"
+#include "../sync.h"
 #include <stdarg.h>
 #include <stdbool.h>
 
+/* One line at a time, whichever thread prints it */
+static spinlock_t console_lock = SPINLOCK_INIT;
+
 static void putchar_console(char c) {
     vga_putchar(c);
     serial_putchar(c);
@@ -60,6 +64,7 @@ void console_init(void) {
 int kprintf(const char *format, ...) {
     va_list args;
     va_start(args, format);
+    unsigned long flags = spin_lock(&console_lock);
     
     int count = 0;
     
@@ -131,6 +136,7 @@ int kprintf(const char *format, ...) {
         }
     }
     
+    spin_unlock(&console_lock, flags);
     va_end(args);
     return count;
 }
@@ -5,6 +5,7 @@
  */
 
 #include "kstring.h"
+#include "../kmem.h"
 
 size_t strlen(const char *str) {
     size_t len = 0;
@@ -32,9 +33,10 @@ char *strstr(const char *haystack, const char *needle) {
 }
 
 char *strdup(const char *s) {
-    /* Stub implementation - we don't have malloc in freestanding */
-    (void)s;
-    return NULL;
+    size_t size = strlen(s) + 1;
+    char *copy = kmalloc(size);
+    if (copy) memcpy(copy, s, size);
+    return copy;
 }
 
 char *strncpy(char *dest, const char *src, size_t n) {
@@ -62,6 +64,16 @@ int strcmp(const char *s1, const char *s2) {
     return *(unsigned char *)s1 - *(unsigned char *)s2;
 }
 
+int strncmp(const char *s1, const char *s2, size_t n) {
+    while (n > 0 && *s1 && (*s1 == *s2)) {
+        s1++;
+        s2++;
+        n--;
+    }
+    if (n == 0) return 0;
+    return *(unsigned char *)s1 - *(unsigned char *)s2;
+}
+
 void *memcpy(void *dest, const void *src, size_t n) {
     unsigned char *d = dest;
     const unsigned char *s = src;
@@ -70,6 +82,19 @@ void *memcpy(void *dest, const void *src, size_t n) {
     return dest;
 }
 
+void *memmove(void *dest, const void *src, size_t n) {
+    unsigned char *d = dest;
+    const unsigned char *s = src;
+    if (d < s) {
+        for (size_t i = 0; i < n; i++)
+            d[i] = s[i];
+    } else {
+        for (size_t i = n; i > 0; i--)
+            d[i - 1] = s[i - 1];
+    }
+    return dest;
+}
+
 void *memset(void *s, int c, size_t n) {
     unsigned char *p = s;
     for (size_t i = 0; i < n; i++)
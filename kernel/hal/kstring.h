@@ -12,7 +12,7 @@
 /* String find substring */
 char *strstr(const char *haystack, const char *needle);
 
-/* String duplicate (stub - returns NULL) */
+/* String duplicate, from kmalloc */
 char *strdup(const char *s);
 
 /* String copy with limit */
@@ -27,9 +27,15 @@ char *strcpy(char *dest, const char *src);
 /* String compare */
 int strcmp(const char *s1, const char *s2);
 
+/* String compare with limit */
+int strncmp(const char *s1, const char *s2, size_t n);
+
 /* Memory copy */
 void *memcpy(void *dest, const void *src, size_t n);
 
+/* Memory copy, overlapping allowed */
+void *memmove(void *dest, const void *src, size_t n);
+
 /* Memory set */
 void *memset(void *s, int c, size_t n);
 
@@ -0,0 +1,69 @@
+/**
+ * SpiritOS Hardware Abstraction Layer - Multiboot2 Boot Information
+ *
+ * The parts of the Multiboot2 information structure the kernel reads.
+ * The loader leaves it at the address passed in EBX: a size, then
+ * 8-byte aligned tags up to an end tag.
+ */
+
+#ifndef MULTIBOOT_H
+#define MULTIBOOT_H
+
+#include <stdint.h>
+
+#define MULTIBOOT2_BOOTLOADER_MAGIC 0x36d76289
+
+#define MULTIBOOT_TAG_END           0
+#define MULTIBOOT_TAG_MODULE        3
+#define MULTIBOOT_TAG_MMAP          6
+#define MULTIBOOT_TAG_ACPI_OLD      14      /* Copy of an ACPI 1.0 RSDP */
+#define MULTIBOOT_TAG_ACPI_NEW      15      /* Copy of an ACPI 2.0+ RSDP */
+
+#define MULTIBOOT_MEMORY_AVAILABLE  1
+
+typedef struct __attribute__((packed)) {
+    uint32_t total_size;
+    uint32_t reserved;
+} multiboot_info_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t type;
+    uint32_t size;              /* Header included, padding not */
+} multiboot_tag_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t type;
+    uint32_t size;
+    uint32_t mod_start;
+    uint32_t mod_end;
+} multiboot_tag_module_t;
+
+typedef struct __attribute__((packed)) {
+    uint64_t base;
+    uint64_t length;
+    uint32_t type;
+    uint32_t reserved;
+} multiboot_mmap_entry_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t type;
+    uint32_t size;
+    uint32_t entry_size;        /* May grow; step by this, not sizeof */
+    uint32_t entry_version;
+} multiboot_tag_mmap_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t type;
+    uint32_t size;
+    uint8_t rsdp[];
+} multiboot_tag_acpi_t;
+
+static inline const multiboot_tag_t *multiboot_first_tag(const multiboot_info_t *info) {
+    return (const multiboot_tag_t *)(info + 1);
+}
+
+static inline const multiboot_tag_t *multiboot_next_tag(const multiboot_tag_t *tag) {
+    return (const multiboot_tag_t *)((const uint8_t *)tag + ((tag->size + 7) & ~7u));
+}
+
+#endif /* MULTIBOOT_H */
@@ -1,38 +1,160 @@
 /**
  * SpiritOS Hardware Abstraction Layer - Timer/Delay Implementation
- * 
- * Provides timing and delay functionality using PIT
+ *
+ * Time comes from the TSC, calibrated against the PIT at boot. The PIT
+ * itself only raises IRQ0 when something is due: timer_set_deadline
+ * arms channel 0 in one-shot mode, so an idle CPU sleeps in hlt until
+ * then. Without a TSC the PIT falls back to a 1 kHz periodic tick.
  */
 
 #include "timer.h"
 #include "io.h"
+#include "interrupts.h"
+#include "kprintf.h"
+#include "../sync.h"
 
 /* PIT (Programmable Interval Timer) ports */
 #define PIT_CHANNEL0 0x40
+#define PIT_CHANNEL2 0x42
 #define PIT_COMMAND  0x43
+#define PIT_GATE     0x61       /* Bit 0: channel 2 gate, bit 5: its output */
 
-static volatile uint64_t system_ticks = 0;
+#define PIT_PER_MS          1193
+#define PIT_MAX_COUNT       0xFFFF      /* About 55 ms */
+#define CALIBRATE_MS        10
+#define NS_SHIFT            24          /* ns = cycles * ns_mult >> NS_SHIFT */
+
+static volatile uint64_t system_ticks = 0;     /* IRQ0s taken */
+static bool tsc_clock = false;
+static uint64_t tsc_base = 0;
+static uint32_t tsc_khz = 0;
+static uint32_t ns_mult = 0;
+
+static inline uint64_t rdtsc(void) {
+    uint32_t low, high;
+    __asm__ volatile ("rdtsc" : "=a"(low), "=d"(high));
+    return ((uint64_t)high << 32) | low;
+}
+
+static bool cpu_has_tsc(void) {
+    uint32_t eax = 1, ebx, ecx, edx;
+    __asm__ volatile ("cpuid" : "+a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx));
+    return (edx & (1 << 4)) != 0;
+}
+
+/* Count TSC cycles over CALIBRATE_MS of PIT channel 2 */
+static uint32_t tsc_calibrate(void) {
+    uint16_t count = PIT_PER_MS * CALIBRATE_MS;
+    uint8_t gate = inb(PIT_GATE) & ~0x03;       /* Speaker off, gate low */
+    
+    outb(PIT_GATE, gate);
+    outb(PIT_COMMAND, 0xB0);    /* Channel 2, lobyte/hibyte, interrupt on terminal count */
+    outb(PIT_CHANNEL2, count & 0xFF);
+    outb(PIT_CHANNEL2, (count >> 8) & 0xFF);
+    
+    outb(PIT_GATE, gate | 0x01);                /* Start counting */
+    uint64_t start = rdtsc();
+    while (!(inb(PIT_GATE) & 0x20)) {
+        /* Wait for the output to rise */
+    }
+    uint32_t cycles = (uint32_t)(rdtsc() - start);
+    outb(PIT_GATE, gate);
+    
+    return cycles / CALIBRATE_MS;
+}
 
 void timer_init(void) {
+    system_ticks = 0;
+    tsc_clock = cpu_has_tsc();
+    if (tsc_clock) {
+        tsc_khz = tsc_calibrate();
+        tsc_clock = tsc_khz > 0;
+    }
+    
+    if (tsc_clock) {
+        ns_mult = (uint32_t)((1000000ULL << NS_SHIFT) / tsc_khz);
+        tsc_base = rdtsc();
+        outb(PIT_COMMAND, 0x30);    /* Channel 0, lobyte/hibyte, one-shot; armed on demand */
+        kprintf("[TIMER] TSC at %u kHz, one-shot PIT\n", tsc_khz);
+        return;
+    }
+    
     /* Initialize PIT to ~1000Hz (1ms resolution) */
     uint16_t divisor = 1193;  /* 1193182 Hz / 1193 ≈ 1000 Hz */
     
     outb(PIT_COMMAND, 0x36);  /* Channel 0, lobyte/hibyte, rate generator */
     outb(PIT_CHANNEL0, divisor & 0xFF);
     outb(PIT_CHANNEL0, (divisor >> 8) & 0xFF);
-    
-    system_ticks = 0;
+    kprintf("[TIMER] No TSC, periodic 1 kHz PIT\n");
 }
 
 void timer_tick(void) {
     system_ticks++;
 }
 
+uint64_t timer_now_ns(void) {
+    if (!tsc_clock) {
+        return timer_get_ticks() * 1000000ULL;
+    }
+    
+    /* cycles * ns_mult would overflow; split the cycles in halves */
+    uint64_t cycles = rdtsc() - tsc_base;
+    uint64_t high = (cycles >> 32) * ns_mult;
+    uint64_t low = ((cycles & 0xFFFFFFFFULL) * ns_mult) >> NS_SHIFT;
+    return (high << (32 - NS_SHIFT)) + low;
+}
+
 uint64_t timer_get_ticks(void) {
-    return system_ticks;
+    if (tsc_clock) {
+        return timer_now_ns() / 1000000ULL;
+    }
+    
+    /* Two 32-bit loads: keep IRQ0 from landing between them */
+    unsigned long flags = sync_irq_save();
+    uint64_t ticks = system_ticks;
+    sync_irq_restore(flags);
+    return ticks;
+}
+
+uint32_t timer_tsc_khz(void) {
+    return tsc_khz;
+}
+
+void timer_set_deadline(uint64_t tick) {
+    if (!tsc_clock) return;     /* The periodic tick covers every deadline */
+    
+    uint64_t now = timer_get_ticks();
+    uint32_t count = PIT_MAX_COUNT;
+    if (tick <= now) {
+        count = PIT_PER_MS;
+    } else if (tick - now < PIT_MAX_COUNT / PIT_PER_MS) {
+        count = (uint32_t)(tick - now) * PIT_PER_MS;
+    }
+    
+    /* Longer waits fire early; the handler just arms again */
+    outb(PIT_COMMAND, 0x30);
+    outb(PIT_CHANNEL0, count & 0xFF);
+    outb(PIT_CHANNEL0, (count >> 8) & 0xFF);
 }
 
 void delay_ms(uint32_t ms) {
+    if (tsc_clock) {
+        /* Calibrated spin, for short hardware waits; threads sleep instead */
+        uint64_t deadline = timer_now_ns() + (uint64_t)ms * 1000000ULL;
+        while (timer_now_ns() < deadline) {
+            __asm__ volatile ("pause");
+        }
+        return;
+    }
+    
+    if (interrupts_enabled() && timer_get_ticks() > 0) {
+        uint64_t deadline = timer_get_ticks() + ms;
+        while (timer_get_ticks() < deadline) {
+            __asm__ volatile ("hlt");
+        }
+        return;
+    }
+    
     /* Simple busy-wait delay */
     /* This is approximate and CPU-speed dependent */
     for (uint32_t i = 0; i < ms; i++) {
@@ -9,13 +9,25 @@
 
 #include <stdint.h>
 
-/* Initialize timer */
+/* Calibrate the TSC and set up the PIT */
 void timer_init(void);
 
-/* Simple delay loop (approximate) */
+/* Count one PIT interrupt; called from the IRQ0 handler */
+void timer_tick(void);
+
+/* Busy-wait ms milliseconds on the calibrated clock */
 void delay_ms(uint32_t ms);
 
-/* Get tick count */
+/* Monotonic nanoseconds since timer_init */
+uint64_t timer_now_ns(void);
+
+/* Milliseconds since timer_init */
 uint64_t timer_get_ticks(void);
 
+/* Raise IRQ0 at (or before) this tick; replaces any earlier deadline */
+void timer_set_deadline(uint64_t tick);
+
+/* Calibrated TSC frequency, 0 without a TSC */
+uint32_t timer_tsc_khz(void);
+
 #endif /* TIMER_H */
@@ -0,0 +1,586 @@
+/**
+ * Kernel Memory - Implementation
+ *
+ * Every page frame below the highest usable address has two bytes of
+ * metadata. Free blocks are linked through their own first bytes, so
+ * the buddy allocator needs nothing else; a slab keeps its header at
+ * the start of its pages, and its objects are linked through their
+ * first word while free.
+ */
+
+#include "freestanding.h"
+#include "kmem.h"
+#include "sync.h"
+#include "hal/multiboot.h"
+
+#define PAGE_FREE       0x01    /* Head of a free block; order is its size */
+#define PAGE_USED       0x02    /* Head of an allocated block; order is its size */
+#define PAGE_LARGE      0x04    /* ...which kmalloc handed out */
+#define PAGE_SLAB       0x08    /* In a slab; order is the distance to its head */
+
+#define KMEM_LOW_LIMIT      0x100000U       /* The first MiB stays with the BIOS */
+#define KMEM_HIGH_LIMIT     0xFFFFF000U     /* Above this a pointer cannot reach */
+#define SLAB_MAX_ORDER      3
+#define SLAB_MIN_OBJECTS    8
+
+typedef struct {
+    uint8_t flags;
+    uint8_t order;
+} page_meta_t;
+
+typedef struct free_block {
+    struct free_block *next;
+    struct free_block *prev;
+} free_block_t;
+
+typedef struct slab {
+    struct slab *next;
+    struct slab *prev;
+    kmem_cache_t *cache;
+    void *free;                 /* Free objects, linked through their first word */
+    uint32_t in_use;
+} slab_t;
+
+struct kmem_cache {
+    kmem_cache_stats_t stats;
+    uint32_t offset;            /* First object, past the slab header */
+    uint32_t order;
+    slab_t *partial;            /* Slabs with a free object */
+    slab_t *full;
+    uint32_t empty;             /* Slabs on partial with nothing in use */
+};
+
+typedef struct {
+    uint32_t start;
+    uint32_t end;
+} kmem_range_t;
+
+/* From boot/linker.ld */
+extern char _kernel_start[];
+extern char _kernel_end[];
+
+static page_meta_t *page_meta = NULL;
+static uint32_t page_count = 0;     /* Frames page_meta covers */
+static free_block_t *free_lists[KMEM_MAX_ORDER + 1];
+static kmem_range_t regions[KMEM_REGIONS_MAX];
+static uint32_t region_count = 0;
+static kmem_range_t reserved[KMEM_REGIONS_MAX];
+static uint32_t reserved_count = 0;
+static kmem_cache_t caches[KMEM_CACHES_MAX];
+static int cache_count = 0;
+static kmem_cache_t *size_classes[KMEM_SIZE_CLASSES];
+static kmem_stats_t kmem_stats;
+static spinlock_t kmem_lock = SPINLOCK_INIT;
+
+static inline void *pfn_address(uint32_t pfn) {
+    return (void *)(uintptr_t)(pfn << KMEM_PAGE_SHIFT);
+}
+
+static inline uint32_t address_pfn(const void *address) {
+    return (uint32_t)((uintptr_t)address >> KMEM_PAGE_SHIFT);
+}
+
+/* ---- Memory map ---- */
+
+/* Keep [start, end) out of the allocator, whole pages */
+static void kmem_reserve(uint32_t start, uint32_t end) {
+    if (reserved_count == KMEM_REGIONS_MAX || end <= start) return;
+    uint64_t top = ((uint64_t)end + KMEM_PAGE_SIZE - 1) & ~(uint64_t)(KMEM_PAGE_SIZE - 1);
+    reserved[reserved_count].start = start & ~(KMEM_PAGE_SIZE - 1);
+    reserved[reserved_count].end = top > KMEM_HIGH_LIMIT ? KMEM_HIGH_LIMIT : (uint32_t)top;
+    reserved_count++;
+}
+
+/* Add the whole pages of [start, end) that no reservation from first on covers */
+static void kmem_add_region(uint32_t start, uint32_t end, uint32_t first) {
+    if (end <= start) return;
+    start = (start + KMEM_PAGE_SIZE - 1) & ~(KMEM_PAGE_SIZE - 1);
+    end &= ~(KMEM_PAGE_SIZE - 1);
+    
+    for (uint32_t r = first; r < reserved_count && start < end; r++) {
+        if (reserved[r].start < end && reserved[r].end > start) {
+            if (reserved[r].start > start) {
+                kmem_add_region(start, reserved[r].start, r + 1);
+            }
+            start = reserved[r].end;
+        }
+    }
+    
+    if (start >= end || region_count == KMEM_REGIONS_MAX) return;
+    regions[region_count].start = start;
+    regions[region_count].end = end;
+    region_count++;
+}
+
+/* Collect the usable regions from the boot information */
+static int kmem_read_map(uint32_t multiboot_addr) {
+    const multiboot_info_t *info = (const multiboot_info_t *)(uintptr_t)multiboot_addr;
+    const uint8_t *info_end = (const uint8_t *)info + info->total_size;
+    const multiboot_tag_mmap_t *mmap = NULL;
+    
+    kmem_reserve(0, KMEM_LOW_LIMIT);
+    kmem_reserve((uint32_t)(uintptr_t)_kernel_start, (uint32_t)(uintptr_t)_kernel_end);
+    kmem_reserve(multiboot_addr, multiboot_addr + info->total_size);
+    
+    for (const multiboot_tag_t *tag = multiboot_first_tag(info);
+         (const uint8_t *)tag < info_end && tag->type != MULTIBOOT_TAG_END;
+         tag = multiboot_next_tag(tag)) {
+        if (tag->type == MULTIBOOT_TAG_MODULE) {
+            const multiboot_tag_module_t *module = (const multiboot_tag_module_t *)tag;
+            kmem_reserve(module->mod_start, module->mod_end);
+        } else if (tag->type == MULTIBOOT_TAG_MMAP) {
+            mmap = (const multiboot_tag_mmap_t *)tag;
+        }
+    }
+    if (!mmap || mmap->entry_size < sizeof(multiboot_mmap_entry_t)) return -1;
+    
+    const uint8_t *map_end = (const uint8_t *)mmap + mmap->size;
+    for (const uint8_t *cursor = (const uint8_t *)(mmap + 1);
+         cursor + sizeof(multiboot_mmap_entry_t) <= map_end;
+         cursor += mmap->entry_size) {
+        const multiboot_mmap_entry_t *entry = (const multiboot_mmap_entry_t *)cursor;
+        if (entry->type != MULTIBOOT_MEMORY_AVAILABLE || entry->base >= KMEM_HIGH_LIMIT) continue;
+        
+        uint64_t end = entry->base + entry->length;
+        if (end > KMEM_HIGH_LIMIT) end = KMEM_HIGH_LIMIT;
+        kmem_add_region((uint32_t)entry->base, (uint32_t)end, 0);
+    }
+    return region_count > 0 ? 0 : -1;
+}
+
+/* ---- Buddy allocator; kmem_lock held ---- */
+
+static void free_list_push(uint32_t pfn, unsigned int order) {
+    free_block_t *block = pfn_address(pfn);
+    block->prev = NULL;
+    block->next = free_lists[order];
+    if (block->next) block->next->prev = block;
+    free_lists[order] = block;
+    page_meta[pfn].flags = PAGE_FREE;
+    page_meta[pfn].order = (uint8_t)order;
+    kmem_stats.free_blocks[order]++;
+}
+
+static void free_list_remove(uint32_t pfn, unsigned int order) {
+    free_block_t *block = pfn_address(pfn);
+    if (block->prev) {
+        block->prev->next = block->next;
+    } else {
+        free_lists[order] = block->next;
+    }
+    if (block->next) block->next->prev = block->prev;
+    page_meta[pfn].flags = 0;
+    kmem_stats.free_blocks[order]--;
+}
+
+/* Free a block, merging it with its buddy for as long as that is free too */
+static void buddy_free(uint32_t pfn, unsigned int order) {
+    kmem_stats.pages_free += 1u << order;
+    while (order < KMEM_MAX_ORDER) {
+        uint32_t buddy = pfn ^ (1u << order);
+        if (buddy >= page_count || page_meta[buddy].flags != PAGE_FREE ||
+            page_meta[buddy].order != order) {
+            break;
+        }
+        free_list_remove(buddy, order);
+        pfn &= ~(1u << order);
+        order++;
+    }
+    free_list_push(pfn, order);
+}
+
+/* Split the smallest free block that fits */
+static void *buddy_alloc(unsigned int order) {
+    unsigned int found = order;
+    while (found <= KMEM_MAX_ORDER && !free_lists[found]) {
+        found++;
+    }
+    if (found > KMEM_MAX_ORDER) return NULL;
+    
+    uint32_t pfn = address_pfn(free_lists[found]);
+    free_list_remove(pfn, found);
+    while (found > order) {
+        found--;
+        free_list_push(pfn + (1u << found), found);
+    }
+    
+    page_meta[pfn].flags = PAGE_USED;
+    page_meta[pfn].order = (uint8_t)order;
+    kmem_stats.pages_free -= 1u << order;
+    return pfn_address(pfn);
+}
+
+/* Give a region to the buddy allocator in the largest aligned blocks */
+static void buddy_add_region(uint32_t start, uint32_t end) {
+    uint32_t pfn = start >> KMEM_PAGE_SHIFT;
+    uint32_t last = end >> KMEM_PAGE_SHIFT;
+    while (pfn < last) {
+        unsigned int order = 0;
+        while (order < KMEM_MAX_ORDER && !(pfn & (1u << order)) && pfn + (2u << order) <= last) {
+            order++;
+        }
+        kmem_stats.pages_total += 1u << order;
+        buddy_free(pfn, order);
+        pfn += 1u << order;
+    }
+}
+
+/* ---- Slab caches; kmem_lock held ---- */
+
+static void slab_link(slab_t **list, slab_t *slab) {
+    slab->prev = NULL;
+    slab->next = *list;
+    if (slab->next) slab->next->prev = slab;
+    *list = slab;
+}
+
+static void slab_unlink(slab_t **list, slab_t *slab) {
+    if (slab->prev) {
+        slab->prev->next = slab->next;
+    } else {
+        *list = slab->next;
+    }
+    if (slab->next) slab->next->prev = slab->prev;
+}
+
+/* The slab holding an address, or NULL if it is not slab memory */
+static slab_t *slab_of(const void *address) {
+    uint32_t pfn = address_pfn(address);
+    if (pfn >= page_count || !(page_meta[pfn].flags & PAGE_SLAB)) return NULL;
+    return pfn_address(pfn - page_meta[pfn].order);
+}
+
+static slab_t *slab_grow(kmem_cache_t *cache) {
+    uint8_t *base = buddy_alloc(cache->order);
+    if (!base) return NULL;
+    
+    uint32_t pfn = address_pfn(base);
+    for (uint32_t i = 0; i < (1u << cache->order); i++) {
+        page_meta[pfn + i].flags = PAGE_SLAB;
+        page_meta[pfn + i].order = (uint8_t)i;
+    }
+    
+    slab_t *slab = (slab_t *)base;
+    slab->cache = cache;
+    slab->in_use = 0;
+    slab->free = NULL;
+    for (uint32_t i = cache->stats.objects_per_slab; i-- > 0;) {
+        void **object = (void **)(base + cache->offset + i * cache->stats.object_size);
+        *object = slab->free;
+        slab->free = object;
+    }
+    
+    slab_link(&cache->partial, slab);
+    cache->stats.slabs++;
+    cache->empty++;
+    return slab;
+}
+
+static void slab_release(kmem_cache_t *cache, slab_t *slab) {
+    uint32_t pfn = address_pfn(slab);
+    for (uint32_t i = 0; i < (1u << cache->order); i++) {
+        page_meta[pfn + i].flags = 0;
+    }
+    cache->stats.slabs--;
+    buddy_free(pfn, cache->order);
+}
+
+static void *cache_alloc(kmem_cache_t *cache) {
+    slab_t *slab = cache->partial;
+    if (!slab && !(slab = slab_grow(cache))) return NULL;
+    
+    if (slab->in_use == 0) cache->empty--;
+    void **object = slab->free;
+    slab->free = *object;
+    slab->in_use++;
+    if (!slab->free) {
+        slab_unlink(&cache->partial, slab);
+        slab_link(&cache->full, slab);
+    }
+    
+    cache->stats.objects_in_use++;
+    cache->stats.allocs++;
+    return object;
+}
+
+/* One empty slab stays cached; later ones go back to the buddy allocator */
+static void cache_free(kmem_cache_t *cache, slab_t *slab, void *object) {
+    if (!slab->free) {
+        slab_unlink(&cache->full, slab);
+        slab_link(&cache->partial, slab);
+    }
+    *(void **)object = slab->free;
+    slab->free = object;
+    slab->in_use--;
+    cache->stats.objects_in_use--;
+    cache->stats.frees++;
+    
+    if (slab->in_use == 0) {
+        if (cache->empty > 0) {
+            slab_unlink(&cache->partial, slab);
+            slab_release(cache, slab);
+        } else {
+            cache->empty++;
+        }
+    }
+}
+
+static kmem_cache_t *cache_create(const char *name, size_t size, size_t align) {
+    if (align == 0) align = sizeof(void *);
+    if ((align & (align - 1)) != 0 || cache_count == KMEM_CACHES_MAX) return NULL;
+    
+    if (size < sizeof(void *)) size = sizeof(void *);
+    size = (size + align - 1) & ~(align - 1);
+    uint32_t offset = (uint32_t)((sizeof(slab_t) + align - 1) & ~(align - 1));
+    
+    /* The smallest slab that holds SLAB_MIN_OBJECTS, or the largest allowed */
+    uint32_t order = 0;
+    while (order < SLAB_MAX_ORDER &&
+           ((KMEM_PAGE_SIZE << order) - offset) / size < SLAB_MIN_OBJECTS) {
+        order++;
+    }
+    uint32_t objects = (uint32_t)(((KMEM_PAGE_SIZE << order) - offset) / size);
+    if (objects == 0) return NULL;
+    
+    kmem_cache_t *cache = &caches[cache_count++];
+    memset(cache, 0, sizeof(*cache));
+    strncpy(cache->stats.name, name, sizeof(cache->stats.name) - 1);
+    cache->stats.object_size = (uint32_t)size;
+    cache->stats.slab_pages = 1u << order;
+    cache->stats.objects_per_slab = objects;
+    cache->offset = offset;
+    cache->order = order;
+    return cache;
+}
+
+/**
+ * Initialize the allocators from the Multiboot2 memory map
+ */
+int kmem_init(uint32_t multiboot_magic, uint32_t multiboot_addr) {
+    memset(free_lists, 0, sizeof(free_lists));
+    memset(&kmem_stats, 0, sizeof(kmem_stats));
+    memset(size_classes, 0, sizeof(size_classes));
+    page_meta = NULL;
+    page_count = 0;
+    region_count = 0;
+    reserved_count = 0;
+    cache_count = 0;
+    
+    if (multiboot_magic != MULTIBOOT2_BOOTLOADER_MAGIC) {
+        printf("[KMEM] No Multiboot2 information (magic 0x%x)\n", multiboot_magic);
+        return -1;
+    }
+    if (kmem_read_map(multiboot_addr) != 0) {
+        printf("[KMEM] No usable memory in the boot memory map\n");
+        return -1;
+    }
+    
+    /* Metadata for every frame up to the top of memory, from the first region that fits */
+    uint32_t top = 0;
+    for (uint32_t r = 0; r < region_count; r++) {
+        if (regions[r].end > top) top = regions[r].end;
+    }
+    page_count = top >> KMEM_PAGE_SHIFT;
+    uint32_t meta_bytes = page_count * (uint32_t)sizeof(page_meta_t);
+    uint32_t meta_pages = (meta_bytes + KMEM_PAGE_SIZE - 1) >> KMEM_PAGE_SHIFT;
+    for (uint32_t r = 0; r < region_count && !page_meta; r++) {
+        if (((regions[r].end - regions[r].start) >> KMEM_PAGE_SHIFT) >= meta_pages) {
+            page_meta = (page_meta_t *)(uintptr_t)regions[r].start;
+            regions[r].start += meta_pages << KMEM_PAGE_SHIFT;
+        }
+    }
+    if (!page_meta) {
+        printf("[KMEM] No region can hold the page metadata\n");
+        page_count = 0;
+        return -1;
+    }
+    memset(page_meta, 0, meta_bytes);
+    kmem_stats.metadata_pages = meta_pages;
+    
+    for (uint32_t r = 0; r < region_count; r++) {
+        buddy_add_region(regions[r].start, regions[r].end);
+    }
+    kmem_stats.regions = region_count;
+    
+    for (int i = 0; i < KMEM_SIZE_CLASSES; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "kmalloc-%d", 16 << i);
+        size_classes[i] = cache_create(name, (size_t)16 << i, 0);
+    }
+    
+    printf("[KMEM] %u KiB usable in %u regions, %u pages of metadata\n",
+           kmem_stats.pages_total * (KMEM_PAGE_SIZE / 1024), region_count, meta_pages);
+    return 0;
+}
+
+/**
+ * Allocate 2^order contiguous pages
+ */
+void *page_alloc(unsigned int order) {
+    if (order > KMEM_MAX_ORDER) return NULL;
+    
+    unsigned long flags = spin_lock(&kmem_lock);
+    void *block = buddy_alloc(order);
+    spin_unlock(&kmem_lock, flags);
+    return block;
+}
+
+/**
+ * Free pages from page_alloc
+ */
+void page_free(void *page) {
+    if (!page) return;
+    
+    unsigned long flags = spin_lock(&kmem_lock);
+    uint32_t pfn = address_pfn(page);
+    if (((uintptr_t)page & (KMEM_PAGE_SIZE - 1)) != 0 || pfn >= page_count ||
+        page_meta[pfn].flags != PAGE_USED) {
+        spin_unlock(&kmem_lock, flags);
+        printf("[KMEM] page_free of a block it did not hand out: %p\n", page);
+        return;
+    }
+    page_meta[pfn].flags = 0;
+    buddy_free(pfn, page_meta[pfn].order);
+    spin_unlock(&kmem_lock, flags);
+}
+
+/**
+ * Create a slab cache
+ */
+kmem_cache_t *kmem_cache_create(const char *name, size_t size, size_t align) {
+    if (!name) return NULL;
+    
+    unsigned long flags = spin_lock(&kmem_lock);
+    kmem_cache_t *cache = cache_create(name, size, align);
+    spin_unlock(&kmem_lock, flags);
+    
+    if (!cache) {
+        fprintf(stderr, "[KMEM] Cannot create cache '%s'\n", name);
+    }
+    return cache;
+}
+
+/**
+ * Allocate an object from a cache
+ */
+void *kmem_cache_alloc(kmem_cache_t *cache) {
+    if (!cache) return NULL;
+    
+    unsigned long flags = spin_lock(&kmem_lock);
+    void *object = cache_alloc(cache);
+    spin_unlock(&kmem_lock, flags);
+    return object;
+}
+
+/**
+ * Return an object to its cache
+ */
+void kmem_cache_free(kmem_cache_t *cache, void *object) {
+    if (!cache || !object) return;
+    
+    unsigned long flags = spin_lock(&kmem_lock);
+    slab_t *slab = slab_of(object);
+    if (!slab || slab->cache != cache) {
+        spin_unlock(&kmem_lock, flags);
+        printf("[KMEM] %p is not from cache '%s'\n", object, cache->stats.name);
+        return;
+    }
+    cache_free(cache, slab, object);
+    spin_unlock(&kmem_lock, flags);
+}
+
+/**
+ * Allocate memory
+ */
+void *kmalloc(size_t size) {
+    if (size == 0) return NULL;
+    
+    unsigned long flags = spin_lock(&kmem_lock);
+    void *pointer = NULL;
+    for (int i = 0; i < KMEM_SIZE_CLASSES; i++) {
+        if (size <= ((size_t)16 << i)) {
+            pointer = size_classes[i] ? cache_alloc(size_classes[i]) : NULL;
+            spin_unlock(&kmem_lock, flags);
+            return pointer;
+        }
+    }
+    
+    unsigned int order = 0;
+    while (order <= KMEM_MAX_ORDER && ((size_t)KMEM_PAGE_SIZE << order) < size) {
+        order++;
+    }
+    if (order <= KMEM_MAX_ORDER && (pointer = buddy_alloc(order)) != NULL) {
+        page_meta[address_pfn(pointer)].flags |= PAGE_LARGE;
+        kmem_stats.large_allocs++;
+        kmem_stats.large_pages += 1u << order;
+    }
+    spin_unlock(&kmem_lock, flags);
+    return pointer;
+}
+
+/**
+ * Allocate zeroed memory for count objects
+ */
+void *kcalloc(size_t count, size_t size) {
+    if (size != 0 && count > (size_t)-1 / size) return NULL;
+    
+    void *pointer = kmalloc(count * size);
+    if (pointer) memset(pointer, 0, count * size);
+    return pointer;
+}
+
+/**
+ * Free memory from kmalloc
+ */
+void kfree(void *pointer) {
+    if (!pointer) return;
+    
+    unsigned long flags = spin_lock(&kmem_lock);
+    slab_t *slab = slab_of(pointer);
+    if (slab) {
+        cache_free(slab->cache, slab, pointer);
+        spin_unlock(&kmem_lock, flags);
+        return;
+    }
+    
+    uint32_t pfn = address_pfn(pointer);
+    if (((uintptr_t)pointer & (KMEM_PAGE_SIZE - 1)) != 0 || pfn >= page_count ||
+        page_meta[pfn].flags != (PAGE_USED | PAGE_LARGE)) {
+        spin_unlock(&kmem_lock, flags);
+        printf("[KMEM] kfree of a pointer it did not hand out: %p\n", pointer);
+        return;
+    }
+    unsigned int order = page_meta[pfn].order;
+    page_meta[pfn].flags = 0;
+    kmem_stats.large_pages -= 1u << order;
+    buddy_free(pfn, order);
+    spin_unlock(&kmem_lock, flags);
+}
+
+/**
+ * Get the page allocator's counters
+ */
+int kmem_get_stats(kmem_stats_t *stats) {
+    if (!stats) return -1;
+    
+    unsigned long flags = spin_lock(&kmem_lock);
+    *stats = kmem_stats;
+    spin_unlock(&kmem_lock, flags);
+    return 0;
+}
+
+/**
+ * Get a cache's counters
+ */
+int kmem_cache_get_stats(int index, kmem_cache_stats_t *stats) {
+    if (index < 0 || !stats) return -1;
+    
+    unsigned long flags = spin_lock(&kmem_lock);
+    if (index >= cache_count) {
+        spin_unlock(&kmem_lock, flags);
+        return -1;
+    }
+    *stats = caches[index].stats;
+    spin_unlock(&kmem_lock, flags);
+    return 0;
+}
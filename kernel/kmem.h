@@ -0,0 +1,68 @@
+/**
+ * Kernel Memory - The Earthly Vessel
+ *
+ * Physical memory for the freestanding kernel. The usable regions of
+ * the Multiboot2 memory map feed a buddy allocator of 4 KiB pages;
+ * slab caches carve pages into objects, and kmalloc picks a cache by
+ * size. Paging is off, so a physical address is the pointer itself.
+ */
+
+#ifndef KMEM_H
+#define KMEM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define KMEM_PAGE_SIZE          4096
+#define KMEM_PAGE_SHIFT         12
+#define KMEM_MAX_ORDER          10      /* Largest block: 4 MiB */
+#define KMEM_CACHES_MAX         16
+#define KMEM_SIZE_CLASSES       8       /* kmalloc caches: 16 to 2048 bytes */
+#define KMEM_REGIONS_MAX        32
+
+typedef struct kmem_cache kmem_cache_t;
+
+typedef struct {
+    uint32_t regions;           /* Usable ranges after the kernel and boot data */
+    uint32_t pages_total;
+    uint32_t pages_free;
+    uint32_t free_blocks[KMEM_MAX_ORDER + 1];
+    uint32_t metadata_pages;    /* Page table of the allocator itself */
+    uint64_t large_allocs;      /* kmalloc requests served straight from pages */
+    uint32_t large_pages;       /* Pages they hold now */
+} kmem_stats_t;
+
+typedef struct {
+    char name[16];
+    uint32_t object_size;
+    uint32_t slab_pages;
+    uint32_t objects_per_slab;
+    uint32_t slabs;
+    uint32_t objects_in_use;
+    uint64_t allocs;
+    uint64_t frees;
+} kmem_cache_stats_t;
+
+/* Hand the memory map to the allocators; -1 without Multiboot2 or a map */
+int kmem_init(uint32_t multiboot_magic, uint32_t multiboot_addr);
+
+/* 2^order contiguous pages, or NULL */
+void *page_alloc(unsigned int order);
+void page_free(void *page);
+
+/* A cache of fixed-size objects aligned to align (a power of two, or 0) */
+kmem_cache_t *kmem_cache_create(const char *name, size_t size, size_t align);
+void *kmem_cache_alloc(kmem_cache_t *cache);
+void kmem_cache_free(kmem_cache_t *cache, void *object);
+
+/* Objects up to 2048 bytes come from the size classes, larger ones are whole pages */
+void *kmalloc(size_t size);
+void *kcalloc(size_t count, size_t size);
+void kfree(void *pointer);
+
+int kmem_get_stats(kmem_stats_t *stats);
+
+/* Caches in creation order; -1 past the last */
+int kmem_cache_get_stats(int index, kmem_cache_stats_t *stats);
+
+#endif /* KMEM_H */
@@ -4,18 +4,162 @@
  * The Soul Core awakens here - Standalone x86_64 Kernel
  */
 
+#include "freestanding.h"
 #include "hal/kprintf.h"
 #include "hal/timer.h"
 #include "hal/vga.h"
+#include "hal/interrupts.h"
+#include "hal/fpu.h"
 #include "soul_core.h"
+#include "soul_sched.h"
+#include "smp.h"
+#include "kmem.h"
 #include "ephemeris_provider.h"
 #include "destiny_engine.h"
 #include "astral_fs.h"
+#include "work_queue.h"
 #include <stdint.h>
 #include <stdbool.h>
 
 static volatile bool keep_running = true;
 
+#ifdef __x86_64__
+#define KERNEL_ARCH "x86_64"
+#else
+#define KERNEL_ARCH "i386"
+#endif
+
+/* Cost of one cosmic tick's own work, the sleep excluded */
+static uint64_t tick_cost_total_ns = 0;
+static uint64_t tick_cost_min_ns = UINT64_MAX;
+static uint64_t tick_cost_max_ns = 0;
+static uint32_t tick_cost_count = 0;
+
+/* Watch the moon phase on kernel channel 0 */
+#define WATCH_CHANNEL 0
+
+/* Bottom halves of the cosmic tick */
+static int astral_queue = -1;
+static int console_queue = -1;
+
+/* A snapshot is reused two ticks (10 s) after its publish was queued */
+static celestial_data_t published[2];
+
+/* Print this tick's watch events */
+static void report_watch(void *arg) {
+    (void)arg;
+    astral_watch_event_t events[8];
+    int event_count = spiro_read_events(WATCH_CHANNEL, events, 8);
+    for (int i = 0; i < event_count; i++) {
+        kprintf("[KERNEL] Watch %d: moon phase changed at tick %u\n",
+                events[i].subscription, events[i].tick);
+    }
+}
+
+/* Update astral state and deliver its changes to subscribers */
+static void publish_state(void *arg) {
+    celestial_data_t *data = (celestial_data_t *)arg;
+    astral_fs_update_state(data);
+    astral_watch_dispatch(data);
+    if (work_queue_enqueue(console_queue, report_watch, NULL) != 0) {
+        report_watch(NULL);
+    }
+}
+
+static void report_work_queues(void) {
+    work_queue_stats_t stats;
+    for (int q = 0; work_queue_get_stats(q, &stats) == 0; q++) {
+        uint64_t average = stats.completed ? stats.latency_total_ns / stats.completed : 0;
+        kprintf("[WORK QUEUE] %s: %u run, %u dropped, latency %u us avg / %u us max, longest item %u us\n",
+                stats.name, (unsigned)stats.completed, (unsigned)stats.dropped,
+                (unsigned)(average / 1000), (unsigned)(stats.latency_max_ns / 1000),
+                (unsigned)(stats.run_max_ns / 1000));
+    }
+}
+
+static void report_cpus(void) {
+    soul_sched_cpu_stats_t stats;
+    for (uint32_t cpu = 0; soul_sched_get_cpu_stats(cpu, &stats) == 0; cpu++) {
+        kprintf("[SOUL SCHED] CPU %u: %u switches, %u steals, %u ms busy\n",
+                cpu, (unsigned)stats.switches, (unsigned)stats.steals,
+                (unsigned)stats.busy_ticks);
+    }
+}
+
+static void report_fpu(void) {
+    fpu_stats_t stats;
+    fpu_get_stats(&stats);
+    kprintf("[FPU] %u traps, %u saves, %u restores of %u-byte state\n",
+            (unsigned)stats.traps, (unsigned)stats.saves,
+            (unsigned)stats.restores, stats.state_size);
+}
+
+/* Same line in both builds, so the two can be compared on one machine */
+static void report_tick_cost(void) {
+    if (tick_cost_count == 0) {
+        return;
+    }
+    kprintf("[KERNEL] Tick loop (%s): %u ticks, %u ns avg / %u ns min / %u ns max\n",
+            KERNEL_ARCH, tick_cost_count,
+            (unsigned)(tick_cost_total_ns / tick_cost_count),
+            (unsigned)tick_cost_min_ns, (unsigned)tick_cost_max_ns);
+}
+
+/* The cosmic tick loop, run as a soul-core process */
+static void cosmic_tick_loop(void *arg) {
+    (void)arg;
+    
+    kprintf("[KERNEL] Entering cosmic tick loop...\n");
+    kprintf("[KERNEL] Running for demonstration (60 ticks)...\n\n");
+    
+    int tick_count = 0;
+    const int max_ticks = 60;  /* Run for 60 ticks in standalone mode */
+    const long tick_seconds = 5;
+    
+    /* Step the ephemeris by deltas instead of recomputing from the epoch */
+    ephemeris_state_t ephemeris;
+    ephemeris_state_init(&ephemeris, time(NULL));
+    
+    while (keep_running && tick_count < max_ticks) {
+        uint64_t tick_start = timer_now_ns();
+        
+        /* Publishing the astral state is left to the worker */
+        celestial_data_t *snapshot = &published[tick_count & 1];
+        memcpy(snapshot, &ephemeris.data, sizeof(*snapshot));
+        if (work_queue_enqueue(astral_queue, publish_state, snapshot) != 0) {
+            publish_state(snapshot);
+        }
+        
+        /* Execute destiny tick */
+        destiny_engine_tick_with(&ephemeris.data);
+        
+        /* Increment astral tick */
+        soul_core_tick();
+        
+        tick_count++;
+        
+        uint64_t tick_cost = timer_now_ns() - tick_start;
+        tick_cost_total_ns += tick_cost;
+        tick_cost_count++;
+        if (tick_cost < tick_cost_min_ns) {
+            tick_cost_min_ns = tick_cost;
+        }
+        if (tick_cost > tick_cost_max_ns) {
+            tick_cost_max_ns = tick_cost;
+        }
+        
+        /* Wait a cosmic moment (5 seconds for demo); other souls run meanwhile */
+        soul_sched_sleep(tick_seconds * 1000);
+        ephemeris_step(&ephemeris, tick_seconds);
+        
+        /* Show periodic status */
+        if (tick_count % 12 == 0) {
+            kprintf("\n[KERNEL] Cosmic heartbeat: %d ticks, Astral Tick: %lu\n",
+                   tick_count, soul_core_get_astral_tick());
+        }
+    }
+}
+
 void kernel_main(uint32_t multiboot_magic, uint32_t multiboot_addr) {
     /* Initialize console first */
     console_init();
@@ -24,7 +168,11 @@ void kernel_main(uint32_t multiboot_magic, uint32_t multiboot_addr) {
     kprintf("╔═══════════════════════════════════════════════════════╗\n");
     kprintf("║            SpiritOS - Spiritual Operating System      ║\n");
     kprintf("║                  Soul Core Awakening                  ║\n");
+#ifdef __x86_64__
     kprintf("║                 Standalone x86_64 Kernel              ║\n");
+#else
+    kprintf("║                  Standalone i386 Kernel               ║\n");
+#endif
     kprintf("╚═══════════════════════════════════════════════════════╝\n");
     kprintf("\n");
     
@@ -32,9 +180,22 @@ void kernel_main(uint32_t multiboot_magic, uint32_t multiboot_addr) {
     kprintf("[KERNEL] Multiboot info:  0x%x\n", multiboot_addr);
     kprintf("\n");
     
+    /* Descriptor tables and PICs; IRQs stay masked until the scheduler starts */
+    kprintf("[KERNEL] Initializing interrupts...\n");
+    interrupts_init();
+    fpu_init();
+    
     /* Initialize timer */
     kprintf("[KERNEL] Initializing timer...\n");
     timer_init();
+    work_queue_init();
+    
+    /* Physical memory from the boot loader's map; everything after allocates */
+    kprintf("[KERNEL] Initializing memory...\n");
+    if (kmem_init(multiboot_magic, multiboot_addr) != 0) {
+        kprintf("[KERNEL] FATAL: No memory map from the boot loader\n");
+        goto halt;
+    }
     
     /* Initialize kernel components */
     kprintf("[KERNEL] Initializing kernel components...\n");
@@ -84,42 +245,40 @@ void kernel_main(uint32_t multiboot_magic, uint32_t multiboot_addr) {
                                "/usr/bin/lucky_day_handler",
                                EXEC_MODE_NATIVE);
     
+    spiro_subscribe_events(WATCH_CHANNEL, ASTRAL_MOON_PHASE);
+    astral_queue = work_queue_create("astral", WORK_PRIORITY_NORMAL);
+    console_queue = work_queue_create("console", WORK_PRIORITY_LOW);
+    
     kprintf("\n");
     
-    /* Main cosmic tick loop */
-    kprintf("[KERNEL] Entering cosmic tick loop...\n");
-    kprintf("[KERNEL] Running for demonstration (60 ticks)...\n\n");
+    /* From here on IRQ0 drives the clock and shares the CPU */
+    soul_sched_init();
     
-    int tick_count = 0;
-    const int max_ticks = 60;  /* Run for 60 ticks in standalone mode */
+    /* Other CPUs come up idle and take threads as they are spawned */
+    smp_init(multiboot_magic, multiboot_addr);
+    if (work_queue_start() != 0) {
+        kprintf("[KERNEL] FATAL: Failed to start the work queue worker\n");
+        goto halt;
+    }
+    int cosmic_pid = soul_core_create_process("cosmic_tick", "every cosmic tick");
+    if (cosmic_pid < 0 || soul_sched_spawn((uint32_t)cosmic_pid, cosmic_tick_loop, NULL) != 0) {
+        kprintf("[KERNEL] FATAL: Failed to start the cosmic tick loop\n");
+        goto halt;
+    }
+    interrupts_enable();
     
-    while (keep_running && tick_count < max_ticks) {
-        /* Update astral state */
-        celestial_data_t data;
-        if (ephemeris_get_current_data(&data) == 0) {
-            astral_fs_update_state(&data);
-        }
-        
-        /* Execute destiny tick */
-        destiny_engine_tick();
-        
-        /* Increment astral tick */
-        soul_core_tick();
-        
-        tick_count++;
-        
-        /* Delay for a cosmic moment (5 seconds for demo) */
-        delay_ms(5000);
-        
-        /* Show periodic status */
-        if (tick_count % 12 == 0) {
-            kprintf("\n[KERNEL] Cosmic heartbeat: %d ticks, Astral Tick: %lu\n",
-                   tick_count, soul_core_get_astral_tick());
-        }
+    /* The boot thread idles until the cosmic loop is done */
+    while (soul_core_get_pcb((uint32_t)cosmic_pid)) {
+        __asm__ volatile ("hlt");
     }
     
     /* Shutdown */
     kprintf("\n[KERNEL] Beginning shutdown sequence...\n");
+    work_queue_stop();
+    report_work_queues();
+    report_tick_cost();
+    report_cpus();
+    report_fpu();
     
     astral_fs_unmount();
     astral_fs_shutdown();
@@ -0,0 +1,55 @@
+/**
+ * SIMD Kernels - Shared Vector Types
+ *
+ * Four-lane vectors built on GCC vector extensions. Code compiled for
+ * the baseline (SSE2) runs each as two halves; functions marked
+ * SIMD_AVX get whole 256-bit registers and must only be called when
+ * simd_has_avx() says so.
+ *
+ * In the kernel, vector code is SIMD-safe in thread context only: the
+ * scheduler switches SIMD state lazily, interrupt handlers must not
+ * touch it (see hal/fpu.h).
+ */
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SIMD_LANES 4
+
+/* Unaligned, may alias the arrays they are loaded from */
+typedef double simd_f64x4 __attribute__((vector_size(32), aligned(8), may_alias));
+typedef int64_t simd_i64x4 __attribute__((vector_size(32), aligned(8), may_alias));
+typedef uint64_t simd_u64x4 __attribute__((vector_size(32), aligned(8), may_alias));
+
+/*
+ * Vector kernels are optimized even in -O0 builds: unoptimized, every
+ * lane goes through the stack and the kernel is slower than scalar code
+ */
+#define SIMD_KERNEL __attribute__((optimize("O2")))
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_AVX __attribute__((target("avx")))
+
+#ifdef USERLAND_BUILD
+static inline bool simd_has_avx(void) {
+    return __builtin_cpu_supports("avx");
+}
+#else
+#include "hal/fpu.h"
+
+static inline bool simd_has_avx(void) {
+    return fpu_has_avx();
+}
+#endif
+
+#else
+#define SIMD_AVX
+static inline bool simd_has_avx(void) {
+    return false;
+}
+#endif
+
+#endif /* SIMD_H */
@@ -0,0 +1,164 @@
+/**
+ * SMP - Implementation
+ *
+ * Application processors are started one at a time: INIT, then up to
+ * two STARTUP IPIs at the trampoline (boot/trampoline.S), which comes
+ * up on the stack and entry point left in its slots. An AP loads the
+ * kernel's descriptor tables, enables its local APIC and FPU, and then
+ * becomes the idle thread of its own run queue.
+ */
+
+#include "freestanding.h"
+#include "smp.h"
+#include "soul_sched.h"
+#include "hal/acpi.h"
+#include "hal/apic.h"
+#include "hal/interrupts.h"
+#include "hal/timer.h"
+#include "hal/fpu.h"
+
+#define TRAMPOLINE_BASE     0x8000      /* Below 1 MiB, never handed out by kmem */
+#define INIT_WAIT_MS        10
+#define STARTUP_WAIT_MS     1
+#define ONLINE_TIMEOUT_MS   100
+
+/* boot/trampoline.S: the code and the slots patched in its copy */
+extern const uint8_t smp_trampoline_start[];
+extern const uint8_t smp_trampoline_end[];
+extern const uint8_t smp_trampoline_stack[];
+extern const uint8_t smp_trampoline_entry[];
+#ifdef __x86_64__
+extern const uint8_t smp_trampoline_cr3[];
+#endif
+
+static cpu_t cpus[SMP_MAX_CPUS];
+static uint32_t cpu_count = 1;
+static uint8_t cpu_of_apic[256];            /* Local APIC ID -> CPU index */
+static uint8_t ap_stacks[SMP_MAX_CPUS - 1][SMP_STACK_SIZE] __attribute__((aligned(16)));
+
+/* Write a slot in the running copy, not in the kernel image */
+static void trampoline_set(const uint8_t *slot, const void *value, size_t size) {
+    memcpy((uint8_t *)TRAMPOLINE_BASE + (slot - smp_trampoline_start), value, size);
+}
+
+/* First C code on an application processor, interrupts off */
+static void smp_ap_entry(void) {
+    interrupts_init_cpu();
+    apic_init_cpu();
+    fpu_init_cpu();
+    cpus[smp_cpu_index()].online = true;
+    soul_sched_run_cpu();
+}
+
+static bool smp_start_cpu(uint32_t index, uint8_t apic_id) {
+    cpus[index].index = index;
+    cpus[index].apic_id = apic_id;
+    cpus[index].online = false;
+    cpu_of_apic[apic_id] = (uint8_t)index;
+    
+    uintptr_t stack = (uintptr_t)(ap_stacks[index - 1] + SMP_STACK_SIZE);
+    uintptr_t entry = (uintptr_t)smp_ap_entry;
+    trampoline_set(smp_trampoline_stack, &stack, sizeof(stack));
+    trampoline_set(smp_trampoline_entry, &entry, sizeof(entry));
+#ifdef __x86_64__
+    uintptr_t cr3;
+    __asm__ volatile ("mov %%cr3, %0" : "=r"(cr3));
+    uint32_t cr3_low = (uint32_t)cr3;
+    trampoline_set(smp_trampoline_cr3, &cr3_low, sizeof(cr3_low));
+#endif
+    
+    apic_send_init(apic_id);
+    delay_ms(INIT_WAIT_MS);
+    
+    /* A second STARTUP only if the first was missed */
+    for (int attempt = 0; attempt < 2 && !cpus[index].online; attempt++) {
+        apic_send_startup(apic_id, TRAMPOLINE_BASE >> 12);
+        uint64_t deadline = timer_get_ticks() + (attempt == 0 ? STARTUP_WAIT_MS : ONLINE_TIMEOUT_MS);
+        while (!cpus[index].online && timer_get_ticks() <= deadline) {
+            __asm__ volatile ("pause");
+        }
+    }
+    
+    if (!cpus[index].online) {
+        apic_send_init(apic_id);    /* Park it again */
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Start the application processors
+ *
+ * On a single CPU nothing changes: no APIC is touched and the PICs
+ * keep delivering IRQs.
+ */
+int smp_init(uint32_t multiboot_magic, uint32_t multiboot_addr) {
+    memset(cpus, 0, sizeof(cpus));
+    memset(cpu_of_apic, 0, sizeof(cpu_of_apic));
+    cpus[0].online = true;
+    cpu_count = 1;
+    
+    acpi_madt_t madt;
+    if (acpi_read_madt(multiboot_magic, multiboot_addr, &madt) != 0 || madt.cpu_count < 2) {
+        printf("[SMP] One CPU, IRQs stay on the PICs\n");
+        return 0;
+    }
+    if (apic_init(&madt) != 0) {
+        printf("[SMP] No usable APIC or TSC, staying on one CPU\n");
+        return 0;
+    }
+    cpus[0].apic_id = apic_id();
+    interrupts_use_apic();
+    
+    memcpy((void *)TRAMPOLINE_BASE, smp_trampoline_start,
+           (size_t)(smp_trampoline_end - smp_trampoline_start));
+    
+    for (uint32_t i = 0; i < madt.cpu_count; i++) {
+        uint8_t id = madt.cpu_apic_ids[i];
+        if (id == cpus[0].apic_id) continue;
+        if (cpu_count == SMP_MAX_CPUS) {
+            printf("[SMP] Only %d CPUs are used\n", SMP_MAX_CPUS);
+            break;
+        }
+        if (smp_start_cpu(cpu_count, id)) {
+            cpu_count++;
+        } else {
+            fprintf(stderr, "[SMP] CPU with APIC ID %u did not start\n", id);
+        }
+    }
+    
+    printf("[SMP] %u CPUs online\n", cpu_count);
+    return 0;
+}
+
+/**
+ * Get the calling CPU's index
+ *
+ * Looked up from the local APIC ID, so it is right on any stack; the
+ * thread may move to another CPU once interrupts are back on.
+ */
+uint32_t smp_cpu_index(void) {
+    return apic_enabled() ? cpu_of_apic[apic_id()] : 0;
+}
+
+uint32_t smp_cpu_count(void) {
+    return cpu_count;
+}
+
+const cpu_t *smp_cpu(uint32_t index) {
+    return index < cpu_count ? &cpus[index] : NULL;
+}
+
+void smp_kick(uint32_t cpu) {
+    if (cpu < cpu_count && cpus[cpu].online) {
+        apic_send_ipi(cpus[cpu].apic_id, INTERRUPT_RESCHEDULE);
+    }
+}
+
+void smp_set_deadline(uint64_t tick) {
+    if (smp_cpu_index() == 0) {
+        timer_set_deadline(tick);
+    } else {
+        apic_timer_set_deadline(tick);
+    }
+}
@@ -0,0 +1,45 @@
+/**
+ * SMP - Many Hands at the Wheel
+ *
+ * Brings up the application processors the ACPI MADT lists and keeps
+ * a small per-CPU area for each. The boot CPU is CPU 0. Every CPU runs
+ * its own soul scheduler run queue; smp_kick pokes another CPU to look
+ * at it again.
+ *
+ * With one CPU, no MADT or no TSC the kernel stays on the 8259 PICs and
+ * the PIT, exactly as before: smp_cpu_index is always 0.
+ */
+
+#ifndef SMP_H
+#define SMP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SMP_MAX_CPUS        8
+#define SMP_STACK_SIZE      16384       /* Each AP's idle thread */
+
+typedef struct {
+    uint32_t index;
+    uint8_t apic_id;
+    volatile bool online;
+} cpu_t;
+
+/* Start every CPU in the MADT; after soul_sched_init, interrupts off */
+int smp_init(uint32_t multiboot_magic, uint32_t multiboot_addr);
+
+/* The calling CPU; stable only while interrupts are off */
+uint32_t smp_cpu_index(void);
+
+/* CPUs started so far, the boot CPU included */
+uint32_t smp_cpu_count(void);
+
+const cpu_t *smp_cpu(uint32_t index);
+
+/* Raise the reschedule IPI on another CPU */
+void smp_kick(uint32_t cpu);
+
+/* Arm this CPU's timer: the PIT on the boot CPU, the local APIC elsewhere */
+void smp_set_deadline(uint64_t tick);
+
+#endif /* SMP_H */
@@ -6,12 +6,8 @@
 
 #include "freestanding.h"
 
-int snprintf(char *str, size_t size, const char *format, ...) {
-    va_list args;
-    va_start(args, format);
-    
+int vsnprintf(char *str, size_t size, const char *format, va_list args) {
     if (size == 0 || str == NULL) {
-        va_end(args);
         return 0;
     }
     
@@ -148,6 +144,13 @@ int snprintf(char *str, size_t size, const char *format, ...) {
     }
     
     str[pos] = '\0';
-    va_end(args);
     return pos;
 }
+
+int snprintf(char *str, size_t size, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(str, size, format, args);
+    va_end(args);
+    return written;
+}
@@ -7,20 +7,114 @@
 
 #include "freestanding.h"
 #include "soul_core.h"
+#include "sync.h"
 
-#define MAX_PROCESSES 256
+#define PID_INDEX_MASK      ((1u << SOUL_PID_INDEX_BITS) - 1)
+#define PID_GENERATION_MASK ((1u << (31 - SOUL_PID_INDEX_BITS)) - 1)
+#define PCB_SLAB_SHIFT      8
+#define PCB_SLAB_SIZE       SOUL_PCB_SLAB_SIZE
+#define PCB_MAX_SLABS       ((PID_INDEX_MASK + 1) / PCB_SLAB_SIZE)
 
-static process_control_block_t pcb_table[MAX_PROCESSES];
-static uint32_t next_pid = 1;
+/*
+ * A slab of slots. Each part is its own array, so scanning the PCBs
+ * does not pull in the metadata or the allocator's bookkeeping.
+ */
+typedef struct {
+    process_control_block_t pcb[PCB_SLAB_SIZE];
+    spiritual_metadata_t spirit[PCB_SLAB_SIZE];
+    uint32_t next_free[PCB_SLAB_SIZE];      /* Free list link, 0 = end */
+    uint16_t generation[PCB_SLAB_SIZE];     /* Survives the souls that used the slot */
+    bool live[PCB_SLAB_SIZE];
+} pcb_slab_t;
+
+/* Slab directory: slot index -> slabs[index >> 8], entry index & 255 */
+static pcb_slab_t *pcb_slabs[PCB_MAX_SLABS];
+static uint32_t slab_count = 0;
+static uint32_t next_fresh = 1;     /* Slot 0 is never used, so no PID is 0 */
+static uint32_t free_head = 0;      /* Freed slots, oldest first */
+static uint32_t free_tail = 0;
+static soul_core_stats_t soul_stats;
+static spinlock_t soul_lock = SPINLOCK_INIT;
 static uint64_t astral_tick_counter = 0;
 
+#define SLAB_OF(index)      pcb_slabs[(index) >> PCB_SLAB_SHIFT]
+#define ENTRY_OF(index)     ((index) & (PCB_SLAB_SIZE - 1))
+
+/* Add one zeroed slab; false when memory or PID space runs out */
+static bool pcb_grow(void) {
+    if (slab_count == PCB_MAX_SLABS) return false;
+#ifdef USERLAND_BUILD
+    pcb_slab_t *slab = aligned_alloc(64, sizeof(pcb_slab_t));
+#else
+    pcb_slab_t *slab = kmalloc(sizeof(pcb_slab_t));     /* Whole pages, so aligned */
+#endif
+    if (!slab) return false;
+    memset(slab, 0, sizeof(*slab));
+    pcb_slabs[slab_count++] = slab;
+    soul_stats.capacity = slab_count * PCB_SLAB_SIZE - 1;
+    return true;
+}
+
+/* Take a slot: the oldest freed one, else a fresh one; 0 if none */
+static uint32_t pid_slot_alloc(void) {
+    uint32_t index = free_head;
+    if (index != 0) {
+        free_head = SLAB_OF(index)->next_free[ENTRY_OF(index)];
+        if (free_head == 0) free_tail = 0;
+        return index;
+    }
+    if (next_fresh >= slab_count * PCB_SLAB_SIZE && !pcb_grow()) {
+        return 0;
+    }
+    return next_fresh++;
+}
+
+/*
+ * Return a slot and bump its generation, so stale PIDs for it stop
+ * resolving. Reusing the oldest freed slot first spreads generations
+ * across slots instead of cycling one.
+ */
+static void pid_slot_free(uint32_t index) {
+    pcb_slab_t *slab = SLAB_OF(index);
+    uint32_t entry = ENTRY_OF(index);
+    slab->live[entry] = false;
+    slab->generation[entry] = (uint16_t)((slab->generation[entry] + 1) & PID_GENERATION_MASK);
+    slab->next_free[entry] = 0;
+    if (free_tail != 0) {
+        SLAB_OF(free_tail)->next_free[ENTRY_OF(free_tail)] = index;
+    } else {
+        free_head = index;
+    }
+    free_tail = index;
+}
+
+/* Slot index of a live PID, or 0 if it never existed or has died */
+static uint32_t pid_lookup(uint32_t pid) {
+    uint32_t index = pid & PID_INDEX_MASK;
+    if (index == 0 || index >= next_fresh) return 0;
+    
+    pcb_slab_t *slab = SLAB_OF(index);
+    uint32_t entry = ENTRY_OF(index);
+    if (!slab->live[entry] || slab->pcb[entry].pid != pid) return 0;
+    return index;
+}
+
 /**
  * Initialize the Soul Core
  */
 int soul_core_init(void) {
-    memset(pcb_table, 0, sizeof(pcb_table));
-    next_pid = 1;
+    unsigned long flags = spin_lock(&soul_lock);
+    for (uint32_t i = 0; i < slab_count; i++) {
+        free(pcb_slabs[i]);
+    }
+    memset(pcb_slabs, 0, sizeof(pcb_slabs));
+    slab_count = 0;
+    next_fresh = 1;
+    free_head = 0;
+    free_tail = 0;
+    memset(&soul_stats, 0, sizeof(soul_stats));
     astral_tick_counter = 0;
+    spin_unlock(&soul_lock, flags);
     
     printf("[SOUL CORE] Awakening... The heart of SpiritOS begins to beat.\n");
     return 0;
@@ -28,52 +122,130 @@ int soul_core_init(void) {
 
 /**
  * Create a new process with spiritual metadata
+ *
+ * Returns the PID: a slot index with the slot's generation above it.
  */
 int soul_core_create_process(const char *ritual_tag, const char *trigger_conditions) {
-    if (next_pid >= MAX_PROCESSES) {
+    unsigned long flags = spin_lock(&soul_lock);
+    uint32_t index = pid_slot_alloc();
+    if (index == 0) {
+        spin_unlock(&soul_lock, flags);
         fprintf(stderr, "[SOUL CORE] No more souls can be born. Maximum capacity reached.\n");
         return -1;
     }
     
-    process_control_block_t *pcb = &pcb_table[next_pid];
-    pcb->pid = next_pid;
+    pcb_slab_t *slab = SLAB_OF(index);
+    uint32_t entry = ENTRY_OF(index);
+    process_control_block_t *pcb = &slab->pcb[entry];
+    spiritual_metadata_t *spirit = &slab->spirit[entry];
+    memset(pcb, 0, sizeof(*pcb));
+    memset(spirit, 0, sizeof(*spirit));
+    pcb->pid = ((uint32_t)slab->generation[entry] << SOUL_PID_INDEX_BITS) | index;
     pcb->state = PROCESS_STATE_BIRTH;
     pcb->astral_birth_tick = astral_tick_counter;
+    pcb->moon_affinity = 0.5; /* Default neutral affinity */
+    pcb->astral_priority = 0;
+    slab->live[entry] = true;
     
     /* Initialize spiritual metadata */
-    pcb->spirit.moon_affinity = 0.5; /* Default neutral affinity */
-    pcb->spirit.astral_priority = 0;
-    strncpy(pcb->spirit.ritual_tag, ritual_tag, sizeof(pcb->spirit.ritual_tag) - 1);
-    strncpy(pcb->spirit.trigger_conditions, trigger_conditions, 
-            sizeof(pcb->spirit.trigger_conditions) - 1);
+    strncpy(spirit->ritual_tag, ritual_tag, sizeof(spirit->ritual_tag) - 1);
+    strncpy(spirit->trigger_conditions, trigger_conditions, 
+            sizeof(spirit->trigger_conditions) - 1);
     
-    printf("[SOUL CORE] New soul born: PID=%u, Ritual='%s'\n", next_pid, ritual_tag);
+    soul_stats.live++;
+    soul_stats.births++;
+    uint32_t pid = pcb->pid;
+    spin_unlock(&soul_lock, flags);
     
-    next_pid++;
-    return pcb->pid;
+    printf("[SOUL CORE] New soul born: PID=%u, Ritual='%s'\n", pid, ritual_tag);
+    return (int)pid;
 }
 
 /**
  * Destroy a process (death)
+ *
+ * The slot is reused by a later birth under a new PID. A process with a
+ * scheduler thread is refused: its thread ends it through soul_sched_exit().
  */
 int soul_core_destroy_process(uint32_t pid) {
-    if (pid >= MAX_PROCESSES || pcb_table[pid].state == PROCESS_STATE_DEATH) {
+    unsigned long flags = spin_lock(&soul_lock);
+    uint32_t index = pid_lookup(pid);
+    if (index == 0) {
+        spin_unlock(&soul_lock, flags);
+        return -1;
+    }
+    
+    /* Run queues link threads by slot, so the slot must outlive the thread */
+    process_control_block_t *pcb = &SLAB_OF(index)->pcb[ENTRY_OF(index)];
+    if (pcb->context) {
+        spin_unlock(&soul_lock, flags);
+        fprintf(stderr, "[SOUL CORE] PID=%u still has a thread; it ends through soul_sched_exit\n", pid);
         return -1;
     }
     
-    pcb_table[pid].state = PROCESS_STATE_DEATH;
+    pcb->state = PROCESS_STATE_DEATH;
+    pid_slot_free(index);
+    soul_stats.live--;
+    spin_unlock(&soul_lock, flags);
+    
     printf("[SOUL CORE] Soul departed: PID=%u\n", pid);
     return 0;
 }
 
 /**
  * Get process control block
+ *
+ * NULL for PIDs that have died, even if their slot is in use again.
  */
 process_control_block_t* soul_core_get_pcb(uint32_t pid) {
-    if (pid >= MAX_PROCESSES) {
-        return NULL;
-    }
-    return &pcb_table[pid];
+    unsigned long flags = spin_lock(&soul_lock);
+    uint32_t index = pid_lookup(pid);
+    spin_unlock(&soul_lock, flags);
+    return index ? &SLAB_OF(index)->pcb[ENTRY_OF(index)] : NULL;
+}
+
+/**
+ * Get the PCB in a slot, by index
+ *
+ * For run queue links, which hold slot indices. NULL for free slots.
+ */
+process_control_block_t* soul_core_pcb_at(uint32_t index) {
+    unsigned long flags = spin_lock(&soul_lock);
+    bool live = index != 0 && index < next_fresh && SLAB_OF(index)->live[ENTRY_OF(index)];
+    spin_unlock(&soul_lock, flags);
+    return live ? &SLAB_OF(index)->pcb[ENTRY_OF(index)] : NULL;
+}
+
+/**
+ * Get the spiritual metadata of a living process
+ */
+spiritual_metadata_t* soul_core_get_spirit(uint32_t pid) {
+    unsigned long flags = spin_lock(&soul_lock);
+    uint32_t index = pid_lookup(pid);
+    spin_unlock(&soul_lock, flags);
+    return index ? &SLAB_OF(index)->spirit[ENTRY_OF(index)] : NULL;
+}
+
+/**
+ * Get one slab of PCBs for a scan
+ */
+process_control_block_t* soul_core_pcb_slab(uint32_t slab) {
+    unsigned long flags = spin_lock(&soul_lock);
+    process_control_block_t *pcbs = slab < slab_count ? pcb_slabs[slab]->pcb : NULL;
+    spin_unlock(&soul_lock, flags);
+    return pcbs;
+}
+
+/**
+ * Get process table statistics
+ */
+void soul_core_get_stats(soul_core_stats_t *stats) {
+    if (!stats) return;
+    
+    unsigned long flags = spin_lock(&soul_lock);
+    *stats = soul_stats;
+    stats->slabs = slab_count;
+    spin_unlock(&soul_lock, flags);
 }
 
 /**
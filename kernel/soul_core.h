@@ -10,24 +10,51 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "astral_watch.h"
 
-/* Spiritual Metadata for Process Control Blocks */
+/* Spiritual Metadata, kept apart from the PCB; read on birth and by tools */
 typedef struct {
-    float moon_affinity;        /* 0.0 - 1.0 affinity to lunar cycles */
     char ritual_tag[64];        /* Tag identifying the ritual type */
-    int astral_priority;        /* Priority influenced by cosmic forces */
     char trigger_conditions[256]; /* DSL expression for awakening */
 } spiritual_metadata_t;
 
-/* Process Control Block (Extended) */
-typedef struct {
+/*
+ * Process Control Block: only what the scheduler reads each tick, one
+ * cache line per process. PCBs of a slab are contiguous, so a scan
+ * touches 64 bytes per process; the spiritual metadata sits in a
+ * parallel table at the same slot index.
+ */
+typedef struct __attribute__((aligned(64))) {
     uint32_t pid;
-    uint32_t state;             /* BIRTH, EXECUTING, DEATH */
-    spiritual_metadata_t spirit;
-    void *context;              /* CPU context */
+    uint16_t state;             /* BIRTH, EXECUTING, DEATH */
+    uint8_t cpu;                /* Whose run queue it is on */
+    uint8_t wake_pending;       /* Woken before it got to wait */
+    int32_t astral_priority;    /* Priority influenced by cosmic forces */
+    float moon_affinity;        /* 0.0 - 1.0 affinity to lunar cycles */
+    uint32_t run_next;          /* Run queue links, slot indices, 0 = none */
+    uint32_t run_prev;
     uint64_t astral_birth_tick; /* Cosmic tick at process creation */
+    uint64_t run_ticks;         /* Milliseconds spent executing */
+    uint64_t last_run_tick;
+    uint64_t wake_tick;         /* While DORMANT: when to run again */
+    void *context;              /* CPU context */
 } process_control_block_t;
 
+/*
+ * PIDs: the low SOUL_PID_INDEX_BITS select a PCB slot, the bits above
+ * count how often that slot has been reused. A dead PID never resolves
+ * again until its slot's generation wraps.
+ */
+#define SOUL_PID_INDEX_BITS     20      /* Up to 1M live processes */
+#define SOUL_PCB_SLAB_SIZE      256     /* PCBs per slab */
+
+typedef struct {
+    uint32_t live;
+    uint32_t capacity;          /* Slots in allocated slabs */
+    uint32_t slabs;
+    uint64_t births;
+} soul_core_stats_t;
+
 /* Process States */
 #define PROCESS_STATE_BIRTH     0x01
 #define PROCESS_STATE_EXECUTING 0x02
@@ -46,6 +73,11 @@ typedef struct {
     double moon_illumination;   /* 0.0 - 1.0 */
     char planet_positions[512]; /* JSON string */
     int numerology_day;
+    int local_day;              /* Day of month at the location */
+    double ascendant;           /* Ecliptic degrees */
+    double midheaven;
+    double moonrise;            /* Next within 24 h, 0 if none */
+    double moonset;
 } astral_snapshot_t;
 
 /* Kernel API Functions */
@@ -53,12 +85,23 @@ int spiro_query_astral_state(double timestamp, location_t location, astral_snaps
 int spiro_set_trigger(const char *name, const char *trigger_expr, const char *exec_path);
 int spiro_remove_trigger(const char *name);
 int spiro_subscribe_events(int event_fd, const char *filter_expr);
+int spiro_unsubscribe_events(int subscription);
+int spiro_read_events(int event_fd, astral_watch_event_t *events, int max_events);
 
 /* Soul Core Management */
 int soul_core_init(void);
 int soul_core_create_process(const char *ritual_tag, const char *trigger_conditions);
 int soul_core_destroy_process(uint32_t pid);
 process_control_block_t* soul_core_get_pcb(uint32_t pid);
+process_control_block_t* soul_core_pcb_at(uint32_t index);
+spiritual_metadata_t* soul_core_get_spirit(uint32_t pid);
+
+/*
+ * The SOUL_PCB_SLAB_SIZE PCBs of a slab, for scheduler scans; NULL past
+ * the last slab. Free slots are in state 0 or DEATH.
+ */
+process_control_block_t* soul_core_pcb_slab(uint32_t slab);
+void soul_core_get_stats(soul_core_stats_t *stats);
 
 /* Astral tick management */
 void soul_core_tick(void);
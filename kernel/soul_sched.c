@@ -0,0 +1,555 @@
+/**
+ * Soul Scheduler - Implementation
+ *
+ * A thread's context is the interrupt frame it was stopped in, saved
+ * on its own stack; pcb->context points at it. Switching is returning
+ * another thread's frame from an interrupt handler. A new thread gets
+ * a hand-made frame that "returns" into its entry point. FPU and SIMD
+ * registers are not in the frame: hal/fpu moves them only when the
+ * next thread actually uses them.
+ *
+ * Each CPU's run queue is only switched by that CPU, under its lock.
+ * Other CPUs take the lock to queue a new thread, to wake one, or to
+ * steal one that is waiting; a reschedule IPI then tells the owner.
+ * Locks nest run queue first, then the thread table and soul core.
+ */
+
+#include "freestanding.h"
+#include "soul_sched.h"
+#include "soul_core.h"
+#include "smp.h"
+#include "sync.h"
+#include "hal/interrupts.h"
+#include "hal/timer.h"
+#include "hal/fpu.h"
+
+#define SLOT_MASK   ((1u << SOUL_PID_INDEX_BITS) - 1)
+
+typedef struct {
+    uint32_t slot;                  /* PCB slot index, 0 = stack free */
+    uint32_t pid;
+    soul_entry_t entry;
+    void *arg;
+    bool dead;                      /* Exited, but its stack is in use until the next switch */
+} sched_thread_t;
+
+typedef struct {
+    spinlock_t lock;
+    uint32_t cpu;
+    bool online;
+    volatile bool kicked;           /* A reschedule IPI is on its way */
+    process_control_block_t idle_pcb;   /* Slot 0 on the ring: the boot or idle thread */
+    uint32_t current_slot;
+    int current_thread;             /* -1 = idle thread */
+    uint64_t slice_end;
+    bool exiting;                   /* The current thread has died */
+    uint32_t exit_next;             /* Where it was on the ring */
+    int reap;                       /* Dead thread to free at the next switch, -1 = none */
+    uint32_t threads;               /* On the ring, idle thread excluded */
+    uint64_t switches;
+    uint64_t steals;
+    uint64_t busy_ticks;
+} run_queue_t;
+
+static sched_thread_t threads[SOUL_SCHED_THREADS];
+static uint8_t stacks[SOUL_SCHED_THREADS][SOUL_SCHED_STACK_SIZE] __attribute__((aligned(16)));
+static fpu_context_t fpu_contexts[SOUL_SCHED_THREADS];     /* Loaded lazily, see hal/fpu.h */
+static run_queue_t run_queues[SMP_MAX_CPUS];
+static spinlock_t thread_lock = SPINLOCK_INIT;
+
+/* Interrupts must be off, or the thread may move before it is used */
+static inline run_queue_t *this_rq(void) {
+    return &run_queues[smp_cpu_index()];
+}
+
+static process_control_block_t *ring_pcb(run_queue_t *rq, uint32_t slot) {
+    return slot == 0 ? &rq->idle_pcb : soul_core_pcb_at(slot);
+}
+
+static int thread_of(uint32_t slot) {
+    for (int i = 0; i < SOUL_SCHED_THREADS; i++) {
+        if (threads[i].slot == slot && slot != 0) return i;
+    }
+    return -1;
+}
+
+static bool runnable(const process_control_block_t *pcb, uint64_t now) {
+    return pcb->state != PROCESS_STATE_DORMANT || pcb->wake_tick <= now;
+}
+
+/* Link a thread into the ring just ahead of `at` */
+static void ring_insert(run_queue_t *rq, uint32_t slot, uint32_t at) {
+    process_control_block_t *pcb = ring_pcb(rq, slot);
+    process_control_block_t *next = ring_pcb(rq, at);
+    process_control_block_t *previous = ring_pcb(rq, next->run_prev);
+    pcb->run_next = at;
+    pcb->run_prev = next->run_prev;
+    previous->run_next = slot;
+    next->run_prev = slot;
+    pcb->cpu = (uint8_t)rq->cpu;
+    rq->threads++;
+}
+
+static void ring_remove(run_queue_t *rq, uint32_t slot) {
+    process_control_block_t *pcb = ring_pcb(rq, slot);
+    ring_pcb(rq, pcb->run_prev)->run_next = pcb->run_next;
+    ring_pcb(rq, pcb->run_next)->run_prev = pcb->run_prev;
+    rq->threads--;
+}
+
+/*
+ * Another thread is waiting for this CPU: wake an idle CPU to take it.
+ * Registers held here for a waiting thread are saved first, or the
+ * thread could not move.
+ */
+static void sched_share(run_queue_t *rq) {
+    for (uint32_t cpu = 0; cpu < SMP_MAX_CPUS; cpu++) {
+        run_queue_t *other = &run_queues[cpu];
+        if (other == rq || !other->online || other->current_slot != 0 || other->kicked) {
+            continue;
+        }
+        fpu_park();
+        other->kicked = true;
+        smp_kick(cpu);
+        return;
+    }
+}
+
+/*
+ * Arm this CPU's timer for the next thing that is due: the earliest
+ * wake-up, or the end of this slice if another thread is waiting for
+ * the CPU. With neither, nothing is armed and the CPU sleeps until
+ * another interrupt.
+ */
+static void sched_arm(run_queue_t *rq, uint64_t now) {
+    uint64_t deadline = UINT64_MAX;
+    bool waiting = false;
+    uint32_t slot = 0;
+    do {
+        process_control_block_t *pcb = ring_pcb(rq, slot);
+        if (pcb->state == PROCESS_STATE_DORMANT && pcb->wake_tick > now) {
+            if (pcb->wake_tick < deadline) deadline = pcb->wake_tick;
+        } else if (slot != 0 && slot != rq->current_slot && rq->current_slot != 0) {
+            waiting = true;
+        }
+        slot = pcb->run_next;
+    } while (slot != 0);
+    
+    if (waiting) {
+        if (rq->slice_end < deadline) deadline = rq->slice_end;
+        sched_share(rq);
+    }
+    if (deadline != UINT64_MAX) {
+        smp_set_deadline(deadline);
+    }
+}
+
+/*
+ * Take a waiting thread from another CPU's ring, 0 if there is none.
+ * Locked queues are passed over rather than waited for, and so are
+ * threads whose registers another CPU still holds.
+ */
+static uint32_t sched_steal(run_queue_t *rq, uint64_t now) {
+    for (uint32_t i = 1; i < SMP_MAX_CPUS; i++) {
+        run_queue_t *victim = &run_queues[(rq->cpu + i) % SMP_MAX_CPUS];
+        unsigned long flags;
+        if (!victim->online || victim->threads == 0 || !spin_trylock(&victim->lock, &flags)) {
+            continue;
+        }
+        
+        /* A dying thread's neighbour is where its CPU goes on from */
+        uint32_t slot = victim->exiting ? 0 : victim->idle_pcb.run_next;
+        while (slot != 0) {
+            process_control_block_t *pcb = ring_pcb(victim, slot);
+            int thread = thread_of(slot);
+            if (slot != victim->current_slot && runnable(pcb, now) &&
+                thread >= 0 && !fpu_live(&fpu_contexts[thread])) {
+                ring_remove(victim, slot);
+                spin_unlock(&victim->lock, flags);
+                ring_insert(rq, slot, 0);
+                rq->steals++;
+                return slot;
+            }
+            slot = pcb->run_next;
+        }
+        spin_unlock(&victim->lock, flags);
+    }
+    return 0;
+}
+
+/*
+ * Save the current frame and resume the next runnable thread on the
+ * ring. The idle thread only runs when nothing else can, here or
+ * waiting on another CPU. Called with the run queue locked.
+ */
+static interrupt_frame_t *sched_switch(run_queue_t *rq, interrupt_frame_t *frame) {
+    uint64_t now = timer_get_ticks();
+    uint32_t from;
+    if (rq->reap >= 0) {
+        threads[rq->reap].dead = false;
+        rq->reap = -1;
+    }
+    if (rq->exiting) {
+        /* Still on the dead thread's stack, so it is freed next time */
+        fpu_release(&fpu_contexts[rq->current_thread]);
+        rq->reap = rq->current_thread;
+        rq->exiting = false;
+        from = rq->exit_next;
+    } else {
+        process_control_block_t *current = ring_pcb(rq, rq->current_slot);
+        current->context = frame;
+        current->run_ticks += now - current->last_run_tick;
+        if (rq->current_slot != 0) {
+            rq->busy_ticks += now - current->last_run_tick;
+        }
+        from = current->run_next;
+    }
+    
+    /* Walk the ring once, starting after the current thread */
+    uint32_t next_slot = 0;
+    uint32_t slot = from;
+    do {
+        process_control_block_t *pcb = ring_pcb(rq, slot);
+        if (slot != 0 && runnable(pcb, now)) {
+            next_slot = slot;
+            break;
+        }
+        slot = pcb->run_next;
+    } while (slot != from);
+    if (next_slot == 0 && smp_cpu_count() > 1) {
+        next_slot = sched_steal(rq, now);
+    }
+    
+    process_control_block_t *next = ring_pcb(rq, next_slot);
+    if (next->state != PROCESS_STATE_EXECUTING) {
+        next->state = PROCESS_STATE_EXECUTING;
+    }
+    next->last_run_tick = now;
+    rq->current_slot = next_slot;
+    rq->current_thread = thread_of(next_slot);
+    fpu_switch(rq->current_thread < 0 ? NULL : &fpu_contexts[rq->current_thread]);
+    rq->slice_end = now + SOUL_SCHED_SLICE_MS;
+    rq->switches++;
+    rq->kicked = false;
+    sched_arm(rq, now);
+    return (interrupt_frame_t *)next->context;
+}
+
+/* Preempt at the end of a slice, or leave idle when something is due */
+static interrupt_frame_t *sched_tick(interrupt_frame_t *frame) {
+    run_queue_t *rq = this_rq();
+    unsigned long flags = spin_lock(&rq->lock);
+    uint64_t now = timer_get_ticks();
+    if (rq->current_slot == 0 || now >= rq->slice_end) {
+        frame = sched_switch(rq, frame);
+    } else {
+        sched_arm(rq, now);
+    }
+    spin_unlock(&rq->lock, flags);
+    return frame;
+}
+
+/* IRQ0, taken by the boot CPU; the others have their local APIC timers */
+static interrupt_frame_t *sched_timer(interrupt_frame_t *frame) {
+    timer_tick();
+    return sched_tick(frame);
+}
+
+static interrupt_frame_t *sched_yield_handler(interrupt_frame_t *frame) {
+    run_queue_t *rq = this_rq();
+    unsigned long flags = spin_lock(&rq->lock);
+    frame = sched_switch(rq, frame);
+    spin_unlock(&rq->lock, flags);
+    return frame;
+}
+
+/* First code a new thread runs, entered from its hand-made frame */
+static void sched_thread_start(void) {
+    unsigned long flags = sync_irq_save();
+    sched_thread_t *thread = &threads[this_rq()->current_thread];
+    sync_irq_restore(flags);
+    thread->entry(thread->arg);
+    soul_sched_exit();
+}
+
+/**
+ * Initialize the scheduler
+ */
+int soul_sched_init(void) {
+    memset(threads, 0, sizeof(threads));
+    memset(run_queues, 0, sizeof(run_queues));
+    for (uint32_t cpu = 0; cpu < SMP_MAX_CPUS; cpu++) {
+        run_queue_t *rq = &run_queues[cpu];
+        rq->cpu = cpu;
+        rq->current_thread = -1;
+        rq->reap = -1;
+        rq->idle_pcb.state = PROCESS_STATE_EXECUTING;
+        rq->idle_pcb.cpu = (uint8_t)cpu;
+    }
+    run_queues[0].online = true;
+    
+    interrupts_set_handler(INTERRUPT_YIELD_VECTOR, sched_yield_handler);
+    interrupts_set_handler(INTERRUPT_APIC_TIMER, sched_tick);
+    interrupts_set_handler(INTERRUPT_RESCHEDULE, sched_tick);
+    irq_set_handler(0, sched_timer);
+    
+    printf("[SOUL SCHED] Round robin with %d ms slices, %d thread stacks\n",
+           SOUL_SCHED_SLICE_MS, SOUL_SCHED_THREADS);
+    return 0;
+}
+
+/**
+ * Idle an application processor until threads come its way
+ */
+void soul_sched_run_cpu(void) {
+    this_rq()->online = true;
+    interrupts_enable();
+    for (;;) {
+        __asm__ volatile ("hlt");
+    }
+}
+
+/**
+ * Give a process a thread and put it on a run queue
+ *
+ * The CPU with the fewest threads takes it; it runs there after every
+ * thread already queued.
+ */
+int soul_sched_spawn(uint32_t pid, soul_entry_t entry, void *arg) {
+    process_control_block_t *pcb = soul_core_get_pcb(pid);
+    if (!pcb || !entry) return -1;
+    
+    unsigned long flags = spin_lock(&thread_lock);
+    uint32_t slot = pid & SLOT_MASK;
+    int t = -1;
+    for (int i = 0; i < SOUL_SCHED_THREADS; i++) {
+        if (threads[i].slot == slot) t = -2;
+        if (threads[i].slot == 0 && !threads[i].dead && t == -1) t = i;
+    }
+    if (t < 0) {
+        spin_unlock(&thread_lock, flags);
+        fprintf(stderr, "[SOUL SCHED] Cannot give PID=%u a thread\n", pid);
+        return -1;
+    }
+    
+    interrupt_frame_t *frame = interrupt_frame_create(stacks[t] + SOUL_SCHED_STACK_SIZE, sched_thread_start);
+    
+    threads[t].slot = slot;
+    threads[t].pid = pid;
+    threads[t].entry = entry;
+    threads[t].arg = arg;
+    pcb->context = frame;
+    spin_unlock(&thread_lock, flags);
+    
+    run_queue_t *rq = &run_queues[0];
+    for (uint32_t cpu = 1; cpu < SMP_MAX_CPUS; cpu++) {
+        if (run_queues[cpu].online && run_queues[cpu].threads < rq->threads) {
+            rq = &run_queues[cpu];
+        }
+    }
+    
+    /* Link in just behind the current thread, or where a dying one was */
+    flags = spin_lock(&rq->lock);
+    ring_insert(rq, slot, rq->exiting ? rq->exit_next : rq->current_slot);
+    bool remote = rq->cpu != smp_cpu_index();
+    spin_unlock(&rq->lock, flags);
+    
+    if (remote) {
+        smp_kick(rq->cpu);
+    }
+    return 0;
+}
+
+/**
+ * Give up the rest of this slice
+ */
+void soul_sched_yield(void) {
+    __asm__ volatile ("int %0" : : "i"(INTERRUPT_YIELD_VECTOR) : "memory");
+}
+
+/**
+ * Sleep for at least ms milliseconds
+ *
+ * The thread is left off the CPU until then. If nothing else is due,
+ * the CPU halts with no timer interrupts at all.
+ */
+void soul_sched_sleep(uint32_t ms) {
+    if (!interrupts_enabled()) {
+        delay_ms(ms);
+        return;
+    }
+    
+    uint64_t deadline = timer_get_ticks() + ms;
+    while (timer_get_ticks() < deadline) {
+        unsigned long flags = sync_irq_save();
+        run_queue_t *rq = this_rq();
+        unsigned long held = spin_lock(&rq->lock);
+        process_control_block_t *current = ring_pcb(rq, rq->current_slot);
+        current->state = PROCESS_STATE_DORMANT;
+        current->wake_tick = deadline;
+        if (rq->current_slot != 0) {
+            spin_unlock(&rq->lock, held);
+            soul_sched_yield();
+            sync_irq_restore(flags);
+            continue;
+        }
+        
+        /* The idle thread halts in place */
+        sched_arm(rq, timer_get_ticks());
+        spin_unlock(&rq->lock, held);
+        __asm__ volatile ("sti; hlt" ::: "memory");
+        sync_irq_restore(flags);
+    }
+    
+    unsigned long flags = sync_irq_save();
+    run_queue_t *rq = this_rq();
+    ring_pcb(rq, rq->current_slot)->state = PROCESS_STATE_EXECUTING;
+    sync_irq_restore(flags);
+}
+
+/**
+ * Wait to be woken
+ *
+ * The thread stays DORMANT with no wake tick, so only a wake ends it.
+ * A wake from another CPU that came before the thread got here is
+ * kept, and ends the wait at once. An idle thread halts until the next
+ * interrupt instead.
+ */
+void soul_sched_wait(void) {
+    run_queue_t *rq = this_rq();
+    unsigned long held = spin_lock(&rq->lock);
+    if (rq->current_slot == 0) {
+        spin_unlock(&rq->lock, held);
+        __asm__ volatile ("sti; hlt; cli" ::: "memory");
+        return;
+    }
+    
+    process_control_block_t *current = ring_pcb(rq, rq->current_slot);
+    if (current->wake_pending) {
+        current->wake_pending = 0;
+        spin_unlock(&rq->lock, held);
+        return;
+    }
+    current->state = PROCESS_STATE_DORMANT;
+    current->wake_tick = UINT64_MAX;
+    spin_unlock(&rq->lock, held);
+    soul_sched_yield();
+}
+
+/**
+ * Wake a waiting process
+ *
+ * It runs at the end of the current slice, or within a millisecond if
+ * its CPU is idle. A process that is not waiting yet finds the wake
+ * when it does.
+ */
+void soul_sched_wake(uint32_t pid) {
+    unsigned long flags = sync_irq_save();
+    process_control_block_t *pcb = soul_core_get_pcb(pid);
+    if (!pcb) {
+        sync_irq_restore(flags);
+        return;
+    }
+    
+    /* Lock the queue it is on; a steal may move it before we get there */
+    run_queue_t *rq;
+    unsigned long held;
+    for (;;) {
+        rq = &run_queues[pcb->cpu];
+        held = spin_lock(&rq->lock);
+        if (pcb->cpu == rq->cpu) break;
+        spin_unlock(&rq->lock, held);
+    }
+    
+    if (pcb->state != PROCESS_STATE_DORMANT || pcb->wake_tick != UINT64_MAX) {
+        if (pcb->state != PROCESS_STATE_DORMANT) pcb->wake_pending = 1;
+        spin_unlock(&rq->lock, held);
+        sync_irq_restore(flags);
+        return;
+    }
+    
+    uint64_t now = timer_get_ticks();
+    pcb->wake_tick = now;
+    bool remote = rq->cpu != smp_cpu_index();
+    if (!remote) {
+        if (rq->current_slot == 0) {
+            smp_set_deadline(now);
+        } else {
+            sched_arm(rq, now);
+        }
+    }
+    spin_unlock(&rq->lock, held);
+    
+    /* Another CPU arms its own timer */
+    if (remote) {
+        smp_kick(rq->cpu);
+    }
+    sync_irq_restore(flags);
+}
+
+/**
+ * End the current process
+ */
+void soul_sched_exit(void) {
+    sync_irq_save();
+    run_queue_t *rq = this_rq();
+    int thread = rq->current_thread;
+    if (thread < 0) {
+        printf("[SOUL SCHED] The boot thread cannot exit\n");
+        for (;;) {
+            __asm__ volatile ("hlt");
+        }
+    }
+    
+    unsigned long held = spin_lock(&rq->lock);
+    process_control_block_t *current = ring_pcb(rq, rq->current_slot);
+    rq->exit_next = current->run_next;
+    ring_remove(rq, rq->current_slot);
+    current->context = NULL;        /* Off the ring, so soul core may free the slot */
+    rq->exiting = true;
+    spin_unlock(&rq->lock, held);
+    
+    uint32_t pid = threads[thread].pid;
+    held = spin_lock(&thread_lock);
+    threads[thread].slot = 0;
+    threads[thread].dead = true;
+    spin_unlock(&thread_lock, held);
+    soul_core_destroy_process(pid);
+    
+    /* The boot thread polls for exits; an idle CPU 0 would not notice */
+    if (rq->cpu != 0 && run_queues[0].current_slot == 0) {
+        smp_kick(0);
+    }
+    
+    soul_sched_yield();
+    for (;;) {
+        __asm__ volatile ("hlt");
+    }
+}
+
+/**
+ * Get the running process
+ */
+uint32_t soul_sched_current(void) {
+    unsigned long flags = sync_irq_save();
+    int thread = this_rq()->current_thread;
+    uint32_t pid = thread < 0 ? 0 : threads[thread].pid;
+    sync_irq_restore(flags);
+    return pid;
+}
+
+/**
+ * Get one CPU's scheduling counters
+ */
+int soul_sched_get_cpu_stats(uint32_t cpu, soul_sched_cpu_stats_t *stats) {
+    if (cpu >= SMP_MAX_CPUS || !run_queues[cpu].online || !stats) return -1;
+    
+    run_queue_t *rq = &run_queues[cpu];
+    unsigned long flags = spin_lock(&rq->lock);
+    stats->threads = rq->threads;
+    stats->switches = rq->switches;
+    stats->steals = rq->steals;
+    stats->busy_ticks = rq->busy_ticks;
+    spin_unlock(&rq->lock, flags);
+    return 0;
+}
@@ -0,0 +1,70 @@
+/**
+ * Soul Scheduler - The Turning Wheel
+ *
+ * Preemptive round robin over soul-core processes in the kernel. Each
+ * process given a thread gets its own stack; IRQ0 takes the CPU away
+ * every SOUL_SCHED_SLICE_MS and hands it to the next process on the
+ * run queue, which is the ring of run_next/run_prev links in the PCBs.
+ * The boot thread stays on the ring as slot 0 and is the idle thread.
+ *
+ * The clock is tickless: sleepers are DORMANT until their wake tick,
+ * and IRQ0 is armed only for the next wake-up or, when another thread
+ * is waiting, the end of the slice.
+ *
+ * With more than one CPU (see smp.h) every CPU has a ring of its own,
+ * with its idle thread as slot 0 and its local APIC timer in place of
+ * IRQ0. New threads go to the CPU with the fewest; an idle CPU takes
+ * a waiting thread from a busy one.
+ */
+
+#ifndef SOUL_SCHED_H
+#define SOUL_SCHED_H
+
+#include <stdint.h>
+
+#define SOUL_SCHED_THREADS      8       /* Threads with a stack at once */
+#define SOUL_SCHED_STACK_SIZE   16384
+#define SOUL_SCHED_SLICE_MS     10
+
+typedef void (*soul_entry_t)(void *arg);
+
+typedef struct {
+    uint32_t threads;               /* On this CPU's ring, idle thread excluded */
+    uint64_t switches;
+    uint64_t steals;                /* Threads taken from another CPU */
+    uint64_t busy_ticks;            /* Milliseconds not idle */
+} soul_sched_cpu_stats_t;
+
+/* Adopt the calling thread as slot 0 and take over IRQ0; call with interrupts off */
+int soul_sched_init(void);
+
+/* Become the calling application processor's idle thread; never returns */
+void soul_sched_run_cpu(void) __attribute__((noreturn));
+
+/* Run entry(arg) as the given process; it exits when entry returns */
+int soul_sched_spawn(uint32_t pid, soul_entry_t entry, void *arg);
+
+void soul_sched_yield(void);
+void soul_sched_sleep(uint32_t ms);
+
+/*
+ * Sleep until soul_sched_wake. Check the condition and call this with
+ * interrupts off, so a wake cannot slip in between; they are still off
+ * on return. A wake from another CPU in between is remembered instead.
+ * Wake-ups can be spurious, so check again.
+ */
+void soul_sched_wait(void);
+
+/* Make a waiting process runnable; safe from IRQ handlers */
+void soul_sched_wake(uint32_t pid);
+
+/* End the calling process and its thread */
+void soul_sched_exit(void) __attribute__((noreturn));
+
+/* PID of the running process, 0 for the boot thread */
+uint32_t soul_sched_current(void);
+
+/* -1 past the last CPU online */
+int soul_sched_get_cpu_stats(uint32_t cpu, soul_sched_cpu_stats_t *stats);
+
+#endif /* SOUL_SCHED_H */
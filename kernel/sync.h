@@ -0,0 +1,125 @@
+/**
+ * Sync Primitives - Quiet Agreements
+ *
+ * A sequence lock for one writer and many lock-free readers, and a
+ * small spinlock. In the kernel both disable interrupts while held so
+ * a holder is never preempted; in userland they are plain atomics.
+ */
+
+#ifndef SYNC_H
+#define SYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef USERLAND_BUILD
+#include <sched.h>
+#endif
+
+typedef struct {
+    volatile uint32_t sequence;     /* Odd while a write is in progress */
+} seqlock_t;
+
+typedef struct {
+    volatile uint8_t locked;
+} spinlock_t;
+
+#define SEQLOCK_INIT  {0}
+#define SPINLOCK_INIT {0}
+
+static inline void sync_barrier(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+#ifdef USERLAND_BUILD
+static inline unsigned long sync_irq_save(void) {
+    return 0;
+}
+
+static inline void sync_irq_restore(unsigned long flags) {
+    (void)flags;
+}
+
+static inline void sync_relax(void) {
+    sched_yield();
+}
+#else
+static inline unsigned long sync_irq_save(void) {
+    unsigned long flags;
+    __asm__ volatile ("pushf; pop %0; cli" : "=r"(flags) :: "memory");
+    return flags;
+}
+
+static inline void sync_irq_restore(unsigned long flags) {
+    if (flags & 0x200) {
+        __asm__ volatile ("sti" ::: "memory");
+    }
+}
+
+static inline void sync_relax(void) {
+    __asm__ volatile ("pause");
+}
+#endif
+
+/* Writer side: interrupts stay off between begin and end in the kernel */
+static inline unsigned long seqlock_write_begin(seqlock_t *lock) {
+    unsigned long flags = sync_irq_save();
+    lock->sequence++;
+    sync_barrier();
+    return flags;
+}
+
+static inline void seqlock_write_end(seqlock_t *lock, unsigned long flags) {
+    sync_barrier();
+    lock->sequence++;
+    sync_irq_restore(flags);
+}
+
+/* Reader side */
+static inline uint32_t seqlock_read_begin(const seqlock_t *lock) {
+    uint32_t sequence = lock->sequence;
+    sync_barrier();
+    return sequence;
+}
+
+/* Classic check: any write started or finished since begin */
+static inline bool seqlock_read_retry(const seqlock_t *lock, uint32_t start) {
+    sync_barrier();
+    return (start & 1) || lock->sequence != start;
+}
+
+/*
+ * Double-buffered check: the buffer published at `start` is only reused
+ * by the second write after it, so one completed write is harmless.
+ */
+static inline bool seqlock_read_stale(const seqlock_t *lock, uint32_t start) {
+    sync_barrier();
+    return lock->sequence - (start & ~1u) > 2;
+}
+
+static inline unsigned long spin_lock(spinlock_t *lock) {
+    unsigned long flags = sync_irq_save();
+    while (__atomic_test_and_set(&lock->locked, __ATOMIC_ACQUIRE)) {
+        sync_irq_restore(flags);
+        sync_relax();
+        flags = sync_irq_save();
+    }
+    return flags;
+}
+
+/* Take the lock only if it is free; interrupts are left as they were if not */
+static inline bool spin_trylock(spinlock_t *lock, unsigned long *flags) {
+    *flags = sync_irq_save();
+    if (__atomic_test_and_set(&lock->locked, __ATOMIC_ACQUIRE)) {
+        sync_irq_restore(*flags);
+        return false;
+    }
+    return true;
+}
+
+static inline void spin_unlock(spinlock_t *lock, unsigned long flags) {
+    __atomic_clear(&lock->locked, __ATOMIC_RELEASE);
+    sync_irq_restore(flags);
+}
+
+#endif /* SYNC_H */
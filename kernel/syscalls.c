@@ -8,6 +8,8 @@
 #include "soul_core.h"
 #include "ephemeris_provider.h"
 #include "destiny_engine.h"
+#include "astral_locale.h"
+#include "astral_watch.h"
 
 /**
  * Query the astral state at a given time and location
@@ -27,6 +29,16 @@ int spiro_query_astral_state(double timestamp, location_t location, astral_snaps
     snapshot->moon_illumination = data.moon_illumination;
     snapshot->numerology_day = data.numerology_day;
     
+    local_sky_t sky;
+    if (astral_locale_query(location.latitude, location.longitude, time, &sky) != 0) {
+        return -1;
+    }
+    snapshot->local_day = sky.local_day;
+    snapshot->ascendant = sky.ascendant;
+    snapshot->midheaven = sky.midheaven;
+    snapshot->moonrise = (double)sky.moonrise;
+    snapshot->moonset = (double)sky.moonset;
+    
     /* Format planet positions as JSON string */
     int offset = 0;
     offset += snprintf(snapshot->planet_positions + offset, 
@@ -63,10 +75,27 @@ int spiro_remove_trigger(const char *name) {
 }
 
 /**
- * Subscribe to events (stub)
+ * Subscribe to changes of an /astral path or a trigger expression
  */
 int spiro_subscribe_events(int event_fd, const char *filter_expr) {
-    printf("[SYSCALL] Event subscription registered: fd=%d, filter='%s'\n", 
-           event_fd, filter_expr);
-    return 0;
+    int subscription = astral_watch_subscribe(event_fd, filter_expr);
+    if (subscription >= 0) {
+        printf("[SYSCALL] Event subscription %d registered: fd=%d, filter='%s'\n",
+               subscription, event_fd, filter_expr);
+    }
+    return subscription;
+}
+
+/**
+ * Cancel an event subscription
+ */
+int spiro_unsubscribe_events(int subscription) {
+    return astral_watch_unsubscribe(subscription);
+}
+
+/**
+ * Collect the events queued for a channel
+ */
+int spiro_read_events(int event_fd, astral_watch_event_t *events, int max_events) {
+    return astral_watch_read(event_fd, events, max_events);
 }
@@ -0,0 +1,210 @@
+/**
+ * Work Queues - Implementation
+ *
+ * Each queue is a fixed ring of items, so enqueueing never allocates
+ * and takes the same few instructions from any context. The worker
+ * takes one item at a time under the lock and runs it with interrupts
+ * on.
+ */
+
+#include "freestanding.h"
+#include "work_queue.h"
+#include "soul_core.h"
+#include "soul_sched.h"
+#include "sync.h"
+#include "hal/timer.h"
+
+typedef struct {
+    work_fn_t fn;
+    void *arg;
+    uint64_t queued_ns;
+} work_item_t;
+
+typedef struct {
+    work_item_t items[WORK_QUEUE_DEPTH];
+    uint32_t head;              /* Next item to run */
+    work_queue_stats_t stats;   /* stats.pending items follow head */
+} work_queue_t;
+
+static work_queue_t queues[WORK_QUEUES_MAX];
+static int queue_count = 0;
+static uint32_t worker_pid = 0;
+static volatile bool stopping = false;
+static spinlock_t work_lock = SPINLOCK_INIT;
+
+/* Highest priority queue with work; the first created wins ties */
+static work_queue_t *work_next_queue(void) {
+    work_queue_t *best = NULL;
+    for (int i = 0; i < queue_count; i++) {
+        if (queues[i].stats.pending > 0 &&
+            (!best || queues[i].stats.priority < best->stats.priority)) {
+            best = &queues[i];
+        }
+    }
+    return best;
+}
+
+/* Run up to WORK_BATCH_MAX items from one queue; false if all were empty */
+static bool work_run_batch(void) {
+    unsigned long flags = spin_lock(&work_lock);
+    work_queue_t *queue = work_next_queue();
+    if (!queue) {
+        spin_unlock(&work_lock, flags);
+        return false;
+    }
+    queue->stats.batches++;
+    
+    for (int n = 0; n < WORK_BATCH_MAX && queue->stats.pending > 0; n++) {
+        work_item_t item = queue->items[queue->head];
+        queue->head = (queue->head + 1) % WORK_QUEUE_DEPTH;
+        queue->stats.pending--;
+        spin_unlock(&work_lock, flags);
+        
+        uint64_t start = timer_now_ns();
+        item.fn(item.arg);
+        uint64_t end = timer_now_ns();
+        
+        flags = spin_lock(&work_lock);
+        uint64_t latency = start - item.queued_ns;
+        queue->stats.latency_total_ns += latency;
+        if (latency > queue->stats.latency_max_ns) queue->stats.latency_max_ns = latency;
+        if (end - start > queue->stats.run_max_ns) queue->stats.run_max_ns = end - start;
+        queue->stats.completed++;
+    }
+    
+    spin_unlock(&work_lock, flags);
+    return true;
+}
+
+/* The worker process: run batches, wait when every queue is empty */
+static void work_worker(void *arg) {
+    (void)arg;
+    for (;;) {
+        while (work_run_batch()) {
+            /* Rescan after each batch so higher queues go first */
+        }
+        
+        unsigned long flags = sync_irq_save();
+        while (!work_next_queue() && !stopping) {
+            soul_sched_wait();
+        }
+        bool done = !work_next_queue();
+        sync_irq_restore(flags);
+        if (done) return;
+    }
+}
+
+/**
+ * Initialize the work queues
+ */
+int work_queue_init(void) {
+    memset(queues, 0, sizeof(queues));
+    queue_count = 0;
+    worker_pid = 0;
+    stopping = false;
+    return 0;
+}
+
+/**
+ * Create a queue
+ */
+int work_queue_create(const char *name, work_priority_t priority) {
+    if (!name) return -1;
+    
+    unsigned long flags = spin_lock(&work_lock);
+    if (queue_count == WORK_QUEUES_MAX) {
+        spin_unlock(&work_lock, flags);
+        fprintf(stderr, "[WORK QUEUE] No room for queue '%s'\n", name);
+        return -1;
+    }
+    
+    int id = queue_count++;
+    work_queue_t *queue = &queues[id];
+    memset(queue, 0, sizeof(*queue));
+    strncpy(queue->stats.name, name, sizeof(queue->stats.name) - 1);
+    queue->stats.priority = priority;
+    spin_unlock(&work_lock, flags);
+    return id;
+}
+
+/**
+ * Start the worker
+ */
+int work_queue_start(void) {
+    int pid = soul_core_create_process("soul_worker", "deferred work");
+    if (pid < 0) return -1;
+    if (soul_sched_spawn((uint32_t)pid, work_worker, NULL) != 0) {
+        soul_core_destroy_process((uint32_t)pid);
+        return -1;
+    }
+    
+    worker_pid = (uint32_t)pid;
+    printf("[WORK QUEUE] Worker PID=%u serving %d queue(s)\n", worker_pid, queue_count);
+    return 0;
+}
+
+/**
+ * Queue an item
+ */
+int work_queue_enqueue(int queue, work_fn_t fn, void *arg) {
+    if (queue < 0 || queue >= queue_count || !fn) return -1;
+    
+    uint64_t now = timer_now_ns();
+    unsigned long flags = spin_lock(&work_lock);
+    work_queue_t *q = &queues[queue];
+    if (q->stats.pending == WORK_QUEUE_DEPTH) {
+        q->stats.dropped++;
+        spin_unlock(&work_lock, flags);
+        return -1;
+    }
+    
+    work_item_t *item = &q->items[(q->head + q->stats.pending) % WORK_QUEUE_DEPTH];
+    item->fn = fn;
+    item->arg = arg;
+    item->queued_ns = now;
+    q->stats.pending++;
+    q->stats.enqueued++;
+    if (q->stats.pending > q->stats.depth_max) q->stats.depth_max = q->stats.pending;
+    spin_unlock(&work_lock, flags);
+    
+    if (worker_pid != 0) {
+        soul_sched_wake(worker_pid);
+    }
+    return 0;
+}
+
+/**
+ * Stop the worker
+ *
+ * It runs everything still pending first. Without a worker the caller
+ * runs it.
+ */
+int work_queue_stop(void) {
+    if (worker_pid == 0) {
+        while (work_run_batch()) {
+            /* Until every queue is empty */
+        }
+        return 0;
+    }
+    
+    stopping = true;
+    soul_sched_wake(worker_pid);
+    while (soul_core_get_pcb(worker_pid)) {
+        soul_sched_sleep(1);
+    }
+    worker_pid = 0;
+    stopping = false;
+    return 0;
+}
+
+/**
+ * Get a queue's counters
+ */
+int work_queue_get_stats(int queue, work_queue_stats_t *stats) {
+    if (queue < 0 || queue >= queue_count || !stats) return -1;
+    
+    unsigned long flags = spin_lock(&work_lock);
+    *stats = queues[queue].stats;
+    spin_unlock(&work_lock, flags);
+    return 0;
+}
@@ -0,0 +1,58 @@
+/**
+ * Work Queues - Deferred Offerings
+ *
+ * Bottom halves for the kernel. IRQ handlers and the cosmic tick hand
+ * small items (render the astral state, flush a log, report an event)
+ * to a queue and return at once; one worker process runs them later,
+ * a batch at a time, highest priority queue first.
+ */
+
+#ifndef WORK_QUEUE_H
+#define WORK_QUEUE_H
+
+#include <stdint.h>
+
+#define WORK_QUEUES_MAX     8
+#define WORK_QUEUE_DEPTH    32      /* Pending items per queue */
+#define WORK_BATCH_MAX      8       /* Items run before higher queues are checked again */
+
+typedef enum {
+    WORK_PRIORITY_HIGH = 0,
+    WORK_PRIORITY_NORMAL = 1,
+    WORK_PRIORITY_LOW = 2
+} work_priority_t;
+
+typedef void (*work_fn_t)(void *arg);
+
+typedef struct {
+    char name[16];
+    work_priority_t priority;
+    uint32_t pending;
+    uint32_t depth_max;         /* Most items ever pending at once */
+    uint64_t enqueued;
+    uint64_t completed;
+    uint64_t dropped;           /* Enqueued while full */
+    uint64_t batches;
+    uint64_t latency_total_ns;  /* Enqueue to start of run */
+    uint64_t latency_max_ns;
+    uint64_t run_max_ns;        /* Longest single item */
+} work_queue_stats_t;
+
+/* Reset every queue */
+int work_queue_init(void);
+
+/* Returns the queue id, or -1 when the table is full */
+int work_queue_create(const char *name, work_priority_t priority);
+
+/* Start the worker process; items queued before this wait for it */
+int work_queue_start(void);
+
+/* Queue fn(arg); safe from IRQ handlers. -1 if the queue is full */
+int work_queue_enqueue(int queue, work_fn_t fn, void *arg);
+
+/* Run what is still pending, then end the worker */
+int work_queue_stop(void);
+
+int work_queue_get_stats(int queue, work_queue_stats_t *stats);
+
+#endif /* WORK_QUEUE_H */
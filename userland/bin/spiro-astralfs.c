@@ -0,0 +1,591 @@
+/**
+ * spiro-astralfs - The Sky Made Visible
+ *
+ * Mounts the /astral virtual file system on a Linux host through FUSE.
+ * Files are served from the astral FS zero-copy views; the kernel page
+ * cache keeps them between ticks and each tick invalidates only the files
+ * whose contents actually changed. poll() reports POLLPRI on a file that
+ * changed since the handle last read it, so scripts can wait instead of
+ * re-reading or forking spiroctl. Trigger, profile, at/ and history/
+ * entries have no cache and are rendered on every read.
+ *
+ * Every tick is also kept in the compressed astral archive, served
+ * under history/; -o history=<file> loads it at start and saves it on
+ * unmount.
+ *
+ * Usage: spiro-astralfs [-f] [-o tick=<seconds>] [-o history=<file>] <mountpoint>
+ */
+
+#define FUSE_USE_VERSION 34
+
+#include <fuse_lowlevel.h>
+#include "../../kernel/ephemeris_provider.h"
+#include "../../kernel/ephemeris_online.h"
+#include "../../kernel/astral_fs.h"
+#include "../../kernel/astral_archive.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <pthread.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define ASTRALFS_ROOT_INO     1
+#define ASTRALFS_MAX_NODES    1024
+#define ASTRALFS_MAX_HANDLES  1024
+#define ASTRALFS_DEFAULT_TICK 5     /* Seconds, same as the kernel tick loop */
+#define ASTRALFS_MAX_READ     (128 * 1024)   /* FUSE default max_read */
+
+/*
+ * One path under the mount root; inode = index + 2. Nodes are added as
+ * lookups and listings reach them and stay for the life of the mount.
+ */
+typedef struct {
+    char path[192];                 /* Relative to the root, e.g. "triggers/dawn/expression" */
+    fuse_ino_t parent;
+    bool is_dir;
+    bool cached;                    /* Rendered file with a zero-copy view and page cache */
+    uint32_t hash;                  /* FNV-1a of the last rendered contents */
+    uint32_t changes;               /* Bumped whenever the contents change */
+    time_t mtime;
+} astralfs_node_t;
+
+/* An open file; remembers which change it last read and who is polling */
+typedef struct {
+    bool in_use;
+    fuse_ino_t ino;
+    uint32_t seen;
+    struct fuse_pollhandle *poll_handle;
+} astralfs_handle_t;
+
+typedef struct {
+    unsigned int tick;
+    char *history;                  /* Archive file, or NULL */
+} astralfs_options_t;
+
+static astralfs_node_t nodes[ASTRALFS_MAX_NODES];
+static int node_count = 0;
+static astralfs_handle_t handles[ASTRALFS_MAX_HANDLES];
+static pthread_mutex_t handle_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static struct fuse_session *session = NULL;
+static double tick_seconds = ASTRALFS_DEFAULT_TICK;
+static pthread_t tick_thread;
+static pthread_mutex_t tick_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t tick_wake = PTHREAD_COND_INITIALIZER;
+static bool tick_running = false;
+
+static const struct fuse_opt astralfs_opts[] = {
+    { "tick=%u", offsetof(astralfs_options_t, tick), 0 },
+    { "history=%s", offsetof(astralfs_options_t, history), 0 },
+    FUSE_OPT_END
+};
+
+static uint32_t content_hash(const char *data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static astralfs_node_t *node_for(fuse_ino_t ino) {
+    if (ino < 2 || ino >= (fuse_ino_t)node_count + 2) return NULL;
+    return &nodes[ino - 2];
+}
+
+static void node_path(const astralfs_node_t *node, char *path, size_t size) {
+    snprintf(path, size, "%s/%s", ASTRAL_ROOT, node->path);
+}
+
+/* Hash of a cached file's current contents, taken from one consistent view */
+static uint32_t node_hash(const astralfs_node_t *node) {
+    char path[256];
+    astral_fs_view_t view;
+    uint32_t hash = node->hash;
+    node_path(node, path, sizeof(path));
+
+    do {
+        if (astral_fs_view_file(path, &view) != 0) break;
+        /* The size covers changes past the cached head of large files */
+        hash = content_hash(view.data, view.length) ^ (uint32_t)view.size;
+    } while (!astral_fs_view_valid(&view));
+
+    return hash;
+}
+
+/**
+ * Find or add the node for name inside directory parent
+ *
+ * type is the dirent type when a listing already named the entry, or -1
+ * to probe: a path the astral FS can list is a directory, one it can read
+ * is a file. Instants under at/ and ranges under history/ resolve this way
+ * even when they are not listed. Returns the inode, or 0 when the path
+ * does not exist or the table is full.
+ */
+static fuse_ino_t astralfs_intern(fuse_ino_t parent, const char *name, int type) {
+    char relative[sizeof(nodes[0].path)];
+    if (parent == ASTRALFS_ROOT_INO) {
+        snprintf(relative, sizeof(relative), "%s", name);
+    } else {
+        astralfs_node_t *dir = node_for(parent);
+        if (!dir || !dir->is_dir) return 0;
+        if ((size_t)snprintf(relative, sizeof(relative), "%s/%s", dir->path, name) >= sizeof(relative)) {
+            return 0;
+        }
+    }
+
+    for (int i = 0; i < node_count; i++) {
+        if (strcmp(nodes[i].path, relative) == 0) return (fuse_ino_t)i + 2;
+    }
+    if (node_count >= ASTRALFS_MAX_NODES) return 0;
+
+    char path[256];
+    char probe;
+    uint32_t cursor = 0;
+    astral_dirent_t dirent;
+    astral_fs_view_t view;
+    snprintf(path, sizeof(path), "%s/%s", ASTRAL_ROOT, relative);
+
+    astralfs_node_t node;
+    memset(&node, 0, sizeof(node));
+    strcpy(node.path, relative);
+    node.parent = parent;
+    node.mtime = time(NULL);
+    if (type == ASTRAL_DIRENT_DIR ||
+        (type < 0 && astral_fs_readdir(path, &cursor, &dirent, 1) >= 0)) {
+        node.is_dir = true;
+    } else if (astral_fs_view_file(path, &view) == 0) {
+        node.cached = true;
+        node.hash = node_hash(&node);
+    } else if (type < 0 && astral_fs_read_at(path, 0, &probe, 1) < 0) {
+        return 0;
+    }
+
+    /* Publish the node before the count so the tick thread never sees it half-built */
+    pthread_mutex_lock(&handle_lock);
+    nodes[node_count] = node;
+    node_count++;
+    pthread_mutex_unlock(&handle_lock);
+
+    return (fuse_ino_t)node_count + 1;
+}
+
+static void fill_stat(fuse_ino_t ino, struct stat *st) {
+    memset(st, 0, sizeof(*st));
+    st->st_ino = ino;
+
+    astralfs_node_t *node = node_for(ino);
+    if (!node || node->is_dir) {
+        st->st_mode = S_IFDIR | 0555;
+        st->st_nlink = 2;
+        st->st_mtime = node ? node->mtime : time(NULL);
+        return;
+    }
+
+    char path[256];
+    astral_fs_view_t view;
+    node_path(node, path, sizeof(path));
+
+    st->st_mode = S_IFREG | 0444;
+    st->st_nlink = 1;
+    pthread_mutex_lock(&handle_lock);
+    st->st_mtime = node->mtime;
+    pthread_mutex_unlock(&handle_lock);
+    /* Uncached files are rendered per read and report size 0, like procfs */
+    if (node->cached && astral_fs_view_file(path, &view) == 0) {
+        st->st_size = (off_t)view.size;
+    }
+}
+
+/**
+ * Re-render every file for the new state and invalidate the changed ones
+ *
+ * Unchanged files keep their page cache; changed ones are dropped from it
+ * and any handle polling them is woken.
+ */
+static void astralfs_publish_changes(void) {
+    pthread_mutex_lock(&handle_lock);
+    int count = node_count;
+    pthread_mutex_unlock(&handle_lock);
+
+    for (int i = 0; i < count; i++) {
+        astralfs_node_t *node = &nodes[i];
+        if (!node->cached) continue;
+
+        uint32_t hash = node_hash(node);
+        if (hash == node->hash) continue;
+
+        fuse_ino_t ino = (fuse_ino_t)i + 2;
+        pthread_mutex_lock(&handle_lock);
+        node->hash = hash;
+        node->changes++;
+        node->mtime = time(NULL);
+        for (int h = 0; h < ASTRALFS_MAX_HANDLES; h++) {
+            astralfs_handle_t *handle = &handles[h];
+            if (handle->in_use && handle->ino == ino && handle->poll_handle) {
+                fuse_lowlevel_notify_poll(handle->poll_handle);
+                fuse_pollhandle_destroy(handle->poll_handle);
+                handle->poll_handle = NULL;
+            }
+        }
+        pthread_mutex_unlock(&handle_lock);
+
+        if (session) {
+            fuse_lowlevel_notify_inval_inode(session, ino, 0, 0);
+        }
+    }
+}
+
+static void astralfs_update(void) {
+    celestial_data_t data;
+    if (ephemeris_get_current_data(&data) == 0) {
+        astral_fs_update_state(&data);
+    }
+}
+
+static void *astralfs_tick_loop(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&tick_lock);
+    while (tick_running) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += (time_t)tick_seconds;
+        pthread_cond_timedwait(&tick_wake, &tick_lock, &deadline);
+        if (!tick_running) break;
+
+        pthread_mutex_unlock(&tick_lock);
+        astralfs_update();
+        astralfs_publish_changes();
+        pthread_mutex_lock(&tick_lock);
+    }
+    pthread_mutex_unlock(&tick_lock);
+
+    return NULL;
+}
+
+/* FUSE operations */
+
+static void astralfs_lookup(fuse_req_t req, fuse_ino_t parent, const char *name) {
+    fuse_ino_t ino = astralfs_intern(parent, name, -1);
+    if (ino == 0) {
+        fuse_reply_err(req, ENOENT);
+        return;
+    }
+
+    struct fuse_entry_param entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.ino = ino;
+    entry.attr_timeout = tick_seconds;
+    entry.entry_timeout = tick_seconds;
+    fill_stat(entry.ino, &entry.attr);
+    fuse_reply_entry(req, &entry);
+}
+
+static void astralfs_getattr(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi) {
+    (void)fi;
+
+    if (ino != ASTRALFS_ROOT_INO && !node_for(ino)) {
+        fuse_reply_err(req, ENOENT);
+        return;
+    }
+
+    struct stat st;
+    fill_stat(ino, &st);
+    fuse_reply_attr(req, &st, tick_seconds);
+}
+
+static void astralfs_readdir(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off,
+                             struct fuse_file_info *fi) {
+    (void)fi;
+
+    astralfs_node_t *dir = node_for(ino);
+    if (ino != ASTRALFS_ROOT_INO && (!dir || !dir->is_dir)) {
+        fuse_reply_err(req, ENOTDIR);
+        return;
+    }
+
+    char path[256];
+    if (dir) {
+        node_path(dir, path, sizeof(path));
+    } else {
+        snprintf(path, sizeof(path), "%s", ASTRAL_ROOT);
+    }
+
+    /* Offsets: 0 ".", 1 "..", then 2 + the astral FS cursor of the next entry */
+    char buffer[4096];
+    size_t used = 0;
+    if (size > sizeof(buffer)) size = sizeof(buffer);
+
+    for (off_t index = off; index < 2; index++) {
+        struct stat st;
+        memset(&st, 0, sizeof(st));
+        st.st_ino = (index == 0 || !dir) ? ino : dir->parent;
+        st.st_mode = S_IFDIR;
+
+        size_t needed = fuse_add_direntry(req, buffer + used, size - used,
+                                          index == 0 ? "." : "..", &st, index + 1);
+        if (needed > size - used) {
+            fuse_reply_buf(req, buffer, used);
+            return;
+        }
+        used += needed;
+    }
+
+    uint32_t cursor = off > 2 ? (uint32_t)(off - 2) : 0;
+    astral_dirent_t dirent;
+    while (astral_fs_readdir(path, &cursor, &dirent, 1) == 1) {
+        struct stat st;
+        memset(&st, 0, sizeof(st));
+        st.st_ino = astralfs_intern(ino, dirent.name, (int)dirent.type);
+        st.st_mode = dirent.type == ASTRAL_DIRENT_DIR ? S_IFDIR : S_IFREG;
+
+        size_t needed = fuse_add_direntry(req, buffer + used, size - used, dirent.name,
+                                          &st, (off_t)cursor + 2);
+        if (needed > size - used) break;
+        used += needed;
+    }
+
+    fuse_reply_buf(req, buffer, used);
+}
+
+static void astralfs_open(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi) {
+    astralfs_node_t *node = node_for(ino);
+    if (!node) {
+        fuse_reply_err(req, ENOENT);
+        return;
+    }
+    if (node->is_dir) {
+        fuse_reply_err(req, EISDIR);
+        return;
+    }
+    if ((fi->flags & O_ACCMODE) != O_RDONLY) {
+        fuse_reply_err(req, EACCES);
+        return;
+    }
+
+    pthread_mutex_lock(&handle_lock);
+    int slot = -1;
+    for (int h = 0; h < ASTRALFS_MAX_HANDLES; h++) {
+        if (!handles[h].in_use) {
+            slot = h;
+            break;
+        }
+    }
+    if (slot >= 0) {
+        handles[slot].in_use = true;
+        handles[slot].ino = ino;
+        handles[slot].seen = node->changes;
+        handles[slot].poll_handle = NULL;
+    }
+    pthread_mutex_unlock(&handle_lock);
+
+    if (slot < 0) {
+        fuse_reply_err(req, EMFILE);
+        return;
+    }
+
+    /*
+     * Cached files only change on a tick, which invalidates the page cache
+     * itself; the others have no known size and bypass it.
+     */
+    fi->fh = (uint64_t)slot;
+    if (node->cached) {
+        fi->keep_cache = 1;
+    } else {
+        fi->direct_io = 1;
+    }
+    fuse_reply_open(req, fi);
+}
+
+static void astralfs_read(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off,
+                          struct fuse_file_info *fi) {
+    astralfs_node_t *node = node_for(ino);
+    if (!node || node->is_dir) {
+        fuse_reply_err(req, EISDIR);
+        return;
+    }
+
+    /* The session loop is single-threaded, so one buffer serves every read */
+    static char buffer[ASTRALFS_MAX_READ];
+    char path[256];
+    node_path(node, path, sizeof(path));
+
+    if (size > sizeof(buffer)) size = sizeof(buffer);
+    int length = astral_fs_read_at(path, (uint64_t)off, buffer, size);
+    if (length < 0) {
+        /* A trigger or profile removed since the lookup */
+        fuse_reply_err(req, node->cached ? EIO : ENOENT);
+        return;
+    }
+
+    pthread_mutex_lock(&handle_lock);
+    handles[fi->fh].seen = node->changes;
+    pthread_mutex_unlock(&handle_lock);
+
+    fuse_reply_buf(req, buffer, (size_t)length);
+}
+
+static void astralfs_release(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi) {
+    (void)ino;
+
+    pthread_mutex_lock(&handle_lock);
+    astralfs_handle_t *handle = &handles[fi->fh];
+    if (handle->poll_handle) {
+        fuse_pollhandle_destroy(handle->poll_handle);
+    }
+    memset(handle, 0, sizeof(*handle));
+    pthread_mutex_unlock(&handle_lock);
+
+    fuse_reply_err(req, 0);
+}
+
+/**
+ * Always readable; POLLPRI once the file changed since this handle read it
+ */
+static void astralfs_poll(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi,
+                          struct fuse_pollhandle *ph) {
+    astralfs_node_t *node = node_for(ino);
+    unsigned revents = POLLIN | POLLRDNORM;
+
+    pthread_mutex_lock(&handle_lock);
+    astralfs_handle_t *handle = &handles[fi->fh];
+    if (node && handle->seen != node->changes) {
+        revents |= POLLPRI;
+    }
+    if (ph) {
+        if (handle->poll_handle) {
+            fuse_pollhandle_destroy(handle->poll_handle);
+        }
+        handle->poll_handle = ph;
+    }
+    pthread_mutex_unlock(&handle_lock);
+
+    fuse_reply_poll(req, revents);
+}
+
+static const struct fuse_lowlevel_ops astralfs_ops = {
+    .lookup  = astralfs_lookup,
+    .getattr = astralfs_getattr,
+    .readdir = astralfs_readdir,
+    .open    = astralfs_open,
+    .read    = astralfs_read,
+    .release = astralfs_release,
+    .poll    = astralfs_poll,
+};
+
+static void print_usage(const char *prog_name) {
+    printf("usage: %s [options] <mountpoint>\n\n", prog_name);
+    printf("    -o tick=<seconds>      refresh period and cache timeout (default %d)\n\n",
+           ASTRALFS_DEFAULT_TICK);
+    printf("    -o history=<file>      load the tick archive at start, save it on unmount\n\n");
+    fuse_cmdline_help();
+    fuse_lowlevel_help();
+}
+
+int main(int argc, char *argv[]) {
+    struct fuse_args args = FUSE_ARGS_INIT(argc, argv);
+    struct fuse_cmdline_opts opts;
+    astralfs_options_t options = { ASTRALFS_DEFAULT_TICK, NULL };
+    int result = 1;
+
+    if (fuse_opt_parse(&args, &options, astralfs_opts, NULL) != 0) return 1;
+    if (fuse_parse_cmdline(&args, &opts) != 0) return 1;
+
+    if (opts.show_help) {
+        print_usage(argv[0]);
+        result = 0;
+        goto out_args;
+    }
+    if (opts.show_version) {
+        fuse_lowlevel_version();
+        result = 0;
+        goto out_args;
+    }
+    if (!opts.mountpoint) {
+        print_usage(argv[0]);
+        goto out_args;
+    }
+    if (options.tick > 0) tick_seconds = options.tick;
+
+    /* fuse_daemonize() changes to /, so a relative archive path must be resolved first */
+    if (options.history && options.history[0] != '/') {
+        char *absolute = realpath(options.history, NULL);
+        if (!absolute) {
+            /* Not there yet: it is created on unmount, next to where it was named */
+            char cwd[PATH_MAX];
+            if (!getcwd(cwd, sizeof(cwd))) {
+                fprintf(stderr, "[ASTRALFS] Cannot resolve history path: %s\n", options.history);
+                goto out_args;
+            }
+            size_t length = strlen(cwd) + strlen(options.history) + 2;
+            absolute = malloc(length);
+            if (!absolute) goto out_args;
+            snprintf(absolute, length, "%s/%s", cwd, options.history);
+        }
+        free(options.history);
+        options.history = absolute;
+    }
+
+    /* Online when a source is configured, like spiroctl */
+    bool online = getenv("SPIRO_EPHEMERIS_SOURCE") != NULL;
+    if (online) {
+        ephemeris_online_set_source(getenv("SPIRO_EPHEMERIS_SOURCE"));
+    }
+    astral_fs_init();
+    if (options.history && astral_archive_load(options.history) == 0) {
+        astral_archive_stats_t stats;
+        astral_archive_get_stats(&stats);
+        printf("[ASTRALFS] Loaded %llu archived ticks\n", (unsigned long long)stats.rows);
+    }
+    astral_fs_mount(ASTRAL_ROOT);
+
+    session = fuse_session_new(&args, &astralfs_ops, sizeof(astralfs_ops), NULL);
+    if (!session) goto out_astral;
+    if (fuse_set_signal_handlers(session) != 0) goto out_session;
+    if (fuse_session_mount(session, opts.mountpoint) != 0) goto out_signals;
+
+    fuse_daemonize(opts.foreground);
+
+    /*
+     * Daemonizing forks and only the calling thread survives, so the
+     * ephemeris prefetch thread and the tick thread start afterwards.
+     */
+    ephemeris_init(online);
+    astralfs_update();
+    tick_running = true;
+    pthread_create(&tick_thread, NULL, astralfs_tick_loop, NULL);
+
+    result = fuse_session_loop(session) != 0;
+
+    pthread_mutex_lock(&tick_lock);
+    tick_running = false;
+    pthread_cond_signal(&tick_wake);
+    pthread_mutex_unlock(&tick_lock);
+    pthread_join(tick_thread, NULL);
+    ephemeris_shutdown();
+
+    if (options.history) astral_archive_save(options.history);
+
+    fuse_session_unmount(session);
+out_signals:
+    fuse_remove_signal_handlers(session);
+out_session:
+    fuse_session_destroy(session);
+out_astral:
+    astral_fs_unmount();
+    astral_fs_shutdown();
+out_args:
+    free(options.history);
+    free(opts.mountpoint);
+    fuse_opt_free_args(&args);
+    return result;
+}
@@ -6,31 +6,99 @@
 
 #include "../lib/libspiro.h"
 #include "../../kernel/ephemeris_provider.h"
+#include "../../kernel/ephemeris_online.h"
+#include "../../kernel/ephemeris_fixed.h"
+#include "../../kernel/body_catalog.h"
+#include "../../kernel/aspect_engine.h"
 #include "../../kernel/astral_fs.h"
+#include "../../kernel/astral_watch.h"
+#include "../../kernel/audit_log.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <math.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
 
 void print_usage(const char *prog_name) {
     printf("SpiritOS Control Utility\n");
     printf("\nUsage: %s <command> [options]\n", prog_name);
     printf("\nCommands:\n");
-    printf("  ephemeris sync              - Synchronize with cosmic sources\n");
+    printf("  ephemeris sync [source]     - Synchronize with cosmic sources\n");
+    printf("  ephemeris stats [source]    - Show online cache freshness and latency\n");
+    printf("  ephemeris check-fixed       - Compare fixed-point path against doubles\n");
+    printf("  ephemeris check-step        - Compare stepping both ways against the closed form\n");
+    printf("  ephemeris check-aspects     - Compare aspect sweep against all pairs\n");
     printf("  ephemeris show              - Display current celestial state\n");
+    printf("  ephemeris bodies [catalog]  - List catalog bodies and their signs\n");
     printf("  trigger add <name> <expr> <path> - Add a trigger\n");
     printf("  trigger list                - List all triggers\n");
     printf("  trigger remove <name>       - Remove a trigger\n");
     printf("  simulate <name> <timestamp> - Simulate ritual at given time\n");
-    printf("  astral read <file>          - Read from /astral virtual FS\n");
+    printf("  sky <lat> <lon> [timestamp] - Show ascendant, houses and moonrise\n");
+    printf("  astral read <file>...       - Read from /astral virtual FS\n");
+    printf("  astral ls [dir]             - List an /astral directory\n");
+    printf("  astral watch [--step s] [--ticks n] <filter>... - Print changes each tick\n");
+    printf("  audit query [--from t] [--to t] [--trigger name] [--log file] - List awakenings\n");
     printf("  profile load <name>         - Load a profile\n");
     printf("  profile save <name>         - Save current profile\n");
     printf("  help                        - Show this help\n");
 }
 
-int cmd_ephemeris_sync(void) {
+/* Source URI from the command line or $SPIRO_EPHEMERIS_SOURCE */
+static int select_ephemeris_source(const char *uri) {
+    if (!uri) uri = getenv("SPIRO_EPHEMERIS_SOURCE");
+    if (!uri) {
+        fprintf(stderr, "No ephemeris source (pass file:<dir> or unix:<socket>, "
+                        "or set SPIRO_EPHEMERIS_SOURCE)\n");
+        return -1;
+    }
+    return ephemeris_online_set_source(uri);
+}
+
+int cmd_ephemeris_sync(const char *uri) {
     printf("Synchronizing ephemeris data...\n");
-    return ephemeris_sync_online();
+    if (select_ephemeris_source(uri) != 0) return -1;
+    
+    ephemeris_init(true);
+    int result = ephemeris_sync_online();
+    ephemeris_shutdown();
+    return result;
+}
+
+int cmd_ephemeris_stats(const char *uri) {
+    if (select_ephemeris_source(uri) != 0) return -1;
+    
+    ephemeris_init(true);
+    ephemeris_sync_online();
+    
+    celestial_data_t data;
+    ephemeris_get_current_data(&data);
+    
+    ephemeris_online_stats_t stats;
+    ephemeris_online_get_stats(&stats);
+    ephemeris_shutdown();
+    
+    time_t now = time(NULL);
+    printf("\n=== Ephemeris Online Cache ===\n");
+    printf("Fetches: %llu (%llu failed)\n",
+           (unsigned long long)stats.fetch_count,
+           (unsigned long long)stats.fetch_failures);
+    printf("Latency: last %llu us, max %llu us\n",
+           (unsigned long long)stats.last_latency_us,
+           (unsigned long long)stats.max_latency_us);
+    if (stats.last_fetch) {
+        printf("Freshness: %lds since last fetch\n", (long)(now - stats.last_fetch));
+        printf("Coverage: %ld .. %ld\n", (long)stats.coverage_start, (long)stats.coverage_end);
+    } else {
+        printf("Freshness: never fetched\n");
+    }
+    printf("Reads: %llu online, %llu simulated\n\n",
+           (unsigned long long)stats.online_hits,
+           (unsigned long long)stats.offline_fallbacks);
+    return 0;
 }
 
 int cmd_ephemeris_show(void) {
@@ -59,6 +127,253 @@ int cmd_ephemeris_show(void) {
     return 0;
 }
 
+int cmd_ephemeris_bodies(const char *path) {
+    if (!path) path = getenv("SPIRO_BODY_CATALOG");
+    if (!path) path = BODY_CATALOG_DEFAULT;
+    
+    body_catalog_init();
+    if (body_catalog_load_file(path) < 0) {
+        printf("(no catalog at %s, showing built-in bodies)\n", path);
+    }
+    
+    time_t now = time(NULL);
+    body_subset_t all;
+    body_subset_clear(&all);
+    for (int i = 0; i < body_catalog_count(); i++) {
+        body_subset_add(&all, i);
+    }
+    body_catalog_compute(now, &all);
+    
+    printf("\n=== Body Catalog (%d bodies) ===\n", body_catalog_count());
+    for (int i = 0; i < body_catalog_count(); i++) {
+        printf("  %-24s %-9s %-12s (%.1f°)\n",
+               body_catalog_name(i),
+               body_catalog_kind_name(body_catalog_kind(i)),
+               ephemeris_sign_name(body_catalog_sign(i, now)),
+               body_catalog_degree(i, now));
+    }
+    printf("\n");
+    return 0;
+}
+
+/* Angular distance on a circle of the given size */
+static double wrap_distance(double a, double b, double turn) {
+    double d = fabs(a - b);
+    return d > turn / 2 ? turn - d : d;
+}
+
+/* Distance from x to the nearest multiple of step */
+static double boundary_distance(double x, double step) {
+    double r = fmod(x, step);
+    return r < step - r ? r : step - r;
+}
+
+int cmd_ephemeris_check_fixed(void) {
+    /* Tolerances: well above 2^-32 turn quantization, well below display precision */
+    const double phase_tol = 1e-6;          /* turns */
+    const double degree_tol = 1e-5;         /* degrees */
+    const double illumination_tol = 1e-4;
+    
+    /* 2000-01-07 .. 2038-01-19: the range a 32-bit kernel time_t covers */
+    const time_t first = 947182440;
+    const time_t last = 2147483647;
+    const int samples = 200000;
+    
+    double max_phase = 0, max_degree = 0, max_illumination = 0;
+    int failures = 0;
+    uint32_t lcg = 12345;
+    
+    for (int n = 0; n < samples; n++) {
+        lcg = lcg * 1664525u + 1013904223u;
+        time_t t = first + (time_t)((double)lcg / 4294967296.0 * (double)(last - first));
+        
+        celestial_data_t data;
+        ephemeris_get_data_at_time(t, &data);
+        double phase = ephemeris_calculate_moon_phase(t);
+        
+        ephemeris_angle_t fixed_phase = ephemeris_fixed_moon_phase(t);
+        double e = wrap_distance(ephemeris_fixed_to_turns(fixed_phase), phase, 1.0);
+        if (e > max_phase) max_phase = e;
+        if (e > phase_tol) failures++;
+        
+        e = fabs(ephemeris_fixed_illumination(fixed_phase) / (double)EPHEMERIS_FIXED_ONE -
+                 data.moon_illumination);
+        if (e > max_illumination) max_illumination = e;
+        if (e > illumination_tol) failures++;
+        
+        if (ephemeris_fixed_moon_phase_enum(fixed_phase) != data.moon_phase &&
+            boundary_distance(phase + 0.0625, 0.125) > phase_tol) {
+            failures++;
+        }
+        
+        for (int b = 0; b < data.planet_count; b++) {
+            ephemeris_angle_t longitude = ephemeris_fixed_planet_longitude(b, t);
+            double degree = data.planets[b].degree;
+            
+            e = wrap_distance(ephemeris_fixed_to_degrees(longitude), degree, 360.0);
+            if (e > max_degree) max_degree = e;
+            if (e > degree_tol) failures++;
+            
+            int sign = ((int)degree / 30) % 12;
+            if (ephemeris_fixed_sign_index(longitude) != sign &&
+                boundary_distance(degree, 30.0) > degree_tol) {
+                failures++;
+            }
+        }
+    }
+    
+    printf("Fixed-point vs double over %d samples:\n", samples);
+    printf("  moon phase    max error %.3g turns (tolerance %.0e)\n", max_phase, phase_tol);
+    printf("  illumination  max error %.3g (tolerance %.0e)\n", max_illumination, illumination_tol);
+    printf("  longitude     max error %.3g deg (tolerance %.0e)\n", max_degree, degree_tol);
+    printf("  %s (%d mismatches)\n", failures == 0 ? "PASS" : "FAIL", failures);
+    
+    return failures == 0 ? 0 : 1;
+}
+
+/* Compare provider output with the double closed form; returns mismatches */
+static int compare_closed_form(const celestial_data_t *data, double *max_phase,
+                               double *max_degree) {
+    const double illumination_tol = 1e-4;
+    const double degree_tol = 1e-5;
+    int failures = 0;
+    
+    double phase = ephemeris_calculate_moon_phase(data->timestamp);
+    double illumination = 1.0 - fabs(phase - 0.5) * 2.0;
+    double e = fabs(data->moon_illumination - illumination);
+    if (e > *max_phase) *max_phase = e;
+    if (e > illumination_tol) failures++;
+    if (data->moon_phase != ephemeris_get_moon_phase_enum(phase) &&
+        boundary_distance(phase + 0.0625, 0.125) > 1e-6) {
+        failures++;
+    }
+    
+    celestial_data_t expected;
+    ephemeris_simulate_planets(data->timestamp, &expected);
+    for (int b = 0; b < expected.planet_count; b++) {
+        double degree = expected.planets[b].degree;
+        e = wrap_distance(data->planets[b].degree, degree, 360.0);
+        if (e > *max_degree) *max_degree = e;
+        if (e > degree_tol) failures++;
+        if (strcmp(data->planets[b].sign, expected.planets[b].sign) != 0 &&
+            boundary_distance(degree, 30.0) > degree_tol) {
+            failures++;
+        }
+    }
+    return failures;
+}
+
+int cmd_ephemeris_check_step(void) {
+    const int walks = 200;
+    const int steps = 2000;
+    double max_illumination = 0, max_degree = 0;
+    int failures = 0;
+    uint32_t lcg = 24680;
+    
+    for (int w = 0; w < walks; w++) {
+        /* The first walk runs backward across the reference new moon */
+        time_t t = 947182440 + 3600;
+        long dt = -3600;
+        if (w > 0) {
+            lcg = lcg * 1664525u + 1013904223u;
+            t = 946684800 + (time_t)(lcg % 1100000000u);
+            lcg = lcg * 1664525u + 1013904223u;
+            dt = 1 + (long)(lcg % 3600u);
+            if (w % 2) dt = -dt;
+        }
+        
+        ephemeris_state_t state;
+        ephemeris_state_init(&state, t);
+        for (int n = 0; n < steps; n++) {
+            ephemeris_step(&state, dt);
+            failures += compare_closed_form(&state.data, &max_illumination, &max_degree);
+            
+            celestial_data_t data;
+            ephemeris_get_data_at_time(state.data.timestamp, &data);
+            failures += compare_closed_form(&data, &max_illumination, &max_degree);
+            if (data.numerology_day != state.data.numerology_day) failures++;
+        }
+    }
+    
+    printf("Stepped and closed-form ephemeris vs doubles: %d walks of %d steps\n", walks, steps);
+    printf("  illumination  max error %.3g\n", max_illumination);
+    printf("  longitude     max error %.3g deg\n", max_degree);
+    printf("  %s (%d mismatches)\n", failures == 0 ? "PASS" : "FAIL", failures);
+    return failures == 0 ? 0 : 1;
+}
+
+int cmd_ephemeris_check_aspects(void) {
+    const int extra_bodies = 300;
+    const int samples = 20;
+    int failures = 0;
+    int checked = 0;
+    uint32_t lcg = 54321;
+    
+    /* Synthetic bodies on top of the built-ins; keeps the table under its cap */
+    body_catalog_init();
+    for (int i = 0; i < extra_bodies; i++) {
+        char name[BODY_NAME_MAX];
+        snprintf(name, sizeof(name), "Probe %d", i);
+        lcg = lcg * 1664525u + 1013904223u;
+        double period = 100.0 + (double)lcg / 4294967296.0 * 100000.0;
+        lcg = lcg * 1664525u + 1013904223u;
+        double epoch = (double)lcg / 4294967296.0 * 360.0;
+        if (body_catalog_add(name, BODY_ASTEROID, period, epoch) < 0) {
+            fprintf(stderr, "Cannot add %s\n", name);
+            return 1;
+        }
+    }
+    
+    int n = body_catalog_count();
+    body_subset_t all;
+    body_subset_clear(&all);
+    for (int i = 0; i < n; i++) body_subset_add(&all, i);
+    
+    for (int s = 0; s < samples; s++) {
+        lcg = lcg * 1664525u + 1013904223u;
+        time_t t = 946684800 + (time_t)(lcg % 1200000000u);
+        
+        celestial_data_t data;
+        ephemeris_get_data_at_time(t, &data);
+        const aspect_table_t *table = aspect_engine_snapshot(&data, &all);
+        if (table->truncated) {
+            fprintf(stderr, "Aspect table truncated at %d entries\n", table->count);
+            return 1;
+        }
+        
+        /* Every pair, the slow way */
+        int expected = 0;
+        for (int a = 0; a < n; a++) {
+            double la = a < data.planet_count ? data.planets[a].degree : body_catalog_degree(a, t);
+            for (int b = a + 1; b < n; b++) {
+                double lb = b < data.planet_count ? data.planets[b].degree : body_catalog_degree(b, t);
+                double separation = wrap_distance(la, lb, 360.0);
+                
+                aspect_type_t want = ASPECT_NONE;
+                double best = 0.0;
+                for (int k = ASPECT_CONJUNCTION; k < ASPECT_TYPE_COUNT; k++) {
+                    static const double angles[] = {0, 0, 180, 120, 90};
+                    double off = fabs(separation - angles[k]);
+                    if (off <= aspect_engine_get_orb((aspect_type_t)k) &&
+                        (want == ASPECT_NONE || off < best)) {
+                        want = (aspect_type_t)k;
+                        best = off;
+                    }
+                }
+                
+                if (want != ASPECT_NONE) expected++;
+                if (aspect_engine_between(&data, a, b) != want) failures++;
+                checked++;
+            }
+        }
+        if (expected != table->count) failures++;
+    }
+    
+    printf("Aspect sweep vs all pairs: %d bodies, %d pair checks\n", n, checked);
+    printf("  %s (%d mismatches)\n", failures == 0 ? "PASS" : "FAIL", failures);
+    return failures == 0 ? 0 : 1;
+}
+
 int cmd_trigger_add(const char *name, const char *expr, const char *path) {
     printf("Adding trigger: %s\n", name);
     printf("  Expression: %s\n", expr);
@@ -122,15 +437,104 @@ int cmd_simulate(const char *name, const char *timestamp_str) {
     return result;
 }
 
-int cmd_astral_read(const char *file) {
-    char buffer[4096];
+static void print_event_time(const char *label, time_t when) {
+    if (when == 0) {
+        printf("%s: none within 24h\n", label);
+    } else {
+        printf("%s: %s", label, ctime(&when));
+    }
+}
+
+int cmd_sky(const char *lat_str, const char *lon_str, const char *timestamp_str) {
+    spiro_location_t location = {atof(lat_str), atof(lon_str)};
+    time_t timestamp = timestamp_str ? atol(timestamp_str) : time(NULL);
+    spiro_astral_state_t state;
+    
+    if (spiro_get_astral_state(timestamp, location, &state) != 0) {
+        fprintf(stderr, "Failed to get astral state\n");
+        return -1;
+    }
+    
+    printf("\n=== Local Sky (%.4f, %.4f) ===\n", location.latitude, location.longitude);
+    printf("Timestamp: %s", ctime(&timestamp));
+    printf("Local Day: %d\n", state.local_day);
+    printf("Ascendant: %s (%.2f°)\n",
+           ephemeris_sign_name((int)state.ascendant / 30), state.ascendant);
+    printf("Midheaven: %s (%.2f°)\n",
+           ephemeris_sign_name((int)state.midheaven / 30), state.midheaven);
+    print_event_time("Moonrise", state.moonrise);
+    print_event_time("Moonset", state.moonset);
+    printf("\nHouse Cusps:\n");
+    for (int h = 0; h < 12; h++) {
+        printf("  %2d: %-12s (%.2f°)\n", h + 1,
+               ephemeris_sign_name((int)state.houses[h] / 30), state.houses[h]);
+    }
+    printf("\n");
+    return 0;
+}
+
+/* Decode a binary /astral image with libspiro's validating readers */
+static int print_astral_binary(const char *file, const char *image, size_t length) {
+    const astral_bin_header_t *header;
+    const void *payload;
+    
+    /* at/<time>/snapshot.bin decodes like snapshot.bin */
+    const char *slash = strrchr(file, '/');
+    if (slash) file = slash + 1;
+    
+    if (strcmp(file, "planet_positions.bin") == 0) {
+        if (spiro_astral_bin_parse(image, length, ASTRAL_BIN_PLANETS, &header, &payload) != 0) return -1;
+        const astral_bin_planet_t *planets = payload;
+        for (uint32_t i = 0; i < header->record_count; i++) {
+            printf("%-8s %-12s %7.2f\n", ephemeris_planet_name(planets[i].body),
+                   ephemeris_sign_name(planets[i].sign), planets[i].longitude);
+        }
+    } else if (strcmp(file, "snapshot.bin") == 0) {
+        if (spiro_astral_bin_parse(image, length, ASTRAL_BIN_SNAPSHOT, &header, &payload) != 0) return -1;
+        const astral_bin_snapshot_t *snapshot = payload;
+        printf("timestamp: %lld\n", (long long)snapshot->timestamp);
+        printf("moon_phase: %s\n", ephemeris_moon_phase_name((moon_phase_t)snapshot->moon_phase));
+        printf("moon_illumination: %.4f\n", snapshot->moon_illumination);
+        printf("numerology_day: %u\n", snapshot->numerology_day);
+        for (uint32_t i = 0; i < snapshot->planet_count && i < EPHEMERIS_PLANET_COUNT; i++) {
+            printf("%s: %.2f\n", ephemeris_planet_name((int)i), snapshot->longitudes[i]);
+        }
+    } else if (strcmp(file, "history.bin") == 0) {
+        astral_history_columns_t columns;
+        if (spiro_astral_history_columns(image, length, &columns) != 0) return -1;
+        printf("# timestamp moon_illumination moon_phase numerology_day\n");
+        for (int r = 0; r < columns.count; r++) {
+            printf("%lld %.4f %u %u\n", (long long)columns.timestamps[r],
+                   columns.moon_illumination[r], columns.moon_phase[r], columns.numerology_day[r]);
+        }
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+static int astral_read_one(const char *file) {
+    char buffer[ASTRAL_RENDER_MAX];
     char path[256];
     
     snprintf(path, sizeof(path), "/astral/%s", file);
     
     int bytes = astral_fs_read(path, buffer, sizeof(buffer));
-    if (bytes > 0) {
-        printf("%s", buffer);
+    size_t name_len = strlen(file);
+    if (bytes > 0 && name_len > 4 && strcmp(file + name_len - 4, ".bin") == 0) {
+        if (print_astral_binary(file, buffer, (size_t)bytes) != 0) {
+            fprintf(stderr, "Invalid binary image: %s\n", path);
+            return -1;
+        }
+        return 0;
+    } else if (bytes > 0) {
+        /* Text files may be longer than the buffer; page through the rest */
+        uint64_t offset = 0;
+        int length;
+        while ((length = astral_fs_read_at(path, offset, buffer, sizeof(buffer))) > 0) {
+            fwrite(buffer, 1, (size_t)length, stdout);
+            offset += (uint64_t)length;
+        }
         return 0;
     } else {
         fprintf(stderr, "Failed to read: %s\n", path);
@@ -138,6 +542,182 @@ int cmd_astral_read(const char *file) {
     }
 }
 
+/* Read several files in one process, e.g. a series of at/<time>/ instants */
+int cmd_astral_read(int count, char *files[]) {
+    celestial_data_t data;
+    if (ephemeris_get_current_data(&data) == 0) {
+        astral_fs_update_state(&data);
+    }
+    astral_fs_mount(ASTRAL_ROOT);
+    
+    int result = 0;
+    for (int i = 0; i < count; i++) {
+        if (astral_read_one(files[i]) != 0) result = -1;
+    }
+    return result;
+}
+
+int cmd_astral_ls(const char *dir) {
+    char path[256];
+    snprintf(path, sizeof(path), "/astral/%s", dir ? dir : "");
+    
+    astral_fs_mount(ASTRAL_ROOT);
+    
+    /* Page through the directory; nothing is allocated per entry */
+    astral_dirent_t entries[32];
+    uint32_t cursor = 0;
+    int count;
+    while ((count = astral_fs_readdir(path, &cursor, entries, 32)) > 0) {
+        for (int i = 0; i < count; i++) {
+            printf("%s%s\n", entries[i].name, entries[i].type == ASTRAL_DIRENT_DIR ? "/" : "");
+        }
+    }
+    if (count < 0) {
+        fprintf(stderr, "Not a directory: %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+/* Watch paths or expressions; --step replays simulated time without sleeping */
+int cmd_astral_watch(int argc, char *argv[]) {
+    long step = 0;
+    long ticks = -1;
+    int first = 0;
+    
+    while (first < argc && strncmp(argv[first], "--", 2) == 0) {
+        if (strcmp(argv[first], "--step") == 0 && first + 1 < argc) {
+            step = atol(argv[first + 1]);
+        } else if (strcmp(argv[first], "--ticks") == 0 && first + 1 < argc) {
+            ticks = atol(argv[first + 1]);
+        } else {
+            fprintf(stderr, "Unknown watch option: %s\n", argv[first]);
+            return -1;
+        }
+        first += 2;
+    }
+    if (first >= argc) {
+        fprintf(stderr, "Nothing to watch\n");
+        return -1;
+    }
+    
+    int event_fd = eventfd(0, EFD_NONBLOCK);
+    if (event_fd < 0) {
+        perror("eventfd");
+        return -1;
+    }
+    
+    time_t now = time(NULL);
+    celestial_data_t data;
+    ephemeris_get_data_at_time(now, &data);
+    astral_fs_update_state(&data);
+    astral_fs_mount(ASTRAL_ROOT);
+    
+    const char *filters[ASTRAL_WATCH_MAX];
+    for (int i = first; i < argc; i++) {
+        int subscription = astral_watch_subscribe(event_fd, argv[i]);
+        if (subscription < 0) {
+            close(event_fd);
+            return -1;
+        }
+        filters[subscription] = argv[i];
+    }
+    
+    for (long tick = 0; ticks < 0 || tick < ticks; tick++) {
+        if (step > 0) {
+            now += step;
+        } else {
+            sleep(5);
+            now = time(NULL);
+        }
+        ephemeris_get_data_at_time(now, &data);
+        astral_fs_update_state(&data);
+        astral_watch_dispatch(&data);
+        
+        uint64_t changes;
+        if (read(event_fd, &changes, sizeof(changes)) != sizeof(changes)) continue;
+        
+        astral_watch_event_t events[ASTRAL_WATCH_MAX];
+        int count = astral_watch_read(event_fd, events, ASTRAL_WATCH_MAX);
+        for (int i = 0; i < count; i++) {
+            const char *filter = filters[events[i].subscription];
+            printf("%ld %s: ", (long)events[i].timestamp, filter);
+            if (filter[0] == '/') {
+                char buffer[ASTRAL_RENDER_MAX];
+                astral_fs_read(filter, buffer, sizeof(buffer));
+                printf("%s", buffer);
+            } else {
+                printf("%s\n", events[i].value ? "true" : "false");
+            }
+        }
+        fflush(stdout);
+    }
+    
+    close(event_fd);
+    return 0;
+}
+
+/* Awakenings from the audit log at --log or $SPIRO_AUDIT_LOG */
+int cmd_audit_query(int argc, char *argv[]) {
+    static const char *MODE_NAMES[] = { "native", "sandbox", "observer" };
+    time_t from = (time_t)(~0UL >> 1);
+    time_t to = from;
+    const char *trigger = NULL;
+    const char *path = getenv("SPIRO_AUDIT_LOG");
+    from = -from - 1;
+    
+    for (int i = 0; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Missing value for %s\n", argv[i]);
+            return -1;
+        }
+        if (strcmp(argv[i], "--from") == 0) {
+            from = (time_t)atol(argv[i + 1]);
+        } else if (strcmp(argv[i], "--to") == 0) {
+            to = (time_t)atol(argv[i + 1]);
+        } else if (strcmp(argv[i], "--trigger") == 0) {
+            trigger = argv[i + 1];
+        } else if (strcmp(argv[i], "--log") == 0) {
+            path = argv[i + 1];
+        } else {
+            fprintf(stderr, "Unknown audit option: %s\n", argv[i]);
+            return -1;
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "No audit log (pass --log <file> or set SPIRO_AUDIT_LOG)\n");
+        return -1;
+    }
+    if (access(path, R_OK) != 0) {
+        fprintf(stderr, "Cannot read audit log: %s\n", path);
+        return -1;
+    }
+    audit_log_set_path(path);
+    
+    static audit_record_t records[256];
+    uint32_t cursor = 0;
+    int total = 0;
+    int scanned = 0;
+    int count;
+    audit_log_stats_t stats;
+    printf("# seq tick timestamp trigger priority mode latency_us exit\n");
+    while ((count = audit_log_query(from, to, trigger, &cursor, records, 256)) > 0) {
+        audit_log_get_stats(&stats);
+        scanned += stats.scanned;
+        for (int i = 0; i < count; i++) {
+            const audit_record_t *r = &records[i];
+            printf("%u %llu %ld %s %d %s %u %d\n", r->seq, (unsigned long long)r->tick,
+                   (long)r->timestamp, r->trigger, r->priority,
+                   r->mode < 3 ? MODE_NAMES[r->mode] : "?", r->spawn_latency_us, r->exit_status);
+        }
+        total += count;
+    }
+    audit_log_get_stats(&stats);
+    scanned += stats.scanned;
+    printf("# %d record(s); %d of %d segment(s) decoded\n", total, scanned, stats.segments);
+    return 0;
+}
+
 int cmd_profile_load(const char *name) {
     printf("Loading profile: %s\n", name);
     return spiro_load_profile(name);
@@ -162,12 +742,22 @@ int main(int argc, char *argv[]) {
     
     if (strcmp(cmd, "ephemeris") == 0) {
         if (argc < 3) {
-            fprintf(stderr, "Usage: %s ephemeris <sync|show>\n", argv[0]);
+            fprintf(stderr, "Usage: %s ephemeris <sync|show|stats|bodies>\n", argv[0]);
             result = 1;
         } else if (strcmp(argv[2], "sync") == 0) {
-            result = cmd_ephemeris_sync();
+            result = cmd_ephemeris_sync(argc > 3 ? argv[3] : NULL);
+        } else if (strcmp(argv[2], "stats") == 0) {
+            result = cmd_ephemeris_stats(argc > 3 ? argv[3] : NULL);
+        } else if (strcmp(argv[2], "check-fixed") == 0) {
+            result = cmd_ephemeris_check_fixed();
+        } else if (strcmp(argv[2], "check-step") == 0) {
+            result = cmd_ephemeris_check_step();
+        } else if (strcmp(argv[2], "check-aspects") == 0) {
+            result = cmd_ephemeris_check_aspects();
         } else if (strcmp(argv[2], "show") == 0) {
             result = cmd_ephemeris_show();
+        } else if (strcmp(argv[2], "bodies") == 0) {
+            result = cmd_ephemeris_bodies(argc > 3 ? argv[3] : NULL);
         } else {
             fprintf(stderr, "Unknown ephemeris command: %s\n", argv[2]);
             result = 1;
@@ -203,12 +793,30 @@ int main(int argc, char *argv[]) {
         } else {
             result = cmd_simulate(argv[2], argv[3]);
         }
+    } else if (strcmp(cmd, "sky") == 0) {
+        if (argc < 4) {
+            fprintf(stderr, "Usage: %s sky <lat> <lon> [timestamp]\n", argv[0]);
+            result = 1;
+        } else {
+            result = cmd_sky(argv[2], argv[3], argc > 4 ? argv[4] : NULL);
+        }
     } else if (strcmp(cmd, "astral") == 0) {
-        if (argc < 4 || strcmp(argv[2], "read") != 0) {
-            fprintf(stderr, "Usage: %s astral read <file>\n", argv[0]);
+        if (argc >= 4 && strcmp(argv[2], "read") == 0) {
+            result = cmd_astral_read(argc - 3, argv + 3);
+        } else if (argc >= 3 && strcmp(argv[2], "ls") == 0) {
+            result = cmd_astral_ls(argc > 3 ? argv[3] : NULL);
+        } else if (argc >= 4 && strcmp(argv[2], "watch") == 0) {
+            result = cmd_astral_watch(argc - 3, argv + 3);
+        } else {
+            fprintf(stderr, "Usage: %s astral <read <file>...|ls [dir]|watch <filter>...>\n", argv[0]);
             result = 1;
+        }
+    } else if (strcmp(cmd, "audit") == 0) {
+        if (argc >= 3 && strcmp(argv[2], "query") == 0) {
+            result = cmd_audit_query(argc - 3, argv + 3);
         } else {
-            result = cmd_astral_read(argv[3]);
+            fprintf(stderr, "Usage: %s audit query [--from t] [--to t] [--trigger name] [--log file]\n", argv[0]);
+            result = 1;
         }
     } else if (strcmp(cmd, "profile") == 0) {
         if (argc < 4) {
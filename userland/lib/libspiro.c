@@ -8,6 +8,7 @@
 #include "../../kernel/soul_core.h"
 #include "../../kernel/destiny_engine.h"
 #include "../../kernel/ephemeris_provider.h"
+#include "../../kernel/astral_locale.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -142,47 +143,175 @@ int spiro_simulate_ritual(const char *name, time_t timestamp, spiro_location_t l
     return would_trigger ? 1 : 0;
 }
 
+/* Location-independent part of a state, shared by every location */
+static void fill_celestial_state(const celestial_data_t *data, spiro_astral_state_t *state) {
+    state->timestamp = data->timestamp;
+    state->moon_phase = (double)data->moon_phase / 8.0;
+    state->moon_illumination = data->moon_illumination;
+    state->numerology_day = data->numerology_day;
+    
+    /* Format planets as JSON */
+    int offset = 0;
+    offset += snprintf(state->planets_json + offset, 
+                      sizeof(state->planets_json) - offset, "[");
+    
+    for (int i = 0; i < data->planet_count && i < 5; i++) {
+        offset += snprintf(state->planets_json + offset,
+                          sizeof(state->planets_json) - offset,
+                          "{\"name\":\"%s\",\"sign\":\"%s\"}%s",
+                          data->planets[i].name,
+                          data->planets[i].sign,
+                          (i < data->planet_count - 1 && i < 4) ? "," : "");
+    }
+    
+    snprintf(state->planets_json + offset,
+             sizeof(state->planets_json) - offset, "]");
+}
+
+static void fill_local_state(const local_sky_t *sky, spiro_astral_state_t *state) {
+    state->local_day = sky->local_day;
+    state->ascendant = sky->ascendant;
+    state->midheaven = sky->midheaven;
+    memcpy(state->houses, sky->house_cusps, sizeof(state->houses));
+    state->moonrise = sky->moonrise;
+    state->moonset = sky->moonset;
+}
+
 /**
  * Get astral state
  */
 int spiro_get_astral_state(time_t timestamp, spiro_location_t location, 
                            spiro_astral_state_t *state) {
-    if (!is_initialized || !state) {
+    return spiro_get_astral_states(&location, 1, &timestamp, 1, state);
+}
+
+/**
+ * Get astral states for many locations at many timestamps
+ *
+ * states is timestamp-major: states[t * location_count + l].
+ */
+int spiro_get_astral_states(const spiro_location_t *locations, int location_count,
+                            const time_t *timestamps, int timestamp_count,
+                            spiro_astral_state_t *states) {
+    if (!is_initialized || !locations || !timestamps || !states) {
         return -1;
     }
+    if (location_count <= 0 || timestamp_count <= 0) {
+        return 0;
+    }
     
-    (void)location; /* Unused for now */
+    size_t total = (size_t)location_count * timestamp_count;
+    double *latitudes = malloc(location_count * sizeof(double));
+    double *longitudes = malloc(location_count * sizeof(double));
+    local_sky_t *skies = malloc(total * sizeof(local_sky_t));
+    int result = -1;
     
-    celestial_data_t data;
-    if (ephemeris_get_data_at_time(timestamp, &data) != 0) {
-        return -1;
+    if (latitudes && longitudes && skies) {
+        for (int l = 0; l < location_count; l++) {
+            latitudes[l] = locations[l].latitude;
+            longitudes[l] = locations[l].longitude;
+        }
+        result = astral_locale_batch(latitudes, longitudes, location_count,
+                                     timestamps, timestamp_count, skies);
     }
     
-    state->timestamp = data.timestamp;
-    state->moon_phase = (double)data.moon_phase / 8.0;
-    state->moon_illumination = data.moon_illumination;
-    state->numerology_day = data.numerology_day;
+    for (int t = 0; t < timestamp_count && result == 0; t++) {
+        celestial_data_t data;
+        if (ephemeris_get_data_at_time(timestamps[t], &data) != 0) {
+            result = -1;
+            break;
+        }
+        
+        /* Format the shared part once, then copy it to every location */
+        spiro_astral_state_t *row = states + (size_t)t * location_count;
+        fill_celestial_state(&data, &row[0]);
+        for (int l = 0; l < location_count; l++) {
+            if (l > 0) memcpy(&row[l], &row[0], sizeof(spiro_astral_state_t));
+            fill_local_state(&skies[(size_t)t * location_count + l], &row[l]);
+        }
+    }
     
-    /* Format planets as JSON */
-    int offset = 0;
-    offset += snprintf(state->planets_json + offset, 
-                      sizeof(state->planets_json) - offset, "[");
+    free(latitudes);
+    free(longitudes);
+    free(skies);
+    return result;
+}
+
+/**
+ * Validate a binary /astral image and point into it
+ *
+ * Checks magic, version, kind, sizes and the payload CRC; on success
+ * header and payload point into image. Returns 0, or -1 if invalid.
+ */
+int spiro_astral_bin_parse(const void *image, size_t length, astral_bin_kind_t kind,
+                           const astral_bin_header_t **header, const void **payload) {
+    if (!image || length < sizeof(astral_bin_header_t)) return -1;
     
-    for (int i = 0; i < data.planet_count && i < 5; i++) {
-        offset += snprintf(state->planets_json + offset,
-                          sizeof(state->planets_json) - offset,
-                          "{\"name\":\"%s\",\"sign\":\"%s\"}%s",
-                          data.planets[i].name,
-                          data.planets[i].sign,
-                          (i < data.planet_count - 1 && i < 4) ? "," : "");
+    const astral_bin_header_t *h = (const astral_bin_header_t *)image;
+    const uint8_t *body = (const uint8_t *)image + sizeof(astral_bin_header_t);
+    if (h->magic != ASTRAL_BIN_MAGIC || h->version != ASTRAL_BIN_VERSION || h->kind != kind) {
+        return -1;
+    }
+    if ((uint64_t)h->record_size * h->record_count != h->payload_size ||
+        h->payload_size > length - sizeof(astral_bin_header_t)) {
+        return -1;
+    }
+    if (astral_format_crc32(body, h->payload_size) != h->checksum) {
+        return -1;
     }
     
-    snprintf(state->planets_json + offset,
-             sizeof(state->planets_json) - offset, "]");
+    if (header) *header = h;
+    if (payload) *payload = body;
+    return 0;
+}
+
+/**
+ * Read a binary /astral file (e.g. from a spiro-astralfs mount) and validate it
+ */
+int spiro_astral_bin_load(const char *path, void *buffer, size_t size, astral_bin_kind_t kind,
+                          const astral_bin_header_t **header, const void **payload) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return -1;
+    
+    size_t length = fread(buffer, 1, size, file);
+    fclose(file);
+    return spiro_astral_bin_parse(buffer, length, kind, header, payload);
+}
+
+/**
+ * Column pointers into a validated history.bin image
+ */
+int spiro_astral_history_columns(const void *image, size_t length, astral_history_columns_t *columns) {
+    const astral_bin_header_t *header;
+    const void *payload;
+    if (!columns || spiro_astral_bin_parse(image, length, ASTRAL_BIN_HISTORY, &header, &payload) != 0) {
+        return -1;
+    }
+    if (header->record_size != ASTRAL_HISTORY_ROW_SIZE) return -1;
     
+    astral_format_history_columns(payload, header->record_count, columns);
     return 0;
 }
 
+/**
+ * Load a saved tick history into this process
+ */
+int spiro_history_load(const char *path) {
+    if (!path) return -1;
+    return astral_archive_load(path);
+}
+
+/**
+ * Query ticks in [from, to], oldest first
+ *
+ * Start with *cursor = 0 and call until it returns 0. Only the chunk a
+ * call resumes in is decoded, so paging costs the rows returned.
+ */
+int spiro_history_query(time_t from, time_t to, uint32_t *cursor,
+                        astral_archive_sample_t *samples, int max_samples) {
+    return astral_archive_read(from, to, cursor, samples, max_samples);
+}
+
 /**
  * Add a trigger (delegates to destiny_engine)
  */
@@ -9,6 +9,9 @@
 
 #include <time.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include "../../kernel/astral_format.h"
+#include "../../kernel/astral_archive.h"
 
 /* Ritual Information */
 typedef struct {
@@ -33,6 +36,14 @@ typedef struct {
     double moon_illumination;
     int numerology_day;
     char planets_json[512];
+    
+    /* Location-dependent */
+    int local_day;
+    double ascendant;
+    double midheaven;
+    double houses[12];
+    time_t moonrise;            /* 0 if the moon does not rise within 24 h */
+    time_t moonset;
 } spiro_astral_state_t;
 
 /* Library initialization */
@@ -49,6 +60,21 @@ int spiro_list_rituals(ritual_info_t *rituals, int max_count);
 int spiro_simulate_ritual(const char *name, time_t timestamp, spiro_location_t location);
 int spiro_get_astral_state(time_t timestamp, spiro_location_t location, 
                            spiro_astral_state_t *state);
+int spiro_get_astral_states(const spiro_location_t *locations, int location_count,
+                            const time_t *timestamps, int timestamp_count,
+                            spiro_astral_state_t *states);
+
+/* Binary /astral images: validated in place, no parsing */
+int spiro_astral_bin_parse(const void *image, size_t length, astral_bin_kind_t kind,
+                           const astral_bin_header_t **header, const void **payload);
+int spiro_astral_bin_load(const char *path, void *buffer, size_t size, astral_bin_kind_t kind,
+                          const astral_bin_header_t **header, const void **payload);
+int spiro_astral_history_columns(const void *image, size_t length, astral_history_columns_t *columns);
+
+/* Compressed tick history, e.g. as saved by spiro-astralfs -o history=FILE */
+int spiro_history_load(const char *path);
+int spiro_history_query(time_t from, time_t to, uint32_t *cursor,
+                        astral_archive_sample_t *samples, int max_samples);
 
 /* Triggers */
 int spiro_add_trigger(const char *name, const char *expression, const char *exec_path);